@@ -36,6 +36,12 @@ enum OmArchiveLevel : int32_t
   OM_LEVEL_BEST    = 9
 };
 
+enum OmArchiveReader : int32_t
+{
+  OM_READER_STREAM = 0,    //< minizip file streams
+  OM_READER_MAPPED = 1     //< memory-mapped file
+};
+
 /// \brief Zip file interface.
 ///
 /// Object to handle a Zip file.
@@ -91,15 +97,54 @@ class OmArchive
     ///
     bool entryAdd(const void* data, uint64_t size, const OmWString& dst, Om_progressCb progress_cb = nullptr, void* user_ptr = nullptr) const;
 
+    /// \brief Compress and add files batch to zip
+    ///
+    /// Compress and add the specified files to zip using parallel workers.
+    /// Files are compressed in memory by workers while entries are appended
+    /// to zip in the given order, so the resulting layout is the same as
+    /// successive calls to entryAdd. Directories and large files are added
+    /// through the regular streaming method.
+    ///
+    /// \param[in] src     : Paths to files to compress, empty path for directory entry
+    /// \param[in] dst     : Files names/paths in zip
+    /// \param[in] threads : Maximum count of workers, zero to use processors count
+    /// \param[in] progress_cb : Optional callback for entries count progression
+    /// \param[in] compress_cb : Optional callback for entry data bytes progression
+    /// \param[in] user_ptr    : Optional user pointer passed to callbacks
+    ///
+    /// \return True if operation succeed, false otherwise
+    ///
+    bool entryAddBatch(const OmWStringArray& src, const OmWStringArray& dst, size_t threads = 0, Om_progressCb progress_cb = nullptr, Om_progressCb compress_cb = nullptr, void* user_ptr = nullptr) const;
+
+    /// \brief Copy entry from another zip
+    ///
+    /// Copy the specified entry from a zip opened for reading to this zip.
+    /// If the source entry compression method matches the one of this
+    /// zip, compressed data is copied as is without recompression,
+    /// otherwise data is decompressed and recompressed on the fly.
+    ///
+    /// \param[in] src     : Source zip opened for reading
+    /// \param[in] i       : Source entry index
+    /// \param[in] dst     : File name/path in zip
+    ///
+    /// \return True if operation succeed, false otherwise
+    ///
+    bool entryCopy(const OmArchive& src, size_t i, const OmWString& dst, Om_progressCb progress_cb = nullptr, void* user_ptr = nullptr) const;
+
     /// \brief Open a zip file for reading.
     ///
-    /// Initializes an existing zip file for reading operation.
+    /// Initializes an existing zip file for reading operation. The
+    /// memory-mapped reader parses central directory directly from
+    /// mapped file, and falls back to stream reader for archives it
+    /// cannot handle (larger than 2 GB, split or with compressed
+    /// central directory).
     ///
-    /// \param[in]  path  : Path to file to open.
+    /// \param[in]  path    : Path to file to open.
+    /// \param[in]  reader  : Reader backend to use.
     ///
     /// \return True if operation succeed, false otherwise.
     ///
-    bool read(const OmWString& path);
+    bool read(const OmWString& path, int32_t reader = OM_READER_STREAM);
 
     /// \brief Get entries count.
     ///
@@ -142,6 +187,17 @@ class OmArchive
     ///
     uint64_t entrySize(size_t i) const;
 
+    /// \brief Get entry CRC-32
+    ///
+    /// Returns the CRC-32 of the specified entry uncompressed data, as
+    /// stored in zip central-directory.
+    ///
+    /// \param[in] i       : Entry index
+    ///
+    /// \return Entry data CRC-32
+    ///
+    uint32_t entryCrc(size_t i) const;
+
     /// \brief Check whether entry is a directory
     ///
     /// Checks whether the entry at specified index is a directory
@@ -162,6 +218,16 @@ class OmArchive
     ///
     int32_t entryMethod(size_t i) const;
 
+    /// \brief Set destination tree creation
+    ///
+    /// Defines whether entrySave creates missing destination directories,
+    /// disabling it saves per-entry existence checks when caller already
+    /// created the required trees. Must be called after read.
+    ///
+    /// \param[in] enable  : Create missing destination directories
+    ///
+    void setSaveTree(bool enable);
+
     /// \brief Extract and save as file
     ///
     /// Extract and save specified entry as file
@@ -196,9 +262,56 @@ class OmArchive
     ///
     bool entrySave(size_t i, void* buffer, Om_progressCb progress_cb = nullptr, void* user_ptr = nullptr) const;
 
+    /// \brief Get entry stored data
+    ///
+    /// Returns pointer to entry data within mapped file, without copy.
+    /// This is only available for uncompressed (STORE) entries of zip
+    /// opened with memory-mapped reader.
+    ///
+    /// \param[in]  i       : Entry index
+    /// \param[out] size    : Size of entry data
+    ///
+    /// \return Pointer to entry data or nullptr if not available
+    ///
+    const void* entryData(size_t i, uint64_t* size) const;
+
+    /// \brief Open entry for streamed reading
+    ///
+    /// Open the specified entry to be read by successive calls to
+    /// entryRead, the entry must be closed by calling entryClose.
+    ///
+    /// \param[in] i       : Entry index
+    ///
+    /// \return True if operation succeed, false otherwise
+    ///
+    bool entryReadOpen(size_t i) const;
+
+    /// \brief Read data from opened entry
+    ///
+    /// Read and decompress next data chunk from the entry opened by
+    /// entryReadOpen.
+    ///
+    /// \param[in] buffer  : Pointer to buffer to be filled
+    /// \param[in] size    : Size of buffer
+    ///
+    /// \return Count of bytes read, zero at end of entry, -1 if an error occurred
+    ///
+    int64_t entryRead(void* buffer, size_t size) const;
+
+    /// \brief Close opened entry
+    ///
+    /// Close the entry opened for streamed reading, the data CRC is
+    /// verified.
+    ///
+    /// \return True if operation succeed, false otherwise
+    ///
+    bool entryClose() const;
+
     /// \brief Locate entry index
     ///
-    /// Search for the specified entry in zip Central Directory.
+    /// Search for the specified entry in zip Central Directory. Lookup is
+    /// performed through a case-insensitive index of entries paths, where
+    /// slash and back-slash separators are considered equivalent.
     ///
     /// \param[in] filename : Filename or path to search in Central Directory
     ///
@@ -221,6 +334,17 @@ class OmArchive
     ///
     OmWString lastErrorStr() const;
 
+    /// \brief Get I/O buffers statistics.
+    ///
+    /// Returns process-wide counts of I/O buffers requested by archive
+    /// operations and of those actually allocated, others being reused
+    /// from the shared buffers pool.
+    ///
+    /// \param[out] requests  : Receive count of buffer requests.
+    /// \param[out] allocs    : Receive count of buffer allocations.
+    ///
+    static void bufferStats(uint64_t* requests, uint64_t* allocs);
+
   private: ///          - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
     void*               _zctx;        //< minizip reader/writer struct
@@ -230,6 +354,8 @@ class OmArchive
     uint64_t            _zent_size;   //< zip central-directory entry count
 
     uint32_t            _stat;        //< file status
+
+    bool                _read_mapped(const OmWString& path);
 };
 
 #endif // OMARCHIVE_H
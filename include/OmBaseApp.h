@@ -46,6 +46,8 @@
 #define OM_XMAGIC_BCK             L"Open_Mod_Manager_Backup"
 
 #define OM_XMAGIC_REP             L"Open_Mod_Manager_Repository"
+#define OM_XMAGIC_LCH             L"Open_Mod_Manager_Library_Cache"
+#define OM_XMAGIC_RCH             L"Open_Mod_Manager_Repository_Cache"
 
 #define OM_XML_DEF_EXT            L"omx"
 #define OM_PKG_FILE_EXT           L"ozp"
@@ -53,10 +55,14 @@
 
 #define OM_MODHUB_FILENAME        L"hub.omx"
 #define OM_MODCHN_FILENAME        L"channel.omx"
+#define OM_MODCHN_LIBCACHE        L"libcache.omx"
+#define OM_MODCHN_JOURNAL         L"journal.log"
+#define OM_MODCHN_REPCACHE        L"repcache"
 
 #define OM_MODHUB_MODPSET_DIR     L".Presets"
 
 #define OM_MODCHAN_BACKUP_DIR     L"\\Backup"
+#define OM_MODCHAN_BLOBS_DIR      L".Blobs"
 #define OM_MODCHAN_MODLIB_DIR     L"\\Library"
 
 #define OM_MODPACK_THUMB_SIZE     128
@@ -20,6 +20,14 @@
 #include "OmBase.h"
 #include "OmBaseWin.h"
 
+/// \brief Request priorities
+///
+/// Priorities of requests within the shared transfer queue, repository
+/// queries are started before downloads waiting for a transfer slot.
+///
+#define OM_CONNECT_PRIO_DOWNLOAD    0
+#define OM_CONNECT_PRIO_QUERY       1
+
 /// \brief Network socket object
 ///
 /// Class to manage network download and requests.
@@ -43,7 +51,8 @@ class OmConnect
     /// \brief Http Get request data
     ///
     /// Send an HTTP GET request then return received data once done. This
-    /// function does not use thread and block until response or time out.
+    /// function block until response or time out while the transfer is
+    /// performed by the shared transfer engine.
     ///
     /// \param[in] url          : Target URL for HTTP request.
     /// \param[in] reponse      : Pointer to string to receive response data
@@ -98,6 +107,41 @@ class OmConnect
     ///
     bool requestHttpGet(const OmWString& url, void* hfile, bool resume, Om_resultCb result_cb = nullptr, Om_downloadCb download_cb = nullptr, void* user_ptr = nullptr, uint32_t rate = 0);
 
+    /// \brief Set request priority
+    ///
+    /// Set the priority of the next request within the shared transfer queue,
+    /// queued requests with higher priority are started first once a transfer
+    /// slot is freed.
+    ///
+    /// \param[in] priority     : Request priority, default is OM_CONNECT_PRIO_DOWNLOAD.
+    ///
+    void setPriority(int32_t priority) {
+      this->_req_priority = priority;
+    }
+
+    /// \brief Set download checksum state
+    ///
+    /// Set the checksum state to be updated with data written to destination
+    /// file by subsequent download requests, so checksum is computed while
+    /// receiving data.
+    ///
+    /// \param[in] hash_state   : Checksum state created by Om_hashStateCreate or nullptr to disable.
+    ///
+    void setDigest(void* hash_state) {
+      this->_get_hash_st = hash_state;
+    }
+
+    /// \brief Set request validators
+    ///
+    /// Set the cache validators to be sent with subsequent requests as
+    /// If-None-Match and If-Modified-Since headers, so server responds
+    /// with 304 (Not Modified) and no data if resource is unchanged.
+    ///
+    /// \param[in] etag         : ETag of the cached resource or empty string.
+    /// \param[in] modified     : Last-Modified date of the cached resource or empty string.
+    ///
+    void setValidators(const OmWString& etag, const OmWString& modified);
+
     /// \brief Http Get response code
     ///
     /// Returns HTTP GET request response code of the last performed request.
@@ -108,6 +152,23 @@ class OmConnect
       return this->_req_response;
     }
 
+    /// \brief Http Get response ETag
+    ///
+    /// Returns the ETag header value of the last performed request response.
+    ///
+    /// \return ETag value or empty string if none was received
+    ///
+    OmWString httpGetEtag() const;
+
+    /// \brief Http Get response Last-Modified
+    ///
+    /// Returns the Last-Modified header value of the last performed request
+    /// response.
+    ///
+    /// \return Last-Modified date or empty string if none was received
+    ///
+    OmWString httpGetModified() const;
+
     /// \brief Checks whether is performing
     ///
     /// Check whether this instance is currently performing request/transfer
@@ -122,6 +183,13 @@ class OmConnect
     ///
     void abortRequest();
 
+    /// \brief Cancel request
+    ///
+    /// Abort the currently performing request if any and wait for the transfer
+    /// engine to release it, no callback is called.
+    ///
+    void cancelRequest();
+
     /// \brief Get last error string.
     ///
     /// Returns the string of the last performing request error.
@@ -140,8 +208,6 @@ class OmConnect
 
     void*               _heasy;
 
-    void*               _hmult;
-
     OmCString           _req_url;
 
     uint32_t            _req_result;
@@ -158,6 +224,20 @@ class OmConnect
 
     bool                _req_abort;
 
+    bool                _req_detach;
+
+    int32_t             _req_priority;
+
+    OmCString           _req_etag;
+
+    OmCString           _req_modified;
+
+    void*               _req_headers;
+
+    OmCString           _resp_etag;
+
+    OmCString           _resp_modified;
+
     int64_t             _req_max_rate;
 
     uint8_t*            _get_data_buf;
@@ -170,6 +250,8 @@ class OmConnect
 
     bool                _get_file_own;
 
+    void*               _get_hash_st;
+
     uint32_t            _rate_accu;
 
     double              _rate_time;
@@ -182,18 +264,28 @@ class OmConnect
 
     double              _progress_bps;
 
-    void*               _perform_hth;
+    bool                _perform_run;
 
-    void*               _perform_hwo;
+    void*               _perform_hev;
 
-    static DWORD WINAPI _perform_run_fn(void*);
+    void                _perform_setup();
 
-    static VOID WINAPI  _perform_end_fn(void*,uint8_t);
+    void                _perform_done();
+
+    static bool         _xfer_submit(OmConnect*);
+
+    static void         _xfer_detach(OmConnect*);
+
+    static DWORD WINAPI _xfer_run_fn(void*);
+
+    static DWORD WINAPI _xfer_done_fn(void*);
 
     static size_t       _perform_write_mem_fn(char*, size_t, size_t, void*);
 
     static size_t       _perform_write_fio_fn(char*, size_t, size_t, void*);
 
+    static size_t       _perform_header_fn(char*, size_t, size_t, void*);
+
     static int          _perform_progress_fn(void*, int64_t, int64_t, int64_t, int64_t);
 };
 
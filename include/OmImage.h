@@ -81,6 +81,19 @@ class OmImage
     ///
     bool load(uint8_t* data, size_t size);
 
+    /// \brief Load image from pixels.
+    ///
+    /// Load image from already decoded RGBA pixel data. The instance takes
+    /// ownership of the supplied buffer which must be allocated with Om_alloc.
+    ///
+    /// \param[in]  pixels : RGBA pixel data.
+    /// \param[in]  width  : Image width.
+    /// \param[in]  height : Image height.
+    ///
+    /// \return True if operation succeed, false otherwise.
+    ///
+    bool loadPixels(uint8_t* pixels, unsigned width, unsigned height);
+
     /// \brief Load image to thumbnail.
     ///
     /// Load image from file then create and store its
@@ -29,8 +29,104 @@
 #include "OmNetPack.h"
 #include "OmNetRepo.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
 class OmModHub;
 
+/// \brief Install mode
+///
+/// Enumerator for the way files from directory Mod Sources are installed
+/// to Target.
+///
+enum OmInstallMode : int32_t
+{
+  OM_INSTALL_COPY     = 0,  ///< Always copy files
+  OM_INSTALL_HARDLINK = 1,  ///< Create hard links, copy if not possible
+  OM_INSTALL_REFLINK  = 2,  ///< Clone files if supported, copy otherwise
+  OM_INSTALL_AUTO     = 3   ///< Try clone, then hard link, then copy
+};
+
+/// \brief Journal record
+///
+/// Enumerator for the operations journal record types, marking phases of
+/// Mod install and restore operations.
+///
+enum OmJournalOp : int32_t
+{
+  OM_JOURNAL_BACKUP   = 0,  ///< Backup started, Target files may be moved
+  OM_JOURNAL_APPLY    = 1,  ///< Backup completed, Source is being applied
+  OM_JOURNAL_RESTORE  = 2,  ///< Backup is being restored
+  OM_JOURNAL_END      = 3   ///< Operation ended
+};
+
+/// \brief Journal batch size
+///
+/// Maximum count of journal entry records buffered before being written.
+///
+#define OM_JOURNAL_BATCH    256
+
+/// \brief Path index reference structure
+///
+/// Structure to reference an installed Mod Backup entry within the Mod
+/// Channel path index.
+///
+typedef struct OmPathRef_
+{
+  const OmModPack*  ModPack;  ///< Mod Pack which Backup references the entry
+  int32_t           attr;     ///< Backup entry attributes bits
+
+} OmPathRef_t;
+
+/// \brief OmPathRef_t array
+///
+/// Typedef for an STL vector of OmPathRef_t type
+///
+typedef std::vector<OmPathRef_t> OmPathRefArray;
+
+/// \brief Path index map
+///
+/// Typedef for an STL hash map of OmPathRefArray keyed by normalized
+/// path hash.
+///
+typedef std::unordered_map<uint64_t, OmPathRefArray> OmPathIndex;
+
+/// \brief Overlap index map
+///
+/// Typedef for an STL hash map of overlapper Mods keyed by overlapped
+/// Mod hash.
+///
+typedef std::unordered_map<uint64_t, std::vector<const OmModPack*>> OmOverlapIndex;
+
+/// \brief Dependency graph node structure
+///
+/// Structure to describe a library Mod within the Mod Channel dependency
+/// graph, with both direct and reverse dependency edges.
+///
+typedef struct OmDepNode_
+{
+  OmModPack*        ModPack;      ///< Mod Pack of this node
+  OmIndexArray      depends;      ///< Nodes this one depends on
+  OmWStringArray    missings;     ///< Dependencies not found in library
+  OmIndexArray      dependents;   ///< Nodes depending on this one
+  bool              has_missing;  ///< Node or any of its dependencies has missing dependency
+  bool              cyclic;       ///< Node is part of or depends on a dependency cycle
+  uint32_t          rank;         ///< Topological rank, dependencies come first
+
+} OmDepNode_t;
+
+/// \brief OmDepNode_t array
+///
+/// Typedef for an STL vector of OmDepNode_t type
+///
+typedef std::vector<OmDepNode_t> OmDepNodeArray;
+
+/// \brief Identity index map
+///
+/// Typedef for an STL hash map of node indexes keyed by Mod identity
+///
+typedef std::unordered_map<OmWString, OmIndexArray> OmIdenIndex;
+
 /// \brief Mod Channel object for Mod Hub.
 ///
 /// The Mod Channel object defines environment for package installation
@@ -165,6 +261,16 @@ class OmModChan
     ///
     bool refreshModLibrary();
 
+    /// \brief Refresh Mod Library changes
+    ///
+    /// Refresh analytical parameters of Mods whose status may have changed
+    /// since last refresh, according Backups created or cleared meanwhile.
+    /// Notifications are sent only for Mods that actually changed.
+    ///
+    /// \return True if at least one Mod changed, false otherwise
+    ///
+    bool refreshModChanges();
+
     /// \brief Who you gonna call ?
     ///
     /// Check Local Mod Library for "ghost" Mod instances (that has no
@@ -323,6 +429,122 @@ class OmModChan
     /// \return True if matching entry was found, false otherwise.
     ///
     bool backupEntryExists(const OmWString& path, int32_t attr) const;
+
+    /// \brief Index Mod Backup entries
+    ///
+    /// Add Backup entries of the specified Mod to the channel path index
+    /// used to lookup overlaps and shared entries. This is called by the
+    /// Mod itself once its Backup was created or parsed.
+    ///
+    /// \param[in] ModPack  : Mod to index Backup entries
+    ///
+    void indexBackup(const OmModPack* ModPack);
+
+    /// \brief Unindex Mod Backup entries
+    ///
+    /// Remove Backup entries of the specified Mod from the channel path
+    /// index. This is called by the Mod itself before its Backup is cleared.
+    ///
+    /// \param[in] ModPack  : Mod to unindex Backup entries
+    ///
+    void unindexBackup(const OmModPack* ModPack);
+
+    /// \brief Store Backup blob
+    ///
+    /// Stores the specified Target file in the channel Backup blob store,
+    /// where files are identified by their content XXH3 128 bits checksum.
+    /// If a blob with the same content already exists, the file is left
+    /// in place and the existing blob is referenced instead.
+    ///
+    /// \param[in,out] key  : Blob key (checksum string), computed if empty.
+    /// \param[in]  path    : Path to Target file to store.
+    ///
+    /// \return 0 if operation succeed, WinAPI error code otherwise.
+    ///
+    int32_t storeBackupBlob(OmWString* key, const OmWString& path);
+
+    /// \brief Fetch Backup blob
+    ///
+    /// Restores the specified blob to the given Target location and release
+    /// the reference held on it. The blob is moved if no other Backup
+    /// references it, copied otherwise.
+    ///
+    /// \param[in]  key     : Blob key (checksum string).
+    /// \param[in]  path    : Path to Target file to restore.
+    ///
+    /// \return 0 if operation succeed, WinAPI error code otherwise.
+    ///
+    int32_t fetchBackupBlob(const OmWString& key, const OmWString& path);
+
+    /// \brief Acquire Backup blob
+    ///
+    /// Add a reference to the specified blob, this is called by the Mod
+    /// itself once its Backup was parsed.
+    ///
+    /// \param[in]  key     : Blob key (checksum string).
+    ///
+    void acquireBackupBlob(const OmWString& key);
+
+    /// \brief Release Backup blob
+    ///
+    /// Remove a reference from the specified blob, optionally deleting the
+    /// blob file if no more Backup references it.
+    ///
+    /// \param[in]  key     : Blob key (checksum string).
+    /// \param[in]  purge   : Delete blob file when no longer referenced.
+    ///
+    void releaseBackupBlob(const OmWString& key, bool purge);
+
+    /// \brief Write journal operation record
+    ///
+    /// Writes and flushes to disk a record marking a phase of an operation
+    /// on the specified Backup, so it can be rolled back or completed at
+    /// next Channel opening if process ends unexpectedly. Journal file is
+    /// deleted once all operations ended.
+    ///
+    /// \param[in]  oper     : Operation phase.
+    /// \param[in]  bck_path : Backup path the operation relates to.
+    /// \param[in]  bck_root : Backup data root directory, for directory Backup.
+    ///
+    void journalOper(OmJournalOp oper, const OmWString& bck_path, const OmWString& bck_root = OmWString());
+
+    /// \brief Write journal entry record
+    ///
+    /// Appends record of a Target file to be moved to the specified Backup.
+    /// Records are buffered, journalSync must be called before file is
+    /// actually moved.
+    ///
+    /// \param[in]  bck_path : Backup path the operation relates to.
+    /// \param[in]  path     : Entry path, relative to Target.
+    /// \param[in]  blob     : Backup blob key if any.
+    ///
+    void journalEntry(const OmWString& bck_path, const OmWString& path, const OmWString& blob);
+
+    /// \brief Flush journal
+    ///
+    /// Writes buffered journal records and flushes them to disk.
+    ///
+    void journalSync();
+
+    /// \brief Acquire worker threads
+    ///
+    /// Reserves worker threads from the channel-wide budget shared by
+    /// concurrent Mod operations, so that their total count stays bounded.
+    /// At least one worker is always granted.
+    ///
+    /// \param[in]  count   : Desired count of worker threads.
+    ///
+    /// \return Granted count of worker threads, to be released with releaseWorkers.
+    ///
+    size_t acquireWorkers(size_t count);
+
+    /// \brief Release worker threads
+    ///
+    /// Gives back worker threads previously granted by acquireWorkers.
+    ///
+    /// \param[in]  count   : Count of worker threads to release.
+    ///
+    void releaseWorkers(size_t count);
 
     /// \brief Check whether is dependency
     ///
@@ -769,7 +991,8 @@ class OmModChan
     /// \brief Add Net Repositories to query queue
     ///
     /// Adds the given selection of Network Repositories to the Query queue. The
-    /// repositories will be queried sequentially and according their position in queue.
+    /// repositories are queried concurrently, up to the query max thread option,
+    /// and merged to Network Library one at a time as soon as query completes.
     ///
     /// Within this context, the \c param parameter of each callback functions is a pointer to
     /// the currently processing Net Repo object.
@@ -807,9 +1030,40 @@ class OmModChan
     ///
     /// \return Repository queries queue size
     ///
-    size_t queriesQueueSize() const {
-      return this->_query_queue.size();
-    }
+    size_t queriesQueueSize() const;
+
+    /// \brief Repository query added references
+    ///
+    /// Returns count of Net Packs added to Network Library by the last merged
+    /// repository query. Meaningful within query result callback.
+    ///
+    /// \return Count of added Net Packs
+    ///
+    size_t queryAddedCount() const {
+      return this->_query_added;
+    }
+
+    /// \brief Repository query changed references
+    ///
+    /// Returns count of Net Packs replaced in Network Library by the last merged
+    /// repository query. Meaningful within query result callback.
+    ///
+    /// \return Count of changed Net Packs
+    ///
+    size_t queryChangedCount() const {
+      return this->_query_changed;
+    }
+
+    /// \brief Repository query removed references
+    ///
+    /// Returns count of Net Packs removed from Network Library by the last merged
+    /// repository query. Meaningful within query result callback.
+    ///
+    /// \return Count of removed Net Packs
+    ///
+    size_t queryRemovedCount() const {
+      return this->_query_removed;
+    }
 
     /// \brief Check whether is valid.
     ///
@@ -1034,6 +1288,27 @@ class OmModChan
     ///
     void setBackupComp(int32_t method, int32_t level);
 
+    /// \brief Get Backup deduplication option.
+    ///
+    /// Returns whether backed up files are stored in the shared channel
+    /// blob store rather than in each Backup. Blobs are stored uncompressed
+    /// regardless Backup compression options.
+    ///
+    /// \return Backup deduplication option value.
+    ///
+    bool backupDedup() const {
+      return _backup_dedup;
+    }
+
+    /// \brief Set Backup deduplication option.
+    ///
+    /// Define and save Backup deduplication option value. This only
+    /// affects newly created Backups.
+    ///
+    /// \param[in]  enable    : Backup deduplication enable or disable.
+    ///
+    void setBackupDedup(bool enable);
+
     /// \brief Get package legacy support size option.
     ///
     /// Returns package legacy support option value.
@@ -1070,6 +1345,26 @@ class OmModChan
     ///
     void setLibraryShowhidden(bool enable);
 
+    /// \brief Get install mode option.
+    ///
+    /// Returns the way files from directory Mod Sources are installed
+    /// to Target.
+    ///
+    /// \return Install mode, one of OmInstallMode values.
+    ///
+    int32_t installMode() const {
+      return _install_mode;
+    }
+
+    /// \brief Set install mode option.
+    ///
+    /// Define and save the way files from directory Mod Sources are
+    /// installed to Target. Archive Sources are always extracted.
+    ///
+    /// \param[in]  mode      : Install mode, one of OmInstallMode values.
+    ///
+    void setInstallMode(int32_t mode);
+
     /// \brief Get warning for overlaps option.
     ///
     /// Returns warning for overlaps option value.
@@ -1243,6 +1538,24 @@ class OmModChan
     ///
     void setDownLimits(uint32_t rate, uint32_t thread);
 
+    /// \brief Get query max thread value
+    ///
+    /// Returns repository query max thread (concurrent queries) option value
+    ///
+    /// \return Max thread count
+    ///
+    uint32_t queryMaxThread() const {
+      return this->_query_max_thread;
+    }
+
+    /// \brief Set query limits options
+    ///
+    /// Define the repository query limits options values
+    ///
+    /// \param[in] thread : Maximum count of concurrent repository queries
+    ///
+    void setQueryLimits(uint32_t thread);
+
     /// \brief Get Mod Hub
     ///
     /// Return affiliated Mod Hub.
@@ -1330,7 +1643,7 @@ class OmModChan
 
     void                  _get_backup_relations(const OmModPack*, OmPModPackArray*, OmWStringArray*, OmWStringArray*) const;
 
-    void                  _get_cleaning_depends(const OmModPack*, const OmPModPackArray&, OmPModPackArray*) const;
+    void                  _get_cleaning_depends(const OmModPack*, const OmPModPackArray&, OmPModPackArray*, std::vector<const OmModPack*>*) const;
 
     void                  _get_cleaning_relations(const OmModPack*, const OmPModPackArray&, OmPModPackArray*, OmWStringArray*) const;
 
@@ -1339,6 +1652,27 @@ class OmModChan
     void                  _get_source_downloads(const OmModPack*, OmPNetPackArray*, OmWStringArray*) const;
 
     void                  _get_replace_breaking(const OmNetPack*, OmWStringArray*) const;
+
+    // dependency graph, rebuilt on demand once library changed
+    void                  _depgraph_build() const;
+
+    void                  _depgraph_invalidate();
+
+    int32_t               _depgraph_resolve(const OmWString&) const;
+
+    void                  _depgraph_closure(const OmModPack*, OmIndexArray*, OmWStringArray*) const;
+
+    mutable bool          _depgraph_dirty;
+
+    mutable OmDepNodeArray _depgraph_nodes;
+
+    mutable OmIdenIndex   _depgraph_idens;
+
+    mutable OmIdenIndex   _depgraph_rdeps;
+
+    mutable size_t        _depgraph_cycles;
+
+    mutable CRITICAL_SECTION _depgraph_lock;
 
     // threads management
     bool                  _locked_mod_library;
@@ -1360,6 +1694,18 @@ class OmModChan
 
     static DWORD WINAPI   _modops_run_fn(void*);
 
+    static DWORD WINAPI   _modops_job_fn(void*);
+
+    DWORD                 _modops_run(bool parallel);
+
+    OmResult              _modops_exec(OmModPack*, bool);
+
+    void                  _modops_done(OmModPack*, bool, OmResult, DWORD*);
+
+    CRITICAL_SECTION      _modops_lock;
+
+    CRITICAL_SECTION      _modops_cb_lock;
+
     static bool           _modops_progress_fn(void*, size_t, size_t, uint64_t);
 
     static VOID WINAPI    _modops_end_fn(void*,uint8_t);
@@ -1385,15 +1731,9 @@ class OmModChan
 
     uint32_t              _download_percent;
 
-    void                  _download_srart_queued();
-
-    void*                 _download_start_hth;
-
-    void*                 _download_start_hwo;
+    CRITICAL_SECTION      _download_lock;
 
-    static DWORD WINAPI   _download_start_run_fn(void*);
-
-    static VOID WINAPI    _download_start_end_fn(void*,uint8_t);
+    void                  _download_srart_queued();
 
     static void           _download_result_fn(void*, OmResult, uint64_t);
 
@@ -1447,8 +1787,24 @@ class OmModChan
 
     OmPNetRepoQueue       _query_queue;
 
+    OmPNetRepoArray       _query_array;
+
+    mutable CRITICAL_SECTION _query_lock;
+
+    CRITICAL_SECTION      _query_cb_lock;
+
+    void                  _query_merge(OmNetRepo*, OmResult);
+
+    static DWORD WINAPI   _query_work_fn(void*);
+
     uint32_t              _query_dones;
 
+    size_t                _query_added;
+
+    size_t                _query_changed;
+
+    size_t                _query_removed;
+
     uint32_t              _query_percent;
 
     static DWORD WINAPI   _query_run_fn(void*);
@@ -1468,6 +1824,8 @@ class OmModChan
 
     bool                  _library_showhidden;
 
+    int32_t               _install_mode;
+
     bool                  _warn_overlaps;
 
     bool                  _warn_extra_inst;
@@ -1476,6 +1834,8 @@ class OmModChan
 
     int32_t               _backup_level;
 
+    bool                  _backup_dedup;
+
     bool                  _warn_extra_unin;
 
     bool                  _warn_extra_dnld;
@@ -1492,6 +1852,8 @@ class OmModChan
 
     uint32_t              _down_max_thread;
 
+    uint32_t              _query_max_thread;
+
     // sorting comparison functions
     static bool           _compare_mod_name(const OmModPack* a, const OmModPack* b);
     static bool           _compare_mod_stat(const OmModPack* a, const OmModPack* b);
@@ -1509,6 +1871,61 @@ class OmModChan
     void                  _error(const OmWString& origin, const OmWString& detail);
 
     OmWString             _lasterr;
+
+    // logs held back while worker threads are running
+    void                  _defer_log(bool enable);
+
+    bool                  _log_defer;
+
+    mutable CRITICAL_SECTION _log_defer_lock;
+
+    mutable OmIndexArray  _log_defer_lvl;
+
+    mutable OmWStringArray _log_defer_org;
+
+    mutable OmWStringArray _log_defer_dtl;
+
+    // installed entries index, accessed by worker threads
+    OmPathIndex           _path_index;
+
+    OmOverlapIndex        _overlap_index;
+
+    OmUint64Array         _overlap_changes;
+
+    mutable CRITICAL_SECTION _path_index_lock;
+
+    // Backup blob store references count
+    std::unordered_map<OmWString, uint32_t> _blobs_refs;
+
+    CRITICAL_SECTION      _blobs_lock;
+
+    void                  _blob_path(OmWString* path, const OmWString& key) const;
+
+    // operations journal
+    HANDLE                _journal_hfile;
+
+    OmCString             _journal_buff;
+
+    size_t                _journal_pend;
+
+    std::unordered_set<OmWString> _journal_opers;
+
+    CRITICAL_SECTION      _journal_lock;
+
+    void                  _journal_write(const OmCString& record, bool sync);
+
+    void                  _journal_rollback(OmWStringArray* restores);
+
+    void                  _journal_restore(const OmWStringArray& restores);
+
+    // Mod operations worker threads budget
+    size_t                _workers_max;
+
+    size_t                _workers_used;
+
+    size_t                _workers_users;
+
+    CRITICAL_SECTION      _workers_lock;
 };
 
 /// \brief OmModChan pointer array
@@ -422,13 +422,11 @@ class OmModMan
 
     /// \brief Get log string.
     ///
-    /// Returns log string.
+    /// Returns a copy of log string, log may be written by other threads.
     ///
     /// \return Log string.
     ///
-    const OmWString& currentLog() const {
-      return this->_log_str;
-    }
+    OmWString currentLog() const;
 
     /// \brief Escalate log.
     ///
@@ -480,6 +478,8 @@ class OmModMan
 
     OmPVoidArray          _log_user_ptr;
 
+    mutable CRITICAL_SECTION _log_lock;
+
     // general options
     unsigned              _icon_size;
 
@@ -23,6 +23,7 @@
 #include "OmVersion.h"
 
 class OmModChan;
+class OmXmlNode;
 
 /// \brief Mod Entry Attributes
 ///
@@ -43,6 +44,9 @@ typedef struct OmModEntry_
   int32_t       attr;   ///< Entry attributes bits
   OmWString     path;   ///< Entry relative path
   int32_t       cdid;   ///< Entry zip central-directory index
+  uint64_t      size;   ///< Entry file size
+  uint32_t      crc;    ///< Entry zip CRC-32, 0 for directory Source
+  OmWString     blob;   ///< Entry Backup blob key, if any
 
 } OmModEntry_t;
 
@@ -118,6 +122,27 @@ class OmModPack
     ///
     bool refreshSource();
 
+    /// \brief Load Mod Source from cache
+    ///
+    /// Setup Source side of this instance from data previously stored in
+    /// Library cache, without opening the Source archive file.
+    ///
+    /// \param[in]  path    : Path to Source archive file.
+    /// \param[in]  node    : Library cache XML node to load data from.
+    ///
+    /// \return True operation succeed, false otherwise
+    ///
+    bool loadSourceCache(const OmWString& path, const OmXmlNode& node);
+
+    /// \brief Save Mod Source to cache
+    ///
+    /// Store parsed Source data of this instance to the specified
+    /// Library cache XML node.
+    ///
+    /// \param[in]  node    : Library cache XML node to store data in.
+    ///
+    void saveSourceCache(OmXmlNode& node) const;
+
     /// \brief Revoke and clear Source
     ///
     /// Clear parsed data and parameters of the Source side of this instance.
@@ -557,11 +582,13 @@ class OmModPack
     /// \param[in] progress_cb  : Optional progression callback function
     /// \param[in] user_ptr     : Optional user pointer to be passed to callback
     /// \param[in] isundo       : Specify that process an undo following install faillure
+    /// \param[in] isrecov      : Specify that process completes an interrupted operation,
+    ///                          Backup files already restored are then skipped
     ///
     /// \return OM_RESULT_OK if operation succeed, OM_RESULT_ERROR if an error occurred
     ///         and OM_RESULT_ABORT if invalid call
     ///
-    OmResult restoreData(Om_progressCb progress_cb = nullptr, void* user_ptr = nullptr, bool isundo = false);
+    OmResult restoreData(Om_progressCb progress_cb = nullptr, void* user_ptr = nullptr, bool isundo = false, bool isrecov = false);
 
     /// \brief Install Mod
     ///
@@ -576,6 +603,24 @@ class OmModPack
     ///
     OmResult applySource(Om_progressCb progress_cb = nullptr, void* user_ptr = nullptr);
 
+    /// \brief Upgrade installed Mod
+    ///
+    /// Install this Mod in place of the specified installed one, restoring
+    /// and writing only files that differ between both versions. The
+    /// replaced Mod Backup is transferred to this one then deleted once the
+    /// new Backup is saved. If writing files fails, the new Backup is restored
+    /// as for a failed install.
+    ///
+    /// \param[in] ModPack      : Installed Mod Pack to be replaced
+    /// \param[in] progress_cb  : Optional progression callback function
+    /// \param[in] user_ptr     : Optional user pointer to be passed to callback
+    ///
+    /// \return OM_RESULT_OK if operation succeed, OM_RESULT_ERROR if an error occurred
+    ///         and OM_RESULT_ABORT if operation was aborted or if a full restore and
+    ///         install is required, in which case nothing was changed.
+    ///
+    OmResult upgradeFrom(OmModPack* ModPack, Om_progressCb progress_cb = nullptr, void* user_ptr = nullptr);
+
     /// \brief Discard Backup data
     ///
     /// Permanently delete Backup data to avoid having restoring it to prevent
@@ -701,6 +746,9 @@ class OmModPack
     // source parse helper
     static void         _src_parse_dir(OmModEntryArray*, const OmWString&, const OmWString&);
 
+    // install selected or all source entries, progression continues from given state
+    OmResult            _apply_source(const OmIndexArray* select, size_t progress_tot, size_t progress_cur, Om_progressCb progress_cb, void* user_ptr);
+
     // pack source properties
     bool                _has_src;
 
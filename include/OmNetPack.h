@@ -63,6 +63,29 @@ class OmNetPack
     ///
     bool parseReference(OmNetRepo* NetRepo, size_t i);
 
+    /// \brief Repository reference digest
+    ///
+    /// Computes digest of the given repository reference node content and
+    /// of the repository locations it depends on, used to check whether a
+    /// reference changed without parsing it.
+    ///
+    /// \param[in]  NetRepo  : Repository the reference belongs to.
+    /// \param[in]  ref_node : Repository reference node.
+    ///
+    /// \return 64 bit unsigned integer xxHash value
+    ///
+    static uint64_t getReferenceHash(const OmNetRepo* NetRepo, const OmXmlNode& ref_node);
+
+    /// \brief Reference digest
+    ///
+    /// Digest of the repository reference this instance was parsed from.
+    ///
+    /// \return 64 bit unsigned integer xxHash value
+    ///
+    uint64_t refHash() const {
+      return this->_ref_hash;
+    }
+
     /// \brief Mod hash value
     ///
     /// Mod filename hash value the backup data is related to
@@ -485,6 +508,8 @@ class OmNetPack
 
     uint64_t            _hash;
 
+    uint64_t            _ref_hash;
+
     OmWString           _core;
 
     OmWString           _name;
@@ -553,6 +578,14 @@ class OmNetPack
 
     uint32_t            _dnl_percent;
 
+    void*               _dnl_hash;
+
+    OmWString           _dnl_hsum;
+
+    uint64_t            _dnl_hash_save;
+
+    void                _dnl_hash_init();
+
     static void         _dnl_result_fn(void*, OmResult, uint64_t);
 
     static bool         _dnl_download_fn(void*, int64_t, int64_t, int64_t, uint64_t);
@@ -560,6 +593,8 @@ class OmNetPack
     // upgrade-replace stuff
     uint32_t            _upg_percent;
 
+    bool                _upg_abort;
+
     static bool         _upg_progress_fn(void*, size_t, size_t, uint64_t);
 
     // logs and errors
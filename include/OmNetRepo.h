@@ -122,6 +122,10 @@ class OmNetRepo
     /// Try connect to repository to get definition file repository data. This
     /// function does not use thread and block until request response or timeout.
     ///
+    /// If repository is linked to a Mod Channel, the response is stored in the
+    /// Channel repository cache and subsequent queries are conditional, so an
+    /// unchanged definition is not downloaded again.
+    ///
     /// \return True if query succeed, false if an error occurred.
     ///
     OmResult query();
@@ -140,6 +144,23 @@ class OmNetRepo
       return this->_query_result;
     }
 
+    /// \brief Query response cached
+    ///
+    /// Returns whether server responded last query with 304 (Not Modified)
+    /// so repository data was taken from cache.
+    ///
+    /// \return True if repository definition is unchanged since previous query
+    ///
+    bool queryCached() const {
+      return this->_query_cached;
+    }
+
+    /// \brief Delete query cache
+    ///
+    /// Delete the repository query cache entry from Mod Channel cache.
+    ///
+    void deleteQueryCache();
+
     /// \brief Query HTTP response code
     ///
     /// Returns last query HTTP response code
@@ -487,6 +508,17 @@ class OmNetRepo
 
     OmWString           _query_lasterr;
 
+    bool                _query_cached;
+
+    // query cache stuff
+    OmWString           _cache_etag;
+
+    OmWString           _cache_modified;
+
+    OmWString           _cache_path() const;
+
+    void                _cache_save(const OmWString&, const OmWString&);
+
     // reference build helpers
     bool                _save_thumbnail(OmXmlNode&, const OmImage&, uint8_t level = 70);
 
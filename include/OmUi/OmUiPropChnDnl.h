@@ -22,6 +22,7 @@
 #define CHN_PROP_DNL_ONUPGRADE   0
 #define CHN_PROP_DNL_WARNINGS    1
 #define CHN_PROP_DNL_LIMITS      2
+#define CHN_PROP_DNL_QRYLIMITS   3
 
 /// \brief Mod Channel Properties: "Download options" tab
 ///
@@ -59,6 +60,8 @@ class OmUiPropChnDnl : public OmDialogPropTab
 
     void                _limit_thread_toggle();
 
+    void                _limit_query_toggle();
+
     void                _onTbInit();
 
     void                _onTbResize();
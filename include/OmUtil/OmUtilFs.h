@@ -102,6 +102,41 @@ int Om_fileMove(const OmWString& src, const OmWString& dst);
 ///
 int Om_fileDelete(const OmWString& path);
 
+/// \brief Create file hard link
+///
+/// Create a new hard link to the given file at the specified location,
+/// both paths must be on the same NTFS volume.
+///
+/// \param[in]  src    : Existing file path to link.
+/// \param[in]  dst    : New hard link path, must not exist.
+///
+/// \return 0 if operation succeed, WinAPI error code otherwise.
+///
+int Om_fileLink(const OmWString& src, const OmWString& dst);
+
+/// \brief Clone file
+///
+/// Create a copy-on-write clone (block cloning) of the given file to the
+/// specified location. This requires a file system supporting block
+/// cloning, such as ReFS, and fails otherwise.
+///
+/// \param[in]  src    : Source file path to clone.
+/// \param[in]  dst    : Destination file path.
+///
+/// \return 0 if operation succeed, WinAPI error code otherwise.
+///
+int Om_fileClone(const OmWString& src, const OmWString& dst);
+
+/// \brief Get file hard links count
+///
+/// Returns the count of hard links referencing the specified file data.
+///
+/// \param[in]  path   : Path to file.
+///
+/// \return Hard links count or 0 if file cannot be accessed.
+///
+uint32_t Om_fileLinkCount(const OmWString& path);
+
 /// \brief Check valid file
 ///
 /// Checks whether the specified item is actually a valid file.
@@ -107,6 +107,18 @@ uint64_t Om_getXXHash3(const void* data, size_t size);
 ///
 uint64_t Om_getXXHash3(const OmWString& str);
 
+/// \brief Compute path XXHash3 Hash.
+///
+/// Calculates and returns 64 bits unsigned integer hash (XXHash3) of the given
+/// path normalized to be case insensitive and separator agnostic, so any
+/// spelling of the same path gives the same hash.
+///
+/// \param[in]  path   : Path to compute Hash.
+///
+/// \return Resulting 64 bits unsigned integer hash.
+///
+uint64_t Om_getPathHash(const OmWString& path);
+
 /// \brief Compute XXHash3 digest from file.
 ///
 /// Calculates and returns 64 bits unsigned integer digest (XXHash3) of the
@@ -141,6 +153,18 @@ OmWString Om_getXXHsum(const OmWString& path);
 ///
 bool Om_getXXHsum(OmWString* pstr, const OmWString& path);
 
+/// \brief Get file XXH3 128 bits checksum.
+///
+/// Calculates the 32 characters hash string (XXH3 128 bits) of the
+/// given file, suitable to identify file content.
+///
+/// \param[in]  pstr    : String to set as checksum string.
+/// \param[in]  path    : Path to file to generate checksum.
+///
+/// \return True if operation succeed, false if open file error.
+///
+bool Om_getXXH128sum(OmWString* pstr, const OmWString& path);
+
 /// \brief Compare file XXHash3 checksum.
 ///
 /// Calculates the 16 characters hash string of the given data.
@@ -218,6 +242,18 @@ bool Om_cmpMD5sum(const OmWString& path, const OmWString& str);
 ///
 bool Om_cmpMD5sum(void* hFile, const OmWString& str);
 
+/// \brief Compute CRC-32 digest from file.
+///
+/// Calculates the CRC-32 (as used in zip archives) of the given file
+/// content.
+///
+/// \param[out] crc     : Pointer to uint32_t that receive CRC-32 value.
+/// \param[in]  path    : Path to file to compute CRC-32 digest.
+///
+/// \return True if operation succeed, false if open file error.
+///
+bool Om_getCRC32digest(uint32_t* crc, const OmWString& path);
+
 /// \brief Calculate CRC64 value.
 ///
 /// Calculates and returns the CRC64 unsigned integer value of the given
@@ -241,6 +277,93 @@ uint64_t Om_getCRC64(const void* data, size_t size);
 ///
 uint64_t Om_getCRC64(const OmWString& str);
 
+/// \brief Create checksum state.
+///
+/// Create a new incremental checksum state, using either XXHash3 or MD5
+/// algorithm, to compute checksum of data received by chunks.
+///
+/// \param[in]  md5     : Use MD5 algorithm instead of XXHash3.
+///
+/// \return Pointer to checksum state or nullptr if allocation failed.
+///
+void* Om_hashStateCreate(bool md5);
+
+/// \brief Delete checksum state.
+///
+/// Free the given checksum state previously created by Om_hashStateCreate.
+///
+/// \param[in]  hst     : Pointer to checksum state.
+///
+void Om_hashStateDelete(void* hst);
+
+/// \brief Update checksum state.
+///
+/// Update the given checksum state with the given data chunk.
+///
+/// \param[in]  hst     : Pointer to checksum state.
+/// \param[in]  data    : Data chunk to update checksum with.
+/// \param[in]  size    : Size of data chunk in bytes.
+///
+void Om_hashStateUpdate(void* hst, const void* data, size_t size);
+
+/// \brief Update checksum state from file.
+///
+/// Update the given checksum state with the file data which follows the
+/// already hashed size, up to the end of file.
+///
+/// \param[in]  hst     : Pointer to checksum state.
+/// \param[in]  path    : Path to file to read data from.
+///
+/// \return True if operation succeed, false if file read error.
+///
+bool Om_hashStateUpdate(void* hst, const OmWString& path);
+
+/// \brief Get checksum state data size.
+///
+/// Returns the total size of data the checksum state was updated with.
+///
+/// \param[in]  hst     : Pointer to checksum state.
+///
+/// \return Hashed data size in bytes.
+///
+uint64_t Om_hashStateSize(const void* hst);
+
+/// \brief Compare checksum state.
+///
+/// Computes checksum of the data hashed so far and compare it with the given
+/// hexadecimal checksum string. The state is left unchanged.
+///
+/// \param[in]  hst     : Pointer to checksum state.
+/// \param[in]  str     : Checksum hexadecimal string to compare.
+///
+/// \return true if checksum matches, false otherwise
+///
+bool Om_hashStateCompare(const void* hst, const OmWString& str);
+
+/// \brief Save checksum state.
+///
+/// Write the given checksum state to file as checkpoint, so computation
+/// can be resumed later.
+///
+/// \param[in]  hst     : Pointer to checksum state.
+/// \param[in]  path    : Path to checkpoint file to write.
+///
+/// \return True if operation succeed, false if file write error.
+///
+bool Om_hashStateSave(const void* hst, const OmWString& path);
+
+/// \brief Load checksum state.
+///
+/// Read checksum state from checkpoint file previously written by
+/// Om_hashStateSave. If file is missing or invalid, the state is reset.
+///
+/// \param[in]  hst     : Pointer to checksum state.
+/// \param[in]  path    : Path to checkpoint file to read.
+///
+/// \return True if state was loaded, false if state was reset.
+///
+bool Om_hashStateLoad(void* hst, const OmWString& path);
+
 /// \brief Generate random bytes.
 ///
 /// Generate a random bytes sequence with values from 0 to 255 of
@@ -16,8 +16,10 @@
 */
 #include <algorithm>          //< std::replace
 #include <ctime>              //< time()
+#include <cwctype>            //< towupper()
 
 #include "minizip-ng/mz.h"
+#include "minizip-ng/mz_crypt.h"
 #include "minizip-ng/mz_os.h"
 #include "minizip-ng/mz_strm.h"
 #include "minizip-ng/mz_strm_os.h"
@@ -42,53 +44,967 @@
 #define ZIP_READER  0x1 //< Zip is in read mode
 #define ZIP_WRITER  0x2 //< Zip is in write mode
 #define ZIP_ERROR   0x4 //< Zip is in error state
+#define ZIP_MAPPED  0x8 //< Zip reader is memory-mapped
+#define ZIP_NOTREE  0x10 //< Zip reader does not create destination trees
 
 #define ZIP_IO_BUF_SIZE   262144
 
+/// \brief I/O buffers pool size
+///
+/// Maximum count of released I/O buffers kept for reuse.
+///
+#define ZIP_POOL_MAX      8
+
 /// \brief Zip context structure
 ///
-/// Internal reader/writer structure to work with mz_zip API
+/// Internal reader/writer structure to work with mz_zip API
+///
+typedef struct zip_context_
+{
+  void*         zip_hnd;
+
+  void*         strm_file;
+
+  void*         strm_buff;
+
+  void*         strm_splt;
+
+  int32_t       cmp_level;
+
+  int32_t       cmp_method;
+
+  int32_t       mz_err;
+
+  OmWString     ws_err;
+
+  HANDLE        map_file;
+
+  HANDLE        map_hnd;
+
+  uint8_t*      map_data;
+
+  uint64_t      map_size;
+
+  void*         strm_mmem;
+
+  uint8_t*      buffer;   //< I/O buffer, acquired on first need
+
+} zip_context_t;
+
+/// \brief I/O buffers pool
+///
+/// Process-wide lock-free list of released I/O buffers, a pooled buffer
+/// holds the list entry in its own first bytes. List head is initialized
+/// once, on first access through __zip_pool. Counters are for stats.
+///
+static SLIST_HEADER     __zip_pool_head;
+static INIT_ONCE        __zip_pool_once = INIT_ONCE_STATIC_INIT;
+static volatile LONG    __zip_pool_size = 0;
+static volatile LONG64  __zip_buf_reqs = 0;
+static volatile LONG64  __zip_buf_alloc = 0;
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static BOOL CALLBACK __zip_pool_init(PINIT_ONCE once, PVOID param, PVOID* context)
+{
+  OM_UNUSED(once); OM_UNUSED(param); OM_UNUSED(context);
+
+  InitializeSListHead(&__zip_pool_head);
+
+  return TRUE;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline PSLIST_HEADER __zip_pool()
+{
+  InitOnceExecuteOnce(&__zip_pool_once, __zip_pool_init, nullptr, nullptr);
+
+  return &__zip_pool_head;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static uint8_t* __zip_buf_acquire()
+{
+  InterlockedIncrement64(&__zip_buf_reqs);
+
+  PSLIST_ENTRY entry = InterlockedPopEntrySList(__zip_pool());
+  if(entry) {
+    InterlockedDecrement(&__zip_pool_size);
+    return reinterpret_cast<uint8_t*>(entry);
+  }
+
+  InterlockedIncrement64(&__zip_buf_alloc);
+
+  return static_cast<uint8_t*>(Om_alloc(ZIP_IO_BUF_SIZE));
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static void __zip_buf_release(uint8_t* buffer)
+{
+  if(!buffer)
+    return;
+
+  // pool is full, buffer is freed
+  if(InterlockedIncrement(&__zip_pool_size) > ZIP_POOL_MAX) {
+    InterlockedDecrement(&__zip_pool_size);
+    Om_free(buffer);
+    return;
+  }
+
+  InterlockedPushEntrySList(__zip_pool(), reinterpret_cast<PSLIST_ENTRY>(buffer));
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline uint8_t* __zip_ctx_buffer(zip_context_t* zctx)
+{
+  // only operations streaming data need a buffer
+  if(!zctx->buffer)
+    zctx->buffer = __zip_buf_acquire();
+
+  return zctx->buffer;
+}
+
+
+/// \brief Zip central-directory mirror structure
+///
+/// Internal structure to store zip file entries informations. Entries
+/// attributes are stored as parallel arrays within a single allocated
+/// block, and entries paths are stored as null-terminated UTF-16 strings
+/// in a shared string pool, referenced by offset/length pairs.
+///
+typedef struct zip_mirror_
+{
+  int64_t*        offset;       //< entries offset in central directory
+
+  uint64_t*       file_size;    //< entries uncompressed size
+
+  int32_t*        method;       //< entries compression method
+
+  uint32_t*       path_offs;    //< entries path offset in string pool
+
+  uint32_t*       path_size;    //< entries path length in string pool
+
+  uint32_t*       crc;          //< entries data CRC-32
+
+  uint8_t*        is_dir;       //< entries directory flag
+
+  wchar_t*        str_pool;     //< entries path string pool
+
+  size_t          str_used;     //< string pool used size in characters
+
+  size_t          str_capa;     //< string pool capacity in characters
+
+  uint32_t*       hash_tabl;    //< entries path hash table (index + 1, 0 for empty slot)
+
+  size_t          hash_mask;    //< entries path hash table size minus one
+
+} zip_mirror_t;
+
+/// \brief Zip mirror entry size
+///
+/// Size in bytes of arrays data for a single entry in zip central-directory mirror
+///
+#define ZIP_MIRROR_ENT_SIZE (sizeof(int64_t)+sizeof(uint64_t)+sizeof(int32_t)+sizeof(uint32_t)+sizeof(uint32_t)+sizeof(uint32_t)+sizeof(uint8_t))
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline void __zip_mirror_free(zip_mirror_t* zmir)
+{
+  if(!zmir)
+    return;
+
+  // all arrays are within a single block starting at offset array
+  Om_free(zmir->offset);
+  Om_free(zmir->str_pool);
+  Om_free(zmir->hash_tabl);
+  Om_free(zmir);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline zip_mirror_t* __zip_mirror_alloc(size_t count)
+{
+  zip_mirror_t* zmir = static_cast<zip_mirror_t*>(Om_alloc(sizeof(zip_mirror_t)));
+  if(!zmir)
+    return nullptr;
+
+  Om_memset(zmir, 0, sizeof(zip_mirror_t));
+
+  if(count == 0)
+    return zmir;
+
+  // arrays are laid out in a single block by decreasing alignment
+  uint8_t* block = static_cast<uint8_t*>(Om_alloc(count * ZIP_MIRROR_ENT_SIZE));
+  if(!block) {
+    __zip_mirror_free(zmir);
+    return nullptr;
+  }
+
+  zmir->offset = reinterpret_cast<int64_t*>(block);
+  block += count * sizeof(int64_t);
+  zmir->file_size = reinterpret_cast<uint64_t*>(block);
+  block += count * sizeof(uint64_t);
+  zmir->method = reinterpret_cast<int32_t*>(block);
+  block += count * sizeof(int32_t);
+  zmir->path_offs = reinterpret_cast<uint32_t*>(block);
+  block += count * sizeof(uint32_t);
+  zmir->path_size = reinterpret_cast<uint32_t*>(block);
+  block += count * sizeof(uint32_t);
+  zmir->crc = reinterpret_cast<uint32_t*>(block);
+  block += count * sizeof(uint32_t);
+  zmir->is_dir = block;
+
+  // initial string pool capacity, assuming a reasonable average path length
+  zmir->str_capa = count * 64;
+  zmir->str_pool = static_cast<wchar_t*>(Om_alloc(zmir->str_capa * sizeof(wchar_t)));
+  if(!zmir->str_pool) {
+    __zip_mirror_free(zmir);
+    return nullptr;
+  }
+
+  return zmir;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline bool __zip_mirror_add_path(zip_mirror_t* zmir, size_t i, const char* utf8, size_t len)
+{
+  // UTF-16 conversion never produces more characters than UTF-8 bytes
+
+  if(zmir->str_used + len + 1 > zmir->str_capa) {
+
+    size_t capa = zmir->str_capa * 2;
+    while(zmir->str_used + len + 1 > capa)
+      capa *= 2;
+
+    wchar_t* pool = static_cast<wchar_t*>(Om_realloc(zmir->str_pool, capa * sizeof(wchar_t)));
+    if(!pool)
+      return false;
+
+    zmir->str_pool = pool;
+    zmir->str_capa = capa;
+  }
+
+  wchar_t* path = zmir->str_pool + zmir->str_used;
+
+  // convert filename UTF-8 to UTF-16
+  int n = MultiByteToWideChar(CP_UTF8, 0, utf8, len, path, len);
+
+  // replace slash by back-slash
+  for(int c = 0; c < n; ++c)
+    if(path[c] == L'/') path[c] = L'\\';
+
+  path[n] = 0;
+
+  zmir->path_offs[i] = zmir->str_used;
+  zmir->path_size[i] = n;
+  zmir->str_used += n + 1;
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline uint32_t __zip_path_hash(const wchar_t* path, size_t len)
+{
+  // case-insensitive FNV-1a hash, slash and back-slash are considered equal
+  uint32_t hash = 2166136261U;
+
+  for(size_t c = 0; c < len; ++c) {
+    hash ^= (path[c] == L'/') ? L'\\' : towupper(path[c]);
+    hash *= 16777619U;
+  }
+
+  return hash;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline bool __zip_path_match(const wchar_t* left, const wchar_t* right, size_t len)
+{
+  // test from end of string since paths often share the same beginning
+  while(len--) {
+    wchar_t l = (left[len] == L'/') ? L'\\' : towupper(left[len]);
+    wchar_t r = (right[len] == L'/') ? L'\\' : towupper(right[len]);
+    if(l != r) return false;
+  }
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline bool __zip_mirror_index(zip_mirror_t* zmir, size_t count)
+{
+  // hash table size is the power of two at least twice the entry count
+  size_t size = 16;
+  while(size < count * 2)
+    size <<= 1;
+
+  zmir->hash_tabl = static_cast<uint32_t*>(Om_alloc(size * sizeof(uint32_t)));
+  if(!zmir->hash_tabl)
+    return false;
+
+  Om_memset(zmir->hash_tabl, 0, size * sizeof(uint32_t));
+  zmir->hash_mask = size - 1;
+
+  for(size_t i = 0; i < count; ++i) {
+
+    size_t slot = __zip_path_hash(zmir->str_pool + zmir->path_offs[i], zmir->path_size[i]) & zmir->hash_mask;
+
+    // linear probing, first inserted entry remains first found
+    while(zmir->hash_tabl[slot] != 0)
+      slot = (slot + 1) & zmir->hash_mask;
+
+    zmir->hash_tabl[slot] = i + 1;
+  }
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline int64_t __zip_mirror_find(const zip_mirror_t* zmir, const OmWString& path)
+{
+  if(!zmir || !zmir->hash_tabl)
+    return -1;
+
+  size_t slot = __zip_path_hash(path.c_str(), path.size()) & zmir->hash_mask;
+
+  while(zmir->hash_tabl[slot] != 0) {
+
+    size_t i = zmir->hash_tabl[slot] - 1;
+
+    if(zmir->path_size[i] == path.size())
+      if(__zip_path_match(zmir->str_pool + zmir->path_offs[i], path.c_str(), path.size()))
+        return i;
+
+    slot = (slot + 1) & zmir->hash_mask;
+  }
+
+  return -1;
+}
+
+
+/// \brief Zip mapped central-directory header
+///
+/// Central-directory file header fields as parsed from mapped zip file
+///
+typedef struct zip_map_cdh_
+{
+  uint16_t        version_madeby;     //< version made by
+
+  uint16_t        flag;               //< general purpose bit flag
+
+  uint16_t        method;             //< compression method
+
+  uint32_t        crc;                //< data CRC-32
+
+  uint64_t        compressed_size;    //< compressed data size
+
+  uint64_t        uncompressed_size;  //< uncompressed data size
+
+  uint64_t        local_offset;       //< local file header offset
+
+  uint32_t        external_fa;        //< external file attributes
+
+  const char*     filename;           //< filename, not null-terminated
+
+  uint16_t        filename_size;      //< filename size in bytes
+
+  uint64_t        size;               //< whole header size in bytes
+
+} zip_map_cdh_t;
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline uint16_t __zip_map_u16(const uint8_t* p)
+{
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline uint32_t __zip_map_u32(const uint8_t* p)
+{
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+        (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline uint64_t __zip_map_u64(const uint8_t* p)
+{
+  return static_cast<uint64_t>(__zip_map_u32(p)) | (static_cast<uint64_t>(__zip_map_u32(p + 4)) << 32);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static bool __zip_map_parse_eocd(const uint8_t* data, uint64_t size, uint64_t* cd_offs, uint64_t* cd_size, uint64_t* cd_count)
+{
+  if(size < 22)
+    return false;
+
+  // search end of central directory record backward, it may be followed
+  // by a comment of at most 65535 bytes
+  uint64_t eocd = size - 22;
+  uint64_t stop = (size > 22 + 65535) ? size - 22 - 65535 : 0;
+
+  while(true) {
+    if(__zip_map_u32(data + eocd) == 0x06054b50)
+      if(eocd + 22 + __zip_map_u16(data + eocd + 20) == size)
+        break;
+
+    if(eocd == stop)
+      return false;
+
+    --eocd;
+  }
+
+  // multi-disk archives are not supported by this reader
+  if(__zip_map_u16(data + eocd + 4) != 0 || __zip_map_u16(data + eocd + 6) != 0)
+    return false;
+
+  *cd_count = __zip_map_u16(data + eocd + 10);
+  *cd_size = __zip_map_u32(data + eocd + 12);
+  *cd_offs = __zip_map_u32(data + eocd + 16);
+
+  // check for zip64 end of central directory locator
+  if(eocd >= 20 && __zip_map_u32(data + eocd - 20) == 0x07064b50) {
+
+    uint64_t eocd64 = __zip_map_u64(data + eocd - 20 + 8);
+
+    if(eocd64 + 56 > eocd || __zip_map_u32(data + eocd64) != 0x06064b50)
+      return false;
+
+    *cd_count = __zip_map_u64(data + eocd64 + 32);
+    *cd_size = __zip_map_u64(data + eocd64 + 40);
+    *cd_offs = __zip_map_u64(data + eocd64 + 48);
+  }
+
+  // archive with prepended data are left to stream reader
+  if(*cd_offs + *cd_size > eocd)
+    return false;
+
+  if(*cd_count && __zip_map_u32(data + *cd_offs) != 0x02014b50)
+    return false;
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static bool __zip_map_parse_cdh(const uint8_t* p, uint64_t avail, zip_map_cdh_t* cdh)
+{
+  if(avail < 46 || __zip_map_u32(p) != 0x02014b50)
+    return false;
+
+  cdh->version_madeby = __zip_map_u16(p + 4);
+  cdh->flag = __zip_map_u16(p + 8);
+  cdh->method = __zip_map_u16(p + 10);
+  cdh->crc = __zip_map_u32(p + 16);
+  cdh->compressed_size = __zip_map_u32(p + 20);
+  cdh->uncompressed_size = __zip_map_u32(p + 24);
+  cdh->filename_size = __zip_map_u16(p + 28);
+  cdh->external_fa = __zip_map_u32(p + 38);
+  cdh->local_offset = __zip_map_u32(p + 42);
+  cdh->filename = reinterpret_cast<const char*>(p + 46);
+
+  uint16_t extra_size = __zip_map_u16(p + 30);
+
+  cdh->size = 46 + cdh->filename_size + extra_size + __zip_map_u16(p + 32);
+  if(cdh->size > avail)
+    return false;
+
+  // search for zip64 extended information extra field
+  const uint8_t* ex = p + 46 + cdh->filename_size;
+  const uint8_t* ex_end = ex + extra_size;
+
+  while(ex + 4 <= ex_end) {
+
+    uint16_t ex_id = __zip_map_u16(ex);
+    const uint8_t* fd = ex + 4;
+    const uint8_t* fd_end = fd + __zip_map_u16(ex + 2);
+
+    if(fd_end > ex_end)
+      break;
+
+    if(ex_id == 0x0001) {
+      if(cdh->uncompressed_size == UINT32_MAX && fd + 8 <= fd_end) {
+        cdh->uncompressed_size = __zip_map_u64(fd); fd += 8;
+      }
+      if(cdh->compressed_size == UINT32_MAX && fd + 8 <= fd_end) {
+        cdh->compressed_size = __zip_map_u64(fd); fd += 8;
+      }
+      if(cdh->local_offset == UINT32_MAX && fd + 8 <= fd_end) {
+        cdh->local_offset = __zip_map_u64(fd);
+      }
+      break;
+    }
+
+    ex = fd_end;
+  }
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline void __zip_map_close(zip_context_t* zctx)
+{
+  if(zctx->map_data) {
+    UnmapViewOfFile(zctx->map_data);
+    zctx->map_data = nullptr;
+  }
+
+  if(zctx->map_hnd) {
+    CloseHandle(zctx->map_hnd);
+    zctx->map_hnd = nullptr;
+  }
+
+  if(zctx->map_file) {
+    CloseHandle(zctx->map_file);
+    zctx->map_file = nullptr;
+  }
+
+  zctx->map_size = 0;
+}
+
+
+/// \brief Zip batch limits
+///
+/// Limits for parallel compression of zip entries batch
+///
+#define ZIP_BATCH_MAX_THREADS   8         //< maximum count of compression workers
+#define ZIP_BATCH_MAX_SIZE      16777216  //< maximum file size to be compressed in memory
+
+/// \brief Zip batch job status
+///
+/// Status definitions for zip batch job
+///
+#define ZIP_BATCH_PEND    0 //< Job is waiting for a worker
+#define ZIP_BATCH_WORK    1 //< Job is being compressed by a worker
+#define ZIP_BATCH_DONE    2 //< Job is compressed and ready to be appended
+#define ZIP_BATCH_FAIL    3 //< Job compression failed
+#define ZIP_BATCH_SERL    4 //< Job is to be processed by sequencer
+
+/// \brief Zip batch job structure
+///
+/// Internal structure for a single entry of zip batch, holding the
+/// compressed entry as single-entry zip within a memory stream.
+///
+typedef struct zip_batch_job_
+{
+  void*           strm_mem;     //< memory stream holding compressed entry
+
+  void*           zip_hnd;      //< zip reader over memory stream
+
+  int32_t         mz_err;       //< compression error code
+
+  const wchar_t*  ws_err;       //< compression error string
+
+  uint64_t        size;         //< source file size
+
+  uint32_t        state;        //< job status
+
+} zip_batch_job_t;
+
+/// \brief Zip batch context structure
+///
+/// Internal structure shared between compression workers and the
+/// sequencer which appends compressed entries to zip in order.
+///
+typedef struct zip_batch_
+{
+  const OmWStringArray*   src;          //< entries source files
+
+  const OmWStringArray*   dst;          //< entries destination path in zip
+
+  zip_batch_job_t*        job;          //< entries jobs array
+
+  size_t                  count;        //< entries count
+
+  size_t                  next;         //< next job to be picked by a worker
+
+  size_t                  limit;        //< end of in-flight jobs window
+
+  int32_t                 cmp_method;   //< compression method
+
+  int32_t                 cmp_level;    //< compression level
+
+  bool                    abort;        //< workers should quit
+
+  CRITICAL_SECTION        lock;         //< shared data lock
+
+  CONDITION_VARIABLE      job_cv;       //< signaled when window moves or abort
+
+  CONDITION_VARIABLE      end_cv;       //< signaled when a job ends
+
+} zip_batch_t;
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-typedef struct zip_context_
+static inline void __zip_batch_job_free(zip_batch_job_t* job)
 {
-  void*         zip_hnd;
+  if(job->zip_hnd) {
+    mz_zip_close(job->zip_hnd);
+    mz_zip_delete(&job->zip_hnd);
+  }
 
-  void*         strm_file;
+  if(job->strm_mem) {
+    mz_stream_mem_close(job->strm_mem);
+    mz_stream_mem_delete(&job->strm_mem);
+  }
+}
 
-  void*         strm_buff;
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static int32_t __zip_batch_compress(zip_batch_job_t* job, const OmWString& src, const OmWString& dst, int32_t method, int32_t level, uint8_t* buffer)
+{
+  int32_t mz_err;
 
-  void*         strm_splt;
+  mz_zip_file file_info;
+  memset(&file_info, 0, sizeof(file_info));
 
-  int32_t       cmp_level;
+  OmCString utf8_src, zcdr_dst;
 
-  int32_t       cmp_method;
+  Om_toUTF8(&utf8_src, src);
+  Om_toZipCDR(&zcdr_dst, dst);
 
-  int32_t       mz_err;
+  // same file informations as OmArchive::entryAdd
+  file_info.version_madeby = MZ_VERSION_MADEBY;
+  file_info.compression_method = method;
 
-  OmWString     ws_err;
+  file_info.filename = zcdr_dst.c_str();
+  file_info.uncompressed_size = mz_os_get_file_size(utf8_src.c_str());
+  file_info.flag = MZ_ZIP_FLAG_UTF8;
+  mz_os_get_file_date(utf8_src.c_str(), &file_info.modified_date, &file_info.accessed_date, &file_info.creation_date);
+  mz_os_get_file_attribs(utf8_src.c_str(), &file_info.external_fa);
+
+  // memory stream to receive single-entry zip, sized to avoid repeated reallocations
+  job->strm_mem = mz_stream_mem_create();
+  if(!job->strm_mem) {
+    job->ws_err = L"create stream mem error";
+    return MZ_MEM_ERROR;
+  }
 
-  uint8_t       buffer[ZIP_IO_BUF_SIZE];
+  int32_t grow_size = static_cast<int32_t>(file_info.uncompressed_size) + 4096;
+  if(grow_size < 65536) grow_size = 65536;
+  mz_stream_mem_set_grow_size(job->strm_mem, grow_size);
 
-} zip_context_t;
+  mz_err = mz_stream_mem_open(job->strm_mem, nullptr, MZ_OPEN_MODE_CREATE);
+  if(mz_err != MZ_OK) {
+    job->ws_err = L"stream mem open error";
+    return mz_err;
+  }
+
+  void* stream = mz_stream_os_create();
+  if(!stream) {
+    job->ws_err = L"create stream OS error";
+    return MZ_MEM_ERROR;
+  }
+
+  mz_err = mz_stream_os_open(stream, utf8_src.c_str(), MZ_OPEN_MODE_READ);
+  if(mz_err != MZ_OK) {
+    job->ws_err = L"stream open error";
+    mz_stream_os_delete(&stream);
+    return mz_err;
+  }
+
+  void* zip_hnd = mz_zip_create();
+  if(!zip_hnd) {
+    job->ws_err = L"zip handle create error";
+    mz_stream_os_close(stream);
+    mz_stream_os_delete(&stream);
+    return MZ_MEM_ERROR;
+  }
+
+  mz_err = mz_zip_open(zip_hnd, job->strm_mem, MZ_OPEN_MODE_WRITE);
+
+  if(mz_err == MZ_OK) {
+
+    mz_err = mz_zip_entry_write_open(zip_hnd, &file_info, level, 0, nullptr);
+
+    if(mz_err == MZ_OK) {
+
+      int32_t wb = 0;
+      int32_t rb = 0;
+
+      while(mz_err == MZ_OK) {
+        rb = mz_stream_read(stream, buffer, ZIP_IO_BUF_SIZE);
+        if(rb > 0) {
+          wb = mz_zip_entry_write(zip_hnd, buffer, rb);
+          if(wb != rb) {
+            mz_err = MZ_WRITE_ERROR;
+            break;
+          }
+        } else if(rb < 0) {
+          mz_err = rb;
+          break;
+        } else {
+          mz_err = MZ_END_OF_STREAM;
+          break;
+        }
+      }
+
+      if(mz_err == MZ_END_OF_STREAM)
+        mz_err = mz_zip_entry_close(zip_hnd);
+
+      if(mz_err != MZ_OK) job->ws_err = L"entry compress error";
+
+    } else {
+      job->ws_err = L"entry write open error";
+    }
+
+    int32_t mz_cls = mz_zip_close(zip_hnd);
+    if(mz_err == MZ_OK && mz_cls != MZ_OK) {
+      mz_err = mz_cls; job->ws_err = L"zip close error";
+    }
+
+  } else {
+    job->ws_err = L"zip open error";
+  }
+
+  mz_zip_delete(&zip_hnd);
+
+  mz_stream_os_close(stream);
+  mz_stream_os_delete(&stream);
+
+  if(mz_err != MZ_OK)
+    return mz_err;
+
+  // reopen memory stream as zip reader, positioned on the single entry
+  job->zip_hnd = mz_zip_create();
+  if(!job->zip_hnd) {
+    job->ws_err = L"zip handle create error";
+    return MZ_MEM_ERROR;
+  }
+
+  mz_err = mz_zip_open(job->zip_hnd, job->strm_mem, MZ_OPEN_MODE_READ);
+  if(mz_err == MZ_OK)
+    mz_err = mz_zip_goto_first_entry(job->zip_hnd);
+
+  if(mz_err != MZ_OK) {
+    job->ws_err = L"zip reopen error";
+    return mz_err;
+  }
 
+  return MZ_OK;
+}
 
-/// \brief Zip entry structure
 ///
-/// Internal structure to store zip file entry informations
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-typedef struct zip_entry_
+static DWORD WINAPI __zip_batch_run_fn(void* ptr)
 {
-  int64_t         offset;
-
-  int32_t         method;
+  zip_batch_t* zbat = static_cast<zip_batch_t*>(ptr);
+
+  // each worker owns its own I/O buffer
+  uint8_t* buffer = __zip_buf_acquire();
+
+  EnterCriticalSection(&zbat->lock);
+
+  while(true) {
+
+    // wait for a job within the in-flight window
+    while(!zbat->abort && zbat->next < zbat->count && zbat->next >= zbat->limit)
+      SleepConditionVariableCS(&zbat->job_cv, &zbat->lock, INFINITE);
+
+    if(zbat->abort || zbat->next >= zbat->count)
+      break;
+
+    zip_batch_job_t* job = &zbat->job[zbat->next];
+    size_t i = zbat->next++;
+
+    if(job->state == ZIP_BATCH_SERL)
+      continue;
+
+    job->state = ZIP_BATCH_WORK;
+
+    LeaveCriticalSection(&zbat->lock);
+
+    int32_t mz_err = MZ_MEM_ERROR;
+
+    if(buffer) {
+      mz_err = __zip_batch_compress(job, (*zbat->src)[i], (*zbat->dst)[i], zbat->cmp_method, zbat->cmp_level, buffer);
+    } else {
+      job->ws_err = L"buffer allocation error";
+    }
+
+    #ifdef DEBUG
+    Sleep(20); //< for debug
+    #endif
+
+    EnterCriticalSection(&zbat->lock);
+
+    job->mz_err = mz_err;
+    job->state = (mz_err == MZ_OK) ? ZIP_BATCH_DONE : ZIP_BATCH_FAIL;
+
+    WakeAllConditionVariable(&zbat->end_cv);
+  }
+
+  LeaveCriticalSection(&zbat->lock);
+
+  __zip_buf_release(buffer);
+
+  return 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static int32_t __zip_entry_copy(void* dst_hnd, void* src_hnd, const char* filename, int32_t method, int16_t level, uint8_t raw, uint8_t* buffer, Om_progressCb progress_cb, void* user_ptr, uint64_t param, const wchar_t** ws_err)
+{
+  int32_t mz_err;
+
+  if(!buffer) {
+    *ws_err = L"buffer allocation error";
+    return MZ_MEM_ERROR;
+  }
+
+  // get source entry info, source must be positioned on entry
+  mz_zip_file* src_info = nullptr;
+  mz_err = mz_zip_entry_get_info(src_hnd, &src_info);
+  if(mz_err != MZ_OK) {
+    *ws_err = L"entry get info error";
+    return mz_err;
+  }
+
+  mz_zip_file file_info;
+  memcpy(&file_info, src_info, sizeof(mz_zip_file));
+
+  // zip64, ntfs and unix extra fields are regenerated by writer,
+  // data descriptor flag is set again by writer if required
+  file_info.extrafield = nullptr;
+  file_info.extrafield_size = 0;
+  file_info.comment = nullptr;
+  file_info.comment_size = 0;
+  file_info.flag &= ~MZ_ZIP_FLAG_DATA_DESCRIPTOR;
+
+  if(raw) {
+    // level 0 forces STORE, use proper level to keep method
+    if(file_info.compression_method != MZ_COMPRESS_METHOD_STORE && level == 0)
+      level = OM_LEVEL_SLOW;
+  } else {
+    // compression flags are set again by writer
+    file_info.flag &= MZ_ZIP_FLAG_UTF8;
+    file_info.compression_method = method;
+  }
+
+  if(filename) {
+    file_info.filename = filename;
+    file_info.flag |= MZ_ZIP_FLAG_UTF8;
+  }
+
+  bool is_dir = (mz_zip_entry_is_dir(src_hnd) == MZ_OK);
+
+  if(!is_dir) {
+    mz_err = mz_zip_entry_read_open(src_hnd, raw, nullptr);
+    if(mz_err != MZ_OK) {
+      *ws_err = L"entry read open error";
+      return mz_err;
+    }
+  }
+
+  mz_err = mz_zip_entry_write_open(dst_hnd, &file_info, level, raw, nullptr);
+  if(mz_err != MZ_OK) {
+    *ws_err = L"entry write open error";
+    if(!is_dir) mz_zip_entry_close(src_hnd);
+    return mz_err;
+  }
+
+  if(is_dir) {
+    mz_err = mz_zip_entry_close(dst_hnd);
+    if(mz_err != MZ_OK) *ws_err = L"entry close error";
+    return mz_err;
+  }
+
+  uint64_t total = raw ? src_info->compressed_size : src_info->uncompressed_size;
+
+  int32_t wb = 0;
+  int32_t rb = 0;
+
+  while(mz_err == MZ_OK) {
+    rb = mz_zip_entry_read(src_hnd, buffer, ZIP_IO_BUF_SIZE);
+    if(rb > 0) {
+      wb = mz_zip_entry_write(dst_hnd, buffer, rb);
+      if(wb != rb) {
+        mz_err = MZ_WRITE_ERROR;
+        break;
+      }
+    } else if(rb < 0) {
+      mz_err = rb;
+      break;
+    } else {
+      mz_err = MZ_END_OF_STREAM;
+      break;
+    }
+
+    if(progress_cb) {
+      progress_cb(user_ptr, total, rb, param);
+    }
+  }
+
+  if(mz_err != MZ_END_OF_STREAM) {
+    *ws_err = L"entry copy error";
+    mz_zip_entry_close(src_hnd);
+    mz_zip_entry_close(dst_hnd);
+    return mz_err;
+  }
+
+  if(raw) {
 
-  int32_t         is_dir;
+    uint32_t crc = 0;
+    int64_t csize = 0, usize = 0;
 
-  uint64_t        file_size;
+    mz_zip_entry_read_close(src_hnd, &crc, &csize, &usize);
+
+    mz_err = mz_zip_entry_write_close(dst_hnd, crc, csize, usize);
+
+  } else {
+
+    // closing reader verify CRC of inflated data
+    mz_err = mz_zip_entry_close(src_hnd);
+    if(mz_err != MZ_OK) {
+      *ws_err = L"entry read close error";
+      mz_zip_entry_close(dst_hnd);
+      return mz_err;
+    }
+
+    mz_err = mz_zip_entry_close(dst_hnd);
+  }
 
-  wchar_t         file_path[OM_MAX_PATH];
+  if(mz_err != MZ_OK) {
+    *ws_err = L"entry write close error";
+    return mz_err;
+  }
 
-} zip_entry_t;
+  return MZ_OK;
+}
 
 
 ///
@@ -100,8 +1016,8 @@ OmArchive::OmArchive():
   _zent_size(0),
   _stat(0)
 {
-  // create zip base architecture
-  this->_zctx = calloc(1, sizeof(zip_context_t));
+  // create zip base architecture, I/O buffer is acquired on first need
+  this->_zctx = new zip_context_t();
 }
 
 
@@ -113,7 +1029,7 @@ OmArchive::~OmArchive()
   this->close();
 
   if(this->_zctx != nullptr) {
-    free(this->_zctx);
+    delete static_cast<zip_context_t*>(this->_zctx);
   }
 }
 
@@ -121,7 +1037,7 @@ OmArchive::~OmArchive()
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-bool OmArchive::read(const OmWString& path)
+bool OmArchive::read(const OmWString& path, int32_t reader)
 {
   // close and reset interface if any
   this->close();
@@ -131,6 +1047,13 @@ bool OmArchive::read(const OmWString& path)
   // let be it a reader
   this->_stat = ZIP_READER;
 
+  // try memory-mapped reader, stream reader is used as fallback for
+  // archives the mapped reader cannot handle
+  if(reader == OM_READER_MAPPED) {
+    if(this->_read_mapped(path))
+      return true;
+  }
+
   // create zip reader architecture
   zctx->strm_file = mz_stream_os_create();
   if(!zctx->strm_file) {
@@ -262,61 +1185,250 @@ bool OmArchive::read(const OmWString& path)
   // allocate local zip central directory mirror
   mz_zip_get_number_entry(zctx->zip_hnd, &this->_zent_size);
 
-  this->_zent = Om_alloc(this->_zent_size * sizeof(zip_entry_t));
+  this->_zent = __zip_mirror_alloc(this->_zent_size);
   if(!this->_zent) {
     this->close();
     zctx->mz_err = MZ_MEM_ERROR; zctx->ws_err = L"mirror central-directory error";
     return false;
   }
 
-  Om_memset(this->_zent, 0, this->_zent_size * sizeof(zip_entry_t));
+  zip_mirror_t* zmir = static_cast<zip_mirror_t*>(this->_zent);
+
+  mz_zip_file *file_info = nullptr;
+
+  size_t i = 0;
+
+  do {
+    mz_err = mz_zip_entry_get_info(zctx->zip_hnd, &file_info);
+    if(mz_err != MZ_OK) break;
+
+    // should never happen, but who knows...
+    if(i >= this->_zent_size) {
+      mz_err = MZ_FORMAT_ERROR;
+      break;
+    }
+
+    zmir->offset[i] = mz_zip_get_entry(zctx->zip_hnd);
+    zmir->method[i] = file_info->compression_method;
+    zmir->is_dir[i] = (mz_zip_entry_is_dir(zctx->zip_hnd) == MZ_OK);
+    zmir->file_size[i] = file_info->uncompressed_size;
+    zmir->crc[i] = file_info->crc;
+
+    if(!__zip_mirror_add_path(zmir, i, file_info->filename, strlen(file_info->filename))) {
+      mz_err = MZ_MEM_ERROR;
+      break;
+    }
+
+    // next entry
+    ++i;
+
+    if(mz_zip_entry_is_open(zctx->zip_hnd) == MZ_OK)
+      mz_zip_entry_close(zctx->zip_hnd);
+
+    mz_err = mz_zip_goto_next_entry(zctx->zip_hnd);
+    if(mz_err != MZ_OK && mz_err != MZ_END_OF_LIST)
+      break;
+
+  } while(mz_err == MZ_OK);
+
+  if(mz_err != MZ_OK && mz_err != MZ_END_OF_LIST) {
+    this->close();
+    zctx->mz_err = mz_err;  zctx->ws_err = L"central directory walk error";
+    return false;
+  }
+
+  // keep only what was actually mirrored
+  this->_zent_size = i;
+
+  // build entries path hash index for quick lookup
+  if(!__zip_mirror_index(zmir, this->_zent_size)) {
+    this->close();
+    zctx->mz_err = MZ_MEM_ERROR;  zctx->ws_err = L"central directory index error";
+    return false;
+  }
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmArchive::_read_mapped(const OmWString& path)
+{
+  zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
+
+  // reading a mapped view raises an exception instead of returning an error
+  // when underlying storage fails (network share lost, removable media
+  // unplugged), so mapped reader is restricted to local fixed drives
+  wchar_t vol_path[OM_MAX_PATH];
+  if(!GetVolumePathNameW(path.c_str(), vol_path, OM_MAX_PATH))
+    return false;
+
+  if(GetDriveTypeW(vol_path) != DRIVE_FIXED)
+    return false;
+
+  zctx->map_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(zctx->map_file == INVALID_HANDLE_VALUE) {
+    zctx->map_file = nullptr;
+    return false;
+  }
+
+  // minizip memory stream is limited to 32-bit size
+  LARGE_INTEGER file_size;
+  if(!GetFileSizeEx(zctx->map_file, &file_size) || file_size.QuadPart < 22 || file_size.QuadPart > INT32_MAX) {
+    __zip_map_close(zctx);
+    return false;
+  }
+
+  zctx->map_hnd = CreateFileMappingW(zctx->map_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if(!zctx->map_hnd) {
+    __zip_map_close(zctx);
+    return false;
+  }
+
+  zctx->map_data = static_cast<uint8_t*>(MapViewOfFile(zctx->map_hnd, FILE_MAP_READ, 0, 0, 0));
+  if(!zctx->map_data) {
+    __zip_map_close(zctx);
+    return false;
+  }
+
+  zctx->map_size = file_size.QuadPart;
+
+  // parse central directory directly from mapped file
+  uint64_t cd_offs, cd_size, cd_count;
+  if(!__zip_map_parse_eocd(zctx->map_data, zctx->map_size, &cd_offs, &cd_size, &cd_count)) {
+    __zip_map_close(zctx);
+    return false;
+  }
+
+  zip_mirror_t* zmir = __zip_mirror_alloc(cd_count);
+  if(!zmir) {
+    __zip_map_close(zctx);
+    return false;
+  }
+
+  zip_map_cdh_t cdh;
+
+  uint64_t cd_pos = cd_offs;
+  uint64_t cd_end = cd_offs + cd_size;
+
+  size_t i = 0;
+
+  for(; i < cd_count; ++i) {
+
+    if(!__zip_map_parse_cdh(zctx->map_data + cd_pos, cd_end - cd_pos, &cdh))
+      break;
+
+    // compressed central directory is left to stream reader
+    if(i == 0 && cdh.filename_size == 8 && memcmp(cdh.filename, "__cdcd__", 8) == 0)
+      break;
+
+    // same offset as minizip central directory position
+    zmir->offset[i] = cd_pos;
+    zmir->method[i] = cdh.method;
+    zmir->file_size[i] = cdh.uncompressed_size;
+    zmir->crc[i] = cdh.crc;
+    zmir->is_dir[i] = (mz_zip_attrib_is_dir(cdh.external_fa, cdh.version_madeby) == MZ_OK);
+
+    if(cdh.filename_size > 0) {
+      char last = cdh.filename[cdh.filename_size - 1];
+      if(last == '/' || last == '\\') zmir->is_dir[i] = true;
+    }
+
+    if(!__zip_mirror_add_path(zmir, i, cdh.filename, cdh.filename_size))
+      break;
+
+    cd_pos += cdh.size;
+  }
+
+  if(i != cd_count || !__zip_mirror_index(zmir, cd_count)) {
+    __zip_mirror_free(zmir);
+    __zip_map_close(zctx);
+    return false;
+  }
+
+  // minizip reader over mapped memory for compressed entries
+  int32_t mz_err = MZ_MEM_ERROR;
+
+  zctx->strm_mmem = mz_stream_mem_create();
+  if(zctx->strm_mmem) {
+    mz_stream_mem_set_buffer(zctx->strm_mmem, zctx->map_data, static_cast<int32_t>(zctx->map_size));
+    mz_err = mz_stream_mem_open(zctx->strm_mmem, nullptr, MZ_OPEN_MODE_READ);
+  }
+
+  if(mz_err == MZ_OK) {
+    zctx->zip_hnd = mz_zip_create();
+    if(zctx->zip_hnd) {
+      mz_err = mz_zip_open(zctx->zip_hnd, zctx->strm_mmem, MZ_OPEN_MODE_READ);
+    } else {
+      mz_err = MZ_MEM_ERROR;
+    }
+  }
+
+  if(mz_err != MZ_OK) {
+    if(zctx->zip_hnd) mz_zip_delete(&zctx->zip_hnd);
+    if(zctx->strm_mmem) mz_stream_mem_delete(&zctx->strm_mmem);
+    __zip_mirror_free(zmir);
+    __zip_map_close(zctx);
+    return false;
+  }
+
+  this->_zent = zmir;
+  this->_zent_size = cd_count;
+  this->_stat |= ZIP_MAPPED;
+
+  return true;
+}
+
 
-  zip_entry_t* zent = static_cast<zip_entry_t*>(this->_zent);
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+const void* OmArchive::entryData(size_t i, uint64_t* size) const
+{
+  if((this->_stat & ZIP_MAPPED) && i < this->_zent_size) {
 
-  mz_zip_file *file_info = nullptr;
+    zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
+    zip_mirror_t* zmir = static_cast<zip_mirror_t*>(this->_zent);
 
-  do {
-    mz_err = mz_zip_entry_get_info(zctx->zip_hnd, &file_info);
-    if(mz_err != MZ_OK) break;
+    // only stored data can be handed out as is
+    if(zmir->method[i] != MZ_COMPRESS_METHOD_STORE || zmir->is_dir[i])
+      return nullptr;
 
-    zent->offset = mz_zip_get_entry(zctx->zip_hnd);
-    zent->method = file_info->compression_method;
-    zent->is_dir = (mz_zip_entry_is_dir(zctx->zip_hnd) == MZ_OK);
-    zent->file_size = file_info->uncompressed_size;
-    // convert filename UTF-8 to UTF-16
-    MultiByteToWideChar(CP_UTF8, 0, file_info->filename, -1, zent->file_path, OM_MAX_PATH);
-    // replace slash by back-slash
-    for(size_t i = 0; zent->file_path[i] != 0; ++i)
-      if(zent->file_path[i] == L'/') zent->file_path[i] = L'\\';
+    zip_map_cdh_t cdh;
+    if(!__zip_map_parse_cdh(zctx->map_data + zmir->offset[i], zctx->map_size - zmir->offset[i], &cdh))
+      return nullptr;
 
-    // next entry
-    zent++;
+    if(cdh.flag & MZ_ZIP_FLAG_ENCRYPTED)
+      return nullptr;
 
-    if(mz_zip_entry_is_open(zctx->zip_hnd) == MZ_OK)
-      mz_zip_entry_close(zctx->zip_hnd);
+    // skip local file header to reach data
+    uint64_t pos = cdh.local_offset;
+    if(pos + 30 > zctx->map_size || __zip_map_u32(zctx->map_data + pos) != 0x04034b50)
+      return nullptr;
 
-    mz_err = mz_zip_goto_next_entry(zctx->zip_hnd);
-    if(mz_err != MZ_OK && mz_err != MZ_END_OF_LIST)
-      break;
+    pos += 30 + __zip_map_u16(zctx->map_data + pos + 26) + __zip_map_u16(zctx->map_data + pos + 28);
+    if(pos + cdh.compressed_size > zctx->map_size)
+      return nullptr;
 
-  } while(mz_err == MZ_OK);
+    *size = cdh.compressed_size;
 
-  if(mz_err != MZ_OK && mz_err != MZ_END_OF_LIST) {
-    this->close();
-    zctx->mz_err = mz_err;  zctx->ws_err = L"central directory walk error";
-    return false;
+    return zctx->map_data + pos;
   }
 
-  return true;
+  return nullptr;
 }
 
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
 const wchar_t* OmArchive::entryPath(size_t i) const
 {
-  if(i < this->_zent_size)
-    return static_cast<zip_entry_t*>(this->_zent)[i].file_path;
+  if(i < this->_zent_size) {
+    zip_mirror_t* zmir = static_cast<zip_mirror_t*>(this->_zent);
+    return zmir->str_pool + zmir->path_offs[i];
+  }
 
   return nullptr;
 }
@@ -326,8 +1438,10 @@ const wchar_t* OmArchive::entryPath(size_t i) const
 ///
 void OmArchive::entryPath(size_t i, OmWString& path) const
 {
-  if(i < this->_zent_size)
-    path = static_cast<zip_entry_t*>(this->_zent)[i].file_path;
+  if(i < this->_zent_size) {
+    zip_mirror_t* zmir = static_cast<zip_mirror_t*>(this->_zent);
+    path.assign(zmir->str_pool + zmir->path_offs[i], zmir->path_size[i]);
+  }
 }
 
 ///
@@ -336,18 +1450,29 @@ void OmArchive::entryPath(size_t i, OmWString& path) const
 uint64_t OmArchive::entrySize(size_t i) const
 {
   if(i < this->_zent_size)
-    return static_cast<zip_entry_t*>(this->_zent)[i].file_size;
+    return static_cast<zip_mirror_t*>(this->_zent)->file_size[i];
 
   return 0L;
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+uint32_t OmArchive::entryCrc(size_t i) const
+{
+  if(i < this->_zent_size)
+    return static_cast<zip_mirror_t*>(this->_zent)->crc[i];
+
+  return 0;
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
 bool OmArchive::entryIsDir(size_t i) const
 {
   if(i < this->_zent_size)
-    return static_cast<zip_entry_t*>(this->_zent)[i].is_dir;
+    return static_cast<zip_mirror_t*>(this->_zent)->is_dir[i];
 
   return false;
 }
@@ -358,11 +1483,23 @@ bool OmArchive::entryIsDir(size_t i) const
 int32_t OmArchive::entryMethod(size_t i) const
 {
   if(i < this->_zent_size)
-    return static_cast<zip_entry_t*>(this->_zent)[i].method;
+    return static_cast<zip_mirror_t*>(this->_zent)->method[i];
 
   return -1;
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmArchive::setSaveTree(bool enable)
+{
+  if(enable) {
+    this->_stat &= ~ZIP_NOTREE;
+  } else {
+    this->_stat |= ZIP_NOTREE;
+  }
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -377,9 +1514,9 @@ bool OmArchive::entrySave(size_t i, const OmWString& dst, Om_progressCb progress
       return true; //< fail silently
 
     zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
-    zip_entry_t* zent = static_cast<zip_entry_t*>(this->_zent);
+    zip_mirror_t* zmir = static_cast<zip_mirror_t*>(this->_zent);
 
-    mz_err = mz_zip_goto_entry(zctx->zip_hnd, zent[i].offset);
+    mz_err = mz_zip_goto_entry(zctx->zip_hnd, zmir->offset[i]);
     if(mz_err != MZ_OK) {
       zctx->mz_err = mz_err;  zctx->ws_err = L"entry goto error";
       return false;
@@ -393,7 +1530,7 @@ bool OmArchive::entrySave(size_t i, const OmWString& dst, Om_progressCb progress
     if( (mz_zip_entry_is_dir(zctx->zip_hnd) == MZ_OK) &&
         (mz_zip_entry_is_symlink(zctx->zip_hnd) != MZ_OK)) {
 
-      if(!Om_isDir(dst)) {
+      if(!(this->_stat & ZIP_NOTREE) && !Om_isDir(dst)) {
         // we simply create directory
         mz_err = Om_dirCreateRecursive(dst);
         if(mz_err != ERROR_SUCCESS) {
@@ -407,15 +1544,18 @@ bool OmArchive::entrySave(size_t i, const OmWString& dst, Om_progressCb progress
 
     // TODO: implement symlink creation
 
-    OmWString dst_dir = Om_getDirPart(dst);
-
     // create the destination path tree if required
-    if(!Om_isDir(dst_dir)) {
-      // we simply create directory
-      mz_err = Om_dirCreateRecursive(dst_dir);
-      if(mz_err != ERROR_SUCCESS) {
-        zctx->mz_err = mz_err;  zctx->ws_err = L"create directory error";
-        return false;
+    if(!(this->_stat & ZIP_NOTREE)) {
+
+      OmWString dst_dir = Om_getDirPart(dst);
+
+      if(!Om_isDir(dst_dir)) {
+        // we simply create directory
+        mz_err = Om_dirCreateRecursive(dst_dir);
+        if(mz_err != ERROR_SUCCESS) {
+          zctx->mz_err = mz_err;  zctx->ws_err = L"create directory error";
+          return false;
+        }
       }
     }
 
@@ -431,7 +1571,36 @@ bool OmArchive::entrySave(size_t i, const OmWString& dst, Om_progressCb progress
 
     mz_err = mz_stream_os_open(stream, utf8_dst.c_str(), MZ_OPEN_MODE_CREATE);
 
-    if(mz_err == MZ_OK) {
+    // stored data from mapped file is written as is
+    uint64_t span_size = 0;
+    const uint8_t* span = static_cast<const uint8_t*>(this->entryData(i, &span_size));
+
+    if(mz_err == MZ_OK && span) {
+
+      uint32_t crc = 0;
+      uint64_t done = 0;
+
+      while(done < span_size) {
+
+        int32_t len = (span_size - done > ZIP_IO_BUF_SIZE) ? ZIP_IO_BUF_SIZE : static_cast<int32_t>(span_size - done);
+
+        if(mz_stream_write(stream, span + done, len) != len) {
+          mz_err = MZ_WRITE_ERROR;
+          break;
+        }
+
+        crc = mz_crypt_crc32_update(crc, span + done, len);
+        done += len;
+
+        if(progress_cb) {
+          progress_cb(user_ptr, file_info->uncompressed_size, len, reinterpret_cast<uint64_t>(zmir->str_pool + zmir->path_offs[i]));
+        }
+      }
+
+      if(mz_err == MZ_OK)
+        mz_err = (crc == file_info->crc) ? MZ_END_OF_STREAM : MZ_CRC_ERROR;
+
+    } else if(mz_err == MZ_OK) {
 
       // If the entry isn't open for reading, open it
       if(mz_zip_entry_is_open(zctx->zip_hnd) != MZ_OK)
@@ -446,10 +1615,13 @@ bool OmArchive::entrySave(size_t i, const OmWString& dst, Om_progressCb progress
       int32_t rb = 0;
 
       // Write data to stream until done
+      uint8_t* buffer = __zip_ctx_buffer(zctx);
+      if(!buffer) mz_err = MZ_MEM_ERROR;
+
       while(mz_err == MZ_OK) {
-        rb = mz_zip_entry_read(zctx->zip_hnd, zctx->buffer, sizeof(zctx->buffer));
+        rb = mz_zip_entry_read(zctx->zip_hnd, buffer, ZIP_IO_BUF_SIZE);
         if(rb > 0) {
-            wb = mz_stream_write(stream, zctx->buffer, rb);
+            wb = mz_stream_write(stream, buffer, rb);
             if(wb != rb) {
               mz_err = MZ_WRITE_ERROR;
               break;
@@ -462,7 +1634,7 @@ bool OmArchive::entrySave(size_t i, const OmWString& dst, Om_progressCb progress
           break;
         }
         if(progress_cb) {
-          progress_cb(user_ptr, file_info->uncompressed_size, wb, reinterpret_cast<uint64_t>(zent[i].file_path));
+          progress_cb(user_ptr, file_info->uncompressed_size, wb, reinterpret_cast<uint64_t>(zmir->str_pool + zmir->path_offs[i]));
         }
       }
       mz_zip_entry_close(zctx->zip_hnd);
@@ -500,12 +1672,10 @@ bool OmArchive::entrySave(size_t i, const OmWString& dst, Om_progressCb progress
 ///
 bool OmArchive::entrySave(const OmWString& entry, const OmWString& dst, Om_progressCb progress_cb, void* user_ptr) const
 {
-  zip_entry_t* zent = static_cast<zip_entry_t*>(this->_zent);
+  int64_t i = __zip_mirror_find(static_cast<zip_mirror_t*>(this->_zent), entry);
 
-  for(uint64_t i = 0; i < this->_zent_size; ++i) {
-    if(Om_namesMatches(zent[i].file_path, entry))
-      return this->entrySave(i, dst, progress_cb, user_ptr);
-  }
+  if(i >= 0)
+    return this->entrySave(i, dst, progress_cb, user_ptr);
 
   return false;
 }
@@ -525,9 +1695,9 @@ bool OmArchive::entrySave(size_t i, void* buffer, Om_progressCb progress_cb, voi
       return true; //< fail silently
 
     zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
-    zip_entry_t* zent = static_cast<zip_entry_t*>(this->_zent);
+    zip_mirror_t* zmir = static_cast<zip_mirror_t*>(this->_zent);
 
-    mz_err = mz_zip_goto_entry(zctx->zip_hnd, zent[i].offset);
+    mz_err = mz_zip_goto_entry(zctx->zip_hnd, zmir->offset[i]);
     if(mz_err != MZ_OK) {
       zctx->mz_err = mz_err;  zctx->ws_err = L"entry goto error";
       return false;
@@ -568,10 +1738,13 @@ bool OmArchive::entrySave(size_t i, void* buffer, Om_progressCb progress_cb, voi
       int32_t rb = 0;
 
       // Write data to stream until done
+      uint8_t* buffer = __zip_ctx_buffer(zctx);
+      if(!buffer) mz_err = MZ_MEM_ERROR;
+
       while(mz_err == MZ_OK) {
-        rb = mz_zip_entry_read(zctx->zip_hnd, zctx->buffer, sizeof(zctx->buffer));
+        rb = mz_zip_entry_read(zctx->zip_hnd, buffer, ZIP_IO_BUF_SIZE);
         if(rb > 0) {
-            wb = mz_stream_mem_write(stream, zctx->buffer, rb);
+            wb = mz_stream_mem_write(stream, buffer, rb);
             if(wb != rb) {
               mz_err = MZ_WRITE_ERROR;
               break;
@@ -585,7 +1758,7 @@ bool OmArchive::entrySave(size_t i, void* buffer, Om_progressCb progress_cb, voi
         }
 
         if(progress_cb) {
-          progress_cb(user_ptr, file_info->uncompressed_size, wb, reinterpret_cast<uint64_t>(zent[i].file_path));
+          progress_cb(user_ptr, file_info->uncompressed_size, wb, reinterpret_cast<uint64_t>(zmir->str_pool + zmir->path_offs[i]));
         }
       }
 
@@ -606,6 +1779,71 @@ bool OmArchive::entrySave(size_t i, void* buffer, Om_progressCb progress_cb, voi
 }
 
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmArchive::entryReadOpen(size_t i) const
+{
+  int32_t mz_err;
+
+  if(this->_stat & ZIP_READER) {
+
+    zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
+    zip_mirror_t* zmir = static_cast<zip_mirror_t*>(this->_zent);
+
+    if(i >= this->_zent_size) {
+      zctx->mz_err = MZ_PARAM_ERROR;  zctx->ws_err = L"entry index out of range";
+      return false;
+    }
+
+    // close previously opened entry if any
+    if(mz_zip_entry_is_open(zctx->zip_hnd) == MZ_OK)
+      mz_zip_entry_close(zctx->zip_hnd);
+
+    mz_err = mz_zip_goto_entry(zctx->zip_hnd, zmir->offset[i]);
+    if(mz_err != MZ_OK) {
+      zctx->mz_err = mz_err;  zctx->ws_err = L"entry goto error";
+      return false;
+    }
+
+    mz_err = mz_zip_entry_read_open(zctx->zip_hnd, 0, nullptr);
+    if(mz_err != MZ_OK) {
+      zctx->mz_err = mz_err;  zctx->ws_err = L"entry read open error";
+      return false;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+int64_t OmArchive::entryRead(void* buffer, size_t size) const
+{
+  if(this->_stat & ZIP_READER) {
+
+    zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
+
+    if(size > INT32_MAX)
+      size = INT32_MAX;
+
+    int32_t rb = mz_zip_entry_read(zctx->zip_hnd, buffer, static_cast<int32_t>(size));
+    if(rb < 0) {
+      zctx->mz_err = rb;  zctx->ws_err = L"entry read error";
+      return -1;
+    }
+
+    return rb;
+  }
+
+  return -1;
+}
+
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -757,10 +1995,13 @@ bool OmArchive::entryAdd(const OmWString& src, const OmWString& dst, Om_progress
       int32_t wb = 0;
       int32_t rb = 0;
 
+      uint8_t* buffer = __zip_ctx_buffer(zctx);
+      if(!buffer) mz_err = MZ_MEM_ERROR;
+
       while(mz_err == MZ_OK) {
-        rb = mz_stream_read(stream, zctx->buffer, sizeof(zctx->buffer));
+        rb = mz_stream_read(stream, buffer, ZIP_IO_BUF_SIZE);
         if(rb > 0) {
-            wb = mz_zip_entry_write(zctx->zip_hnd, zctx->buffer, rb);
+            wb = mz_zip_entry_write(zctx->zip_hnd, buffer, rb);
             if(wb != rb) {
               mz_err = MZ_WRITE_ERROR;
               break;
@@ -774,7 +2015,10 @@ bool OmArchive::entryAdd(const OmWString& src, const OmWString& dst, Om_progress
         }
 
         if(progress_cb) {
-          progress_cb(user_ptr, file_info.uncompressed_size, rb, reinterpret_cast<uint64_t>(dst.c_str()));
+          if(!progress_cb(user_ptr, file_info.uncompressed_size, rb, reinterpret_cast<uint64_t>(dst.c_str()))) {
+            mz_err = MZ_INTERNAL_ERROR;
+            break;
+          }
         }
 
         #ifdef DEBUG
@@ -876,10 +2120,13 @@ bool OmArchive::entryAdd(const void* data, uint64_t size, const OmWString& dst,
       int32_t wb = 0;
       int32_t rb = 0;
 
+      uint8_t* buffer = __zip_ctx_buffer(zctx);
+      if(!buffer) mz_err = MZ_MEM_ERROR;
+
       while(mz_err == MZ_OK) {
-        rb = mz_stream_mem_read(stream, zctx->buffer, sizeof(zctx->buffer));
+        rb = mz_stream_mem_read(stream, buffer, ZIP_IO_BUF_SIZE);
         if(rb > 0) {
-            wb = mz_zip_entry_write(zctx->zip_hnd, zctx->buffer, rb);
+            wb = mz_zip_entry_write(zctx->zip_hnd, buffer, rb);
             if(wb != rb) {
               mz_err = MZ_WRITE_ERROR;
               break;
@@ -928,16 +2175,265 @@ bool OmArchive::entryAdd(const void* data, uint64_t size, const OmWString& dst,
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-uint32_t OmArchive::entryLocate(const OmWString& entry) const
+bool OmArchive::entryClose() const
+{
+  if(this->_stat & ZIP_READER) {
+
+    zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
+
+    if(mz_zip_entry_is_open(zctx->zip_hnd) != MZ_OK)
+      return true;
+
+    // closing entry also verify CRC
+    int32_t mz_err = mz_zip_entry_close(zctx->zip_hnd);
+    if(mz_err != MZ_OK) {
+      zctx->mz_err = mz_err;  zctx->ws_err = L"entry close error";
+      return false;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmArchive::entryCopy(const OmArchive& src, size_t i, const OmWString& dst, Om_progressCb progress_cb, void* user_ptr) const
 {
-  zip_entry_t* zent = static_cast<zip_entry_t*>(this->_zent);
+  int32_t mz_err;
+
+  if((this->_stat & ZIP_WRITER) && (src._stat & ZIP_READER)) {
+
+    zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
+    zip_context_t* src_zctx = static_cast<zip_context_t*>(src._zctx);
+    zip_mirror_t* src_zmir = static_cast<zip_mirror_t*>(src._zent);
+
+    if(i >= src._zent_size) {
+      zctx->mz_err = MZ_PARAM_ERROR;  zctx->ws_err = L"entry index out of range";
+      return false;
+    }
+
+    mz_err = mz_zip_goto_entry(src_zctx->zip_hnd, src_zmir->offset[i]);
+    if(mz_err != MZ_OK) {
+      zctx->mz_err = mz_err;  zctx->ws_err = L"entry goto error";
+      return false;
+    }
+
+    OmCString zcdr_dst;
+    Om_toZipCDR(&zcdr_dst, dst);
+
+    // writer with level 0 always produces STORE entries
+    int32_t out_method = (zctx->cmp_level == 0) ? static_cast<int32_t>(MZ_COMPRESS_METHOD_STORE) : zctx->cmp_method;
+
+    // copy compressed data as is if methods match, recompress otherwise
+    uint8_t raw = (src_zmir->method[i] == out_method) ? 1 : 0;
+
+    const wchar_t* ws_err = nullptr;
+
+    mz_err = __zip_entry_copy(zctx->zip_hnd, src_zctx->zip_hnd, zcdr_dst.c_str(), zctx->cmp_method, zctx->cmp_level, raw,
+                              __zip_ctx_buffer(zctx), progress_cb, user_ptr, reinterpret_cast<uint64_t>(dst.c_str()), &ws_err);
+
+    if(mz_err != MZ_OK) {
+      zctx->mz_err = mz_err;  zctx->ws_err = ws_err;
+      return false;
+    }
 
-  for(size_t i = 0; i < this->_zent_size; ++i) {
-    if(Om_namesMatches(zent[i].file_path, entry))
-      return i;
+    return true;
   }
 
-  return -1;
+  return false;
+}
+
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmArchive::entryAddBatch(const OmWStringArray& src, const OmWStringArray& dst, size_t threads, Om_progressCb progress_cb, Om_progressCb compress_cb, void* user_ptr) const
+{
+  if(this->_stat & ZIP_WRITER) {
+
+    zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
+
+    if(src.size() != dst.size()) {
+      zctx->mz_err = MZ_PARAM_ERROR;  zctx->ws_err = L"batch arrays size mismatch";
+      return false;
+    }
+
+    zip_batch_t zbat;
+    zbat.src = &src;
+    zbat.dst = &dst;
+    zbat.count = src.size();
+    zbat.next = 0;
+    zbat.limit = 0;
+    zbat.cmp_method = zctx->cmp_method;
+    zbat.cmp_level = zctx->cmp_level;
+    zbat.abort = false;
+
+    if(zbat.count == 0)
+      return true;
+
+    zbat.job = static_cast<zip_batch_job_t*>(Om_alloc(zbat.count * sizeof(zip_batch_job_t)));
+    if(!zbat.job) {
+      zctx->mz_err = MZ_MEM_ERROR;  zctx->ws_err = L"batch jobs allocation error";
+      return false;
+    }
+
+    Om_memset(zbat.job, 0, zbat.count * sizeof(zip_batch_job_t));
+
+    // directories and large files are processed by sequencer with
+    // regular streaming method, others are compressed in memory
+    size_t par_cnt = 0;
+
+    WIN32_FILE_ATTRIBUTE_DATA fa;
+
+    for(size_t i = 0; i < zbat.count; ++i) {
+
+      if(!src[i].empty() && GetFileAttributesExW(src[i].c_str(), GetFileExInfoStandard, &fa)) {
+        if(!(fa.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && fa.nFileSizeHigh == 0 && fa.nFileSizeLow <= ZIP_BATCH_MAX_SIZE) {
+          zbat.job[i].size = fa.nFileSizeLow;
+          ++par_cnt; continue;
+        }
+      }
+
+      zbat.job[i].state = ZIP_BATCH_SERL;
+    }
+
+    // define worker threads count according available processors
+    if(threads == 0) {
+      SYSTEM_INFO sys_info;
+      GetSystemInfo(&sys_info);
+      threads = sys_info.dwNumberOfProcessors;
+    }
+
+    if(threads > ZIP_BATCH_MAX_THREADS) threads = ZIP_BATCH_MAX_THREADS;
+    if(threads > par_cnt) threads = par_cnt;
+
+    // in-flight window bounds memory used by compressed entries waiting for sequencer
+    size_t window = threads * 2;
+    zbat.limit = window;
+
+    InitializeCriticalSection(&zbat.lock);
+    InitializeConditionVariable(&zbat.job_cv);
+    InitializeConditionVariable(&zbat.end_cv);
+
+    HANDLE hth[ZIP_BATCH_MAX_THREADS];
+    DWORD hth_cnt = 0;
+
+    for(size_t t = 0; t < threads; ++t) {
+      hth[hth_cnt] = Om_threadCreate(__zip_batch_run_fn, &zbat);
+      if(hth[hth_cnt]) ++hth_cnt;
+    }
+
+    // without worker everything goes through sequencer
+    if(hth_cnt == 0) {
+      for(size_t i = 0; i < zbat.count; ++i)
+        zbat.job[i].state = ZIP_BATCH_SERL;
+    }
+
+    bool has_error = false;
+
+    // sequencer: append entries to zip in order
+    for(size_t i = 0; i < zbat.count; ++i) {
+
+      zip_batch_job_t* job = &zbat.job[i];
+
+      if(job->state == ZIP_BATCH_SERL) {
+
+        bool result;
+
+        // by convention, empty source mean directory entry
+        if(src[i].empty()) {
+          result = this->entryAdd(nullptr, 0, dst[i]);
+        } else {
+          result = this->entryAdd(src[i], dst[i], compress_cb, user_ptr);
+        }
+
+        if(!result) {
+          has_error = true; break;
+        }
+
+      } else {
+
+        EnterCriticalSection(&zbat.lock);
+        while(job->state < ZIP_BATCH_DONE)
+          SleepConditionVariableCS(&zbat.end_cv, &zbat.lock, INFINITE);
+        LeaveCriticalSection(&zbat.lock);
+
+        if(job->state == ZIP_BATCH_FAIL) {
+          zctx->mz_err = job->mz_err; zctx->ws_err = job->ws_err;
+          has_error = true; break;
+        }
+
+        const wchar_t* ws_err = nullptr;
+
+        int32_t mz_err = __zip_entry_copy(zctx->zip_hnd, job->zip_hnd, nullptr, zctx->cmp_method, zctx->cmp_level, 1, __zip_ctx_buffer(zctx), nullptr, nullptr, 0, &ws_err);
+
+        __zip_batch_job_free(job);
+
+        if(mz_err != MZ_OK) {
+          zctx->mz_err = mz_err; zctx->ws_err = ws_err;
+          has_error = true; break;
+        }
+
+        // entry was compressed at once by worker
+        if(compress_cb) {
+          if(!compress_cb(user_ptr, job->size, job->size, reinterpret_cast<uint64_t>(dst[i].c_str()))) {
+            zctx->mz_err = MZ_INTERNAL_ERROR; zctx->ws_err = L"aborted by user";
+            has_error = true; break;
+          }
+        }
+      }
+
+      // slide the in-flight window
+      EnterCriticalSection(&zbat.lock);
+      zbat.limit = i + 1 + window;
+      WakeAllConditionVariable(&zbat.job_cv);
+      LeaveCriticalSection(&zbat.lock);
+
+      if(progress_cb) {
+        if(!progress_cb(user_ptr, zbat.count, i + 1, reinterpret_cast<uint64_t>(dst[i].c_str()))) {
+          zctx->mz_err = MZ_INTERNAL_ERROR; zctx->ws_err = L"aborted by user";
+          has_error = true; break;
+        }
+      }
+    }
+
+    // stop and wait for workers
+    EnterCriticalSection(&zbat.lock);
+    zbat.abort = true;
+    WakeAllConditionVariable(&zbat.job_cv);
+    LeaveCriticalSection(&zbat.lock);
+
+    if(hth_cnt) {
+      WaitForMultipleObjects(hth_cnt, hth, true, INFINITE);
+      for(DWORD t = 0; t < hth_cnt; ++t)
+        CloseHandle(hth[t]);
+    }
+
+    // release compressed entries left by abort or error
+    for(size_t i = 0; i < zbat.count; ++i)
+      __zip_batch_job_free(&zbat.job[i]);
+
+    Om_free(zbat.job);
+
+    DeleteCriticalSection(&zbat.lock);
+
+    return !has_error;
+  }
+
+  return false;
+}
+
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+uint32_t OmArchive::entryLocate(const OmWString& entry) const
+{
+  return __zip_mirror_find(static_cast<zip_mirror_t*>(this->_zent), entry);
 }
 
 
@@ -949,8 +2445,9 @@ bool OmArchive::close()
   int32_t mz_err = MZ_OK;
 
   if(this->_zent) {
-    Om_free(this->_zent);
+    __zip_mirror_free(static_cast<zip_mirror_t*>(this->_zent));
     this->_zent = nullptr;
+    this->_zent_size = 0;
   }
 
   zip_context_t* zctx = static_cast<zip_context_t*>(this->_zctx);
@@ -974,6 +2471,11 @@ bool OmArchive::close()
 
     if(zctx->strm_file)
       mz_stream_os_delete(&zctx->strm_file);
+
+    if(zctx->strm_mmem)
+      mz_stream_mem_delete(&zctx->strm_mmem);
+
+    __zip_map_close(zctx);
   }
 
   if(this->_stat & ZIP_WRITER) {
@@ -1002,6 +2504,10 @@ bool OmArchive::close()
 
   this->_stat = 0;
 
+  // give back I/O buffer for reuse
+  __zip_buf_release(zctx->buffer);
+  zctx->buffer = nullptr;
+
   if(mz_err != MZ_OK) {
     zctx->mz_err = mz_err; zctx->ws_err = L"zip close error";
     return false;
@@ -1011,6 +2517,15 @@ bool OmArchive::close()
 }
 
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmArchive::bufferStats(uint64_t* requests, uint64_t* allocs)
+{
+  if(requests) *requests = InterlockedCompareExchange64(&__zip_buf_reqs, 0, 0);
+  if(allocs) *allocs = InterlockedCompareExchange64(&__zip_buf_alloc, 0, 0);
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
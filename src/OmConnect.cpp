@@ -15,6 +15,8 @@
   along with Open Mod Manager. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "OmUtilStr.h"
+#include "OmUtilAlg.h"
+#include "OmUtilHsh.h"
 
 #include <curl/curl.h>
 
@@ -35,26 +37,93 @@
 ///
 #define OM_REQ_MIN_LIMIT_RATE        1024
 
+/// \brief Maximum simultaneous transfers
+///
+/// Default maximum count of transfers the shared transfer engine performs
+/// simultaneously.
+///
+#define OM_XFER_DEFAULT_SLOTS        16
+
+/// \brief Transfer engine data
+///
+/// Process-wide transfer engine, a single thread driving every transfer
+/// through one CURL multi handle. Ended transfers with callbacks are
+/// completed by a separate thread so event loop only performs I/O.
+///
+typedef struct xfer_engine_ {
+  CRITICAL_SECTION          lock;       //< Queues access lock
+  CURLM*                    hmult;      //< Shared multi handle
+  void*                     hth;        //< Event loop thread handle
+  DWORD                     tid;        //< Event loop thread id
+  void*                     hcth;       //< Completion thread handle
+  DWORD                     cid;        //< Completion thread id
+  void*                     hev;        //< Completion thread wake up event
+  uint32_t                  slots;      //< Maximum simultaneous transfers
+  std::vector<OmConnect*>   queue;      //< Pending transfers, by priority
+  std::vector<OmConnect*>   active;     //< Running transfers
+  std::vector<OmConnect*>   done;       //< Ended transfers to complete
+  OmConnect*                current;    //< Transfer being completed
+  OmConnect*                signal;     //< Blocking transfer being signaled
+} xfer_engine_t;
+
+/// \brief Transfer engine
+///
+/// Shared transfer engine instance
+///
+static xfer_engine_t __xfer;
+
 /// \brief Initialized libCURL flag
 ///
-/// Flag to tell whether libCURL must be initialized
+/// Flag to tell whether libCURL must be initialized, 1 while initializing
+/// and 2 once initialized.
 ///
-static bool __curl_initialized = false;
+static volatile LONG __curl_initialized = 0;
 
 
 /// \brief Initialize libCURL
 ///
-/// Function to initialize libCURL once
+/// Function to initialize libCURL and transfer engine once
 ///
 static inline void __curl_init()
 {
-  if(!__curl_initialized) {
+  if(InterlockedCompareExchange(&__curl_initialized, 1, 0) == 0) {
 
     curl_global_init(CURL_GLOBAL_ALL);
 
+    InitializeCriticalSection(&__xfer.lock);
+    __xfer.hmult = curl_multi_init();
+    __xfer.hth = nullptr;
+    __xfer.tid = 0;
+    __xfer.hcth = nullptr;
+    __xfer.cid = 0;
+    __xfer.hev = CreateEventW(nullptr, false, false, nullptr);
+    __xfer.slots = OM_XFER_DEFAULT_SLOTS;
+    __xfer.current = nullptr;
+    __xfer.signal = nullptr;
+
     // we need to initialize only once per process
-    __curl_initialized = true;
+    InterlockedExchange(&__curl_initialized, 2);
   }
+
+  // another thread may be initializing
+  while(InterlockedCompareExchange(&__curl_initialized, 2, 2) != 2)
+    Sleep(0);
+}
+
+/// \brief Wait for transfer engine
+///
+/// Function to wait a short time for transfer engine, messages sent by other
+/// threads are processed meanwhile since transfer callbacks may send
+/// messages to the waiting UI thread, which otherwise would wait for each
+/// other.
+///
+static inline void __xfer_wait()
+{
+  MsgWaitForMultipleObjects(0, nullptr, false, 5, QS_SENDMESSAGE);
+
+  // only dispatches sent messages, posted ones are left in queue
+  MSG msg;
+  PeekMessageW(&msg, nullptr, 0, 0, PM_NOREMOVE|PM_QS_SENDMESSAGE);
 }
 
 ///
@@ -62,7 +131,6 @@ static inline void __curl_init()
 ///
 OmConnect::OmConnect() :
   _heasy(nullptr),
-  _hmult(nullptr),
   _req_result(0),
   _req_response(0),
   _req_user_ptr(nullptr),
@@ -70,20 +138,24 @@ OmConnect::OmConnect() :
   _req_result_cb(nullptr),
   _req_download_cb(nullptr),
   _req_abort(false),
+  _req_detach(false),
+  _req_priority(OM_CONNECT_PRIO_DOWNLOAD),
+  _req_headers(nullptr),
   _req_max_rate(0),
   _get_data_buf(nullptr),
   _get_data_len(0),
   _get_data_cap(0),
   _get_file_hnd(nullptr),
   _get_file_own(false),
+  _get_hash_st(nullptr),
   _rate_accu(0),
   _rate_time(0.0),
   _progress_off(0L),
   _progress_tot(0L),
   _progress_now(0L),
   _progress_bps(0.0),
-  _perform_hth(nullptr),
-  _perform_hwo(nullptr)
+  _perform_run(false),
+  _perform_hev(nullptr)
 {
 
 }
@@ -93,8 +165,7 @@ OmConnect::OmConnect() :
 ///
 OmConnect::~OmConnect()
 {
-  this->abortRequest();
-  this->clear();
+  this->cancelRequest();
 }
 
 ///
@@ -102,22 +173,11 @@ OmConnect::~OmConnect()
 ///
 void OmConnect::clear()
 {
-  Om_threadClear(this->_perform_hth, this->_perform_hwo);
-  this->_perform_hth = nullptr;
-  this->_perform_hwo = nullptr;
-
   if(this->_heasy) {
-    if(this->_hmult)
-      curl_multi_remove_handle(reinterpret_cast<CURLM*>(this->_hmult), this->_heasy);
     curl_easy_cleanup(reinterpret_cast<CURL*>(this->_heasy));
     this->_heasy = nullptr;
   }
 
-  if(this->_hmult) {
-    curl_multi_cleanup(reinterpret_cast<CURLM*>(this->_hmult));
-    this->_hmult = nullptr;
-  }
-
   this->_req_url.clear();
 
   this->_req_result = 0;
@@ -127,8 +187,17 @@ void OmConnect::clear()
   this->_req_result_cb = nullptr;
   this->_req_download_cb = nullptr;
   this->_req_abort = false;
+  this->_req_detach = false;
   this->_req_max_rate = 0;
 
+  if(this->_req_headers) {
+    curl_slist_free_all(reinterpret_cast<curl_slist*>(this->_req_headers));
+    this->_req_headers = nullptr;
+  }
+
+  this->_resp_etag.clear();
+  this->_resp_modified.clear();
+
   if(this->_get_data_buf) {
     Om_free(this->_get_data_buf);
     this->_get_data_buf = nullptr;
@@ -136,6 +205,10 @@ void OmConnect::clear()
   this->_get_data_len = 0;
   this->_get_data_cap = 0;
 
+  // close file handle if instance created it
+  if(this->_get_file_own && this->_get_file_hnd)
+    CloseHandle(this->_get_file_hnd);
+
   this->_get_file_hnd = nullptr;
   this->_get_file_own = false;
 
@@ -146,6 +219,17 @@ void OmConnect::clear()
   this->_progress_tot = 0L;
   this->_progress_now = 0L;
   this->_progress_bps = 0.0;
+
+  this->_perform_run = false;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmConnect::setValidators(const OmWString& etag, const OmWString& modified)
+{
+  Om_toUTF8(&this->_req_etag, etag);
+  Om_toUTF8(&this->_req_modified, modified);
 }
 
 ///
@@ -153,15 +237,16 @@ void OmConnect::clear()
 ///
 OmResult OmConnect::requestHttpGet(const OmWString& url, OmCString* reponse, uint32_t rate)
 {
+  if(this->_perform_run)
+    return OM_RESULT_ERROR;
+
   __curl_init();
 
   this->clear();
 
   this->_heasy = curl_easy_init();
-  this->_hmult = curl_multi_init();
 
   CURL* curl_easy = reinterpret_cast<CURL*>(this->_heasy);
-  CURLM* curl_mult = reinterpret_cast<CURLM*>(this->_hmult);
 
   this->_req_url.clear();
   Om_urlEscape(&this->_req_url, url);
@@ -176,104 +261,34 @@ OmResult OmConnect::requestHttpGet(const OmWString& url, OmCString* reponse, uin
 
   curl_easy_setopt(curl_easy, CURLOPT_NOPROGRESS, 1L);
 
-  // follow HTTP redirections
-  curl_easy_setopt(curl_easy, CURLOPT_FOLLOWLOCATION, 1L);
-
-  // we use a self-signed test server, skip verification during debugging
-  curl_easy_setopt(curl_easy, CURLOPT_SSL_VERIFYPEER, 0L);
-  curl_easy_setopt(curl_easy, CURLOPT_SSL_VERIFYHOST, 0L);
-  curl_easy_setopt(curl_easy, CURLOPT_FAILONERROR, 1L);
-
   // download rate limit
   this->_req_max_rate = rate;
 
-  int64_t buff_size = OM_REQ_DEFAULT_BUFFSIZE;
-
-  if(this->_req_max_rate > 0) {
-
-    if(this->_req_max_rate < OM_REQ_MIN_LIMIT_RATE) //< prevent stupid limit
-      this->_req_max_rate = OM_REQ_MIN_LIMIT_RATE;
-
-    // set download rate limit
-    curl_easy_setopt(curl_easy, CURLOPT_MAX_RECV_SPEED_LARGE, this->_req_max_rate);
-    curl_easy_setopt(curl_easy, CURLOPT_MAX_SEND_SPEED_LARGE, this->_req_max_rate);
+  this->_perform_setup();
 
-    // adjust buffer size if needed
-    if((this->_req_max_rate / 4) < OM_REQ_DEFAULT_BUFFSIZE)
-      buff_size = this->_req_max_rate / 4;
+  // event to be signaled by transfer engine once transfer ended
+  this->_perform_hev = CreateEventW(nullptr, true, false, nullptr);
 
+  if(!this->_perform_hev || !OmConnect::_xfer_submit(this)) {
+    if(this->_perform_hev) CloseHandle(this->_perform_hev);
+    this->_perform_hev = nullptr;
+    this->_perform_run = false;
+    return OM_RESULT_ERROR;
   }
 
-  // Set proper buffer size to optimize write/download rate
-  curl_easy_setopt(curl_easy, CURLOPT_BUFFERSIZE, buff_size);
-  curl_easy_setopt(curl_easy, CURLOPT_UPLOAD_BUFFERSIZE, buff_size);
-
-  curl_multi_add_handle(curl_mult, curl_easy);
-
-  // artificially set peforming thread handle
-  this->_perform_hth = reinterpret_cast<void*>(0x1);
+  WaitForSingleObject(this->_perform_hev, INFINITE);
 
-  // number of running handles
-  int32_t running_count = 1;
-
-  while(running_count) {
-
-    CURLMcode curlm_code = curl_multi_perform(curl_mult, &running_count);
-
-    if(curlm_code == CURLM_OK && !this->_req_abort) { // wait for activity or timeout
-      curlm_code = curl_multi_poll(curl_mult, nullptr, 0, 100, nullptr);
-    }
-
-    if(curlm_code != CURLM_OK || this->_req_abort)
-      break;
-  }
-
-  CURLMsg* curl_msg;
-  int msgs_left;
-
-  // get result message
-  while((curl_msg = curl_multi_info_read(curl_mult, &msgs_left))) {
-    if(curl_msg->msg == CURLMSG_DONE) {
-      // get transfer result code
-      this->_req_result = curl_msg->data.result;
-      // get HTTP response code
-      curl_easy_getinfo(curl_msg->easy_handle, CURLINFO_RESPONSE_CODE, &this->_req_response);
-    }
-  }
-
-  curl_multi_remove_handle(curl_mult, curl_easy);
+  CloseHandle(this->_perform_hev);
+  this->_perform_hev = nullptr;
 
   #ifdef DEBUG
   std::cout << "\n";
   std::cout << "DEBUG => OmConnect::requestHttpGet : _req_result=" << std::to_string(this->_req_result) << " (" << curl_easy_strerror((CURLcode)this->_req_result) << ")\n";
   #endif // DEBUG
 
-  if(this->_req_result != CURLE_OK) {
-
-    Om_free(this->_get_data_buf);
-    this->_get_data_buf = nullptr;
-
-    this->_get_data_len = 0;
-    this->_get_data_cap = 0;
-
-  } else {
-
-    // in the extremely improbable case capacity is not
-    //  enough to add null char we reallocate buffer
-    if(this->_get_data_len + 1 > this->_get_data_cap) {
-      this->_get_data_cap++;
-      this->_get_data_buf = static_cast<uint8_t*>(Om_realloc(this->_get_data_buf, this->_get_data_cap));
-    }
-
-    // add null-char or die
-    if(this->_get_data_buf) {
-      this->_get_data_buf[this->_get_data_len] = '\0';
-      *reponse = reinterpret_cast<char*>(this->_get_data_buf);
-    } else {
-      this->_get_data_len = 0;
-      this->_get_data_cap = 0;
-    }
-  }
+  // received data is already null terminated
+  if(this->_get_data_buf)
+    *reponse = reinterpret_cast<char*>(this->_get_data_buf);
 
   OmResult result;
 
@@ -283,8 +298,8 @@ OmResult OmConnect::requestHttpGet(const OmWString& url, OmCString* reponse, uin
     result = (this->_req_result == CURLE_OK) ? OM_RESULT_OK : OM_RESULT_ERROR;
   }
 
-  // reset performing thread handle
-  this->_perform_hth = nullptr;
+  // reset performing status
+  this->_perform_run = false;
 
   return result;
 }
@@ -294,7 +309,7 @@ OmResult OmConnect::requestHttpGet(const OmWString& url, OmCString* reponse, uin
 ///
 bool OmConnect::requestHttpGet(const OmWString& url, Om_responseCb response_cb, void* user_ptr, uint32_t rate)
 {
-  if(this->_perform_hth)
+  if(this->_perform_run)
     return false;
 
   __curl_init();
@@ -302,7 +317,6 @@ bool OmConnect::requestHttpGet(const OmWString& url, Om_responseCb response_cb,
   this->clear();
 
   this->_heasy = curl_easy_init();
-  this->_hmult = curl_multi_init();
 
   CURL* curl_easy = reinterpret_cast<CURL*>(this->_heasy);
 
@@ -327,13 +341,10 @@ bool OmConnect::requestHttpGet(const OmWString& url, Om_responseCb response_cb,
 
   this->_req_abort = false;
 
-  // launch new download thread
-  this->_perform_hth = Om_threadCreate(OmConnect::_perform_run_fn, this);
-
-  // register wait object to track thread end
-  this->_perform_hwo = Om_threadWaitEnd(this->_perform_hth, OmConnect::_perform_end_fn, this);
+  this->_perform_setup();
 
-  return true;
+  // hand request to transfer engine
+  return OmConnect::_xfer_submit(this);
 }
 
 ///
@@ -341,7 +352,7 @@ bool OmConnect::requestHttpGet(const OmWString& url, Om_responseCb response_cb,
 ///
 bool OmConnect::requestHttpGet(const OmWString& url, const OmWString& path, bool resume, Om_resultCb result_cb, Om_downloadCb download_cb, void* user_ptr, uint32_t rate)
 {
-  if(this->_perform_hth)
+  if(this->_perform_run)
     return false;
 
   __curl_init();
@@ -370,7 +381,6 @@ bool OmConnect::requestHttpGet(const OmWString& url, const OmWString& path, bool
   int64_t resume_off = FileSize.QuadPart;
 
   this->_heasy = curl_easy_init();
-  this->_hmult = curl_multi_init();
 
   CURL* curl_easy = reinterpret_cast<CURL*>(this->_heasy);
 
@@ -419,12 +429,10 @@ bool OmConnect::requestHttpGet(const OmWString& url, const OmWString& path, bool
 
   this->_req_abort = false;
 
-  // launch new download thread
-  this->_perform_hth = Om_threadCreate(OmConnect::_perform_run_fn, this);
-  // register wait object to track thread end
-  this->_perform_hwo = Om_threadWaitEnd(this->_perform_hth, OmConnect::_perform_end_fn, this);
+  this->_perform_setup();
 
-  return true;
+  // hand request to transfer engine
+  return OmConnect::_xfer_submit(this);
 }
 
 ///
@@ -432,7 +440,7 @@ bool OmConnect::requestHttpGet(const OmWString& url, const OmWString& path, bool
 ///
 bool OmConnect::requestHttpGet(const OmWString& url, void* hfile, bool resume, Om_resultCb result_cb, Om_downloadCb download_cb, void* user_ptr, uint32_t rate)
 {
-  if(this->_perform_hth)
+  if(this->_perform_run)
     return false;
 
   __curl_init();
@@ -457,7 +465,6 @@ bool OmConnect::requestHttpGet(const OmWString& url, void* hfile, bool resume, O
   }
 
   this->_heasy = curl_easy_init();
-  this->_hmult = curl_multi_init();
 
   CURL* curl_easy = reinterpret_cast<CURL*>(this->_heasy);
 
@@ -506,12 +513,10 @@ bool OmConnect::requestHttpGet(const OmWString& url, void* hfile, bool resume, O
 
   this->_req_abort = false;
 
-  // launch new download thread
-  this->_perform_hth = Om_threadCreate(OmConnect::_perform_run_fn, this);
-  // register wait object to track thread end
-  this->_perform_hwo = Om_threadWaitEnd(this->_perform_hth, OmConnect::_perform_end_fn, this);
+  this->_perform_setup();
 
-  return true;
+  // hand request to transfer engine
+  return OmConnect::_xfer_submit(this);
 }
 
 ///
@@ -519,40 +524,62 @@ bool OmConnect::requestHttpGet(const OmWString& url, void* hfile, bool resume, O
 ///
 void OmConnect::abortRequest()
 {
-  if(this->_perform_hth) {
-
-    CURLM* curl_mult = reinterpret_cast<CURLM*>(this->_hmult);
+  if(this->_perform_run) {
 
     // set abort signal
     this->_req_abort = true;
 
-    // wake up curl_multi_poll to exit loop as soon as possible
-    curl_multi_wakeup(curl_mult);
+    // wake up transfer engine to drop request as soon as possible
+    curl_multi_wakeup(__xfer.hmult);
   }
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-bool OmConnect::isPerforming() const
+void OmConnect::cancelRequest()
 {
-  return (this->_perform_hth != nullptr);
+  // make sure transfer engine released this instance
+  OmConnect::_xfer_detach(this);
+
+  this->clear();
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmConnect::isPerforming() const
+{
+  return this->_perform_run;
+}
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-DWORD WINAPI OmConnect::_perform_run_fn(void* ptr)
+void OmConnect::_perform_setup()
 {
-  #ifdef DEBUG
-  std::cout << "DEBUG => OmConnect::_perform_run_fn : enter\n";
-  #endif // DEBUG
+  CURL* curl_easy = reinterpret_cast<CURL*>(this->_heasy);
 
-  OmConnect* self = static_cast<OmConnect*>(ptr);
+  // to retrieve instance from transfer engine
+  curl_easy_setopt(curl_easy, CURLOPT_PRIVATE, this);
+
+  // to get cache validators of response
+  curl_easy_setopt(curl_easy, CURLOPT_HEADERFUNCTION, OmConnect::_perform_header_fn);
+  curl_easy_setopt(curl_easy, CURLOPT_HEADERDATA, this);
 
-  CURL* curl_easy = reinterpret_cast<CURL*>(self->_heasy);
-  CURLM* curl_mult = reinterpret_cast<CURLM*>(self->_hmult);
+  // conditional request, server responds 304 if resource is unchanged
+  curl_slist* headers = nullptr;
+
+  if(!this->_req_etag.empty())
+    headers = curl_slist_append(headers, ("If-None-Match: " + this->_req_etag).c_str());
+
+  if(!this->_req_modified.empty())
+    headers = curl_slist_append(headers, ("If-Modified-Since: " + this->_req_modified).c_str());
+
+  if(headers) {
+    curl_easy_setopt(curl_easy, CURLOPT_HTTPHEADER, headers);
+    this->_req_headers = headers;
+  }
 
   // follow HTTP redirections
   curl_easy_setopt(curl_easy, CURLOPT_FOLLOWLOCATION, 1L);
@@ -564,143 +591,356 @@ DWORD WINAPI OmConnect::_perform_run_fn(void* ptr)
 
   int64_t buff_size = OM_REQ_DEFAULT_BUFFSIZE;
 
-  if(self->_req_max_rate > 0) {
+  if(this->_req_max_rate > 0) {
 
     // prevent stupid limit
-    if(self->_req_max_rate < OM_REQ_MIN_LIMIT_RATE)
-      self->_req_max_rate = OM_REQ_MIN_LIMIT_RATE;
+    if(this->_req_max_rate < OM_REQ_MIN_LIMIT_RATE)
+      this->_req_max_rate = OM_REQ_MIN_LIMIT_RATE;
 
     // set download rate limit
-    curl_easy_setopt(curl_easy, CURLOPT_MAX_RECV_SPEED_LARGE, self->_req_max_rate);
-    curl_easy_setopt(curl_easy, CURLOPT_MAX_SEND_SPEED_LARGE, self->_req_max_rate);
+    curl_easy_setopt(curl_easy, CURLOPT_MAX_RECV_SPEED_LARGE, this->_req_max_rate);
+    curl_easy_setopt(curl_easy, CURLOPT_MAX_SEND_SPEED_LARGE, this->_req_max_rate);
 
     // adjust buffer size if needed
-    if((self->_req_max_rate / 4) < OM_REQ_DEFAULT_BUFFSIZE)
-      buff_size = self->_req_max_rate / 4;
+    if((this->_req_max_rate / 4) < OM_REQ_DEFAULT_BUFFSIZE)
+      buff_size = this->_req_max_rate / 4;
   }
 
   // Set proper buffer size to optimize write/download rate
   curl_easy_setopt(curl_easy, CURLOPT_BUFFERSIZE, buff_size);
   curl_easy_setopt(curl_easy, CURLOPT_UPLOAD_BUFFERSIZE, buff_size);
+}
 
-  curl_multi_add_handle(curl_mult, curl_easy);
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmConnect::_perform_done()
+{
+  #ifdef DEBUG
+  std::cout << "DEBUG => OmConnect::_perform_done : _req_result=" << std::to_string(this->_req_result) << " (" << curl_easy_strerror((CURLcode)this->_req_result) << ")\n";
+  #endif // DEBUG
 
-  // number of running handles
-  int32_t running_count = 1;
+  // close file handle if instance created it
+  if(this->_get_file_own && this->_get_file_hnd) {
+    CloseHandle(this->_get_file_hnd);
+    this->_get_file_hnd = nullptr;
+  }
 
-  while(running_count) {
+  if(this->_get_data_buf) {
 
-    CURLMcode curlm_code = curl_multi_perform(curl_mult, &running_count);
+    if(this->_req_result != CURLE_OK) {
+
+      Om_free(this->_get_data_buf);
+      this->_get_data_buf = nullptr;
+
+      this->_get_data_len = 0;
+      this->_get_data_cap = 0;
+
+    } else {
+
+      // in the extremely improbable case capacity is not
+      //  enough to add null char we reallocate buffer
+      if(this->_get_data_len + 1 > this->_get_data_cap) {
+        this->_get_data_cap++;
+        this->_get_data_buf = static_cast<uint8_t*>(Om_realloc(this->_get_data_buf, this->_get_data_cap));
+      }
+
+      // add null-char or die
+      if(this->_get_data_buf) {
+        this->_get_data_buf[this->_get_data_len] = '\0';
+      } else {
+        this->_get_data_len = 0;
+        this->_get_data_cap = 0;
+      }
 
-    if(curlm_code == CURLM_OK && !self->_req_abort) { // wait for activity or timeout
-      curlm_code = curl_multi_poll(curl_mult, nullptr, 0, 500, nullptr);
     }
+  }
 
-    if(curlm_code != CURLM_OK || self->_req_abort)
-      break;
+  // blocking request, the caller does the rest
+  if(this->_perform_hev) {
+    SetEvent(this->_perform_hev);
+    return;
   }
 
-  CURLMsg* curl_msg;
-  int msgs_left;
+  this->_perform_run = false;
 
-  // get result message
-  while((curl_msg = curl_multi_info_read(curl_mult, &msgs_left))) {
-    if(curl_msg->msg == CURLMSG_DONE) {
-      // get transfer result code
-      self->_req_result = curl_msg->data.result;
-      // get HTTP response code
-      curl_easy_getinfo(curl_msg->easy_handle, CURLINFO_RESPONSE_CODE, &self->_req_response);
+  // instance is being destroyed, nobody to call back
+  if(this->_req_detach)
+    return;
+
+  if(this->_req_result_cb) {
+
+    OmResult result;
+
+    if(this->_req_abort) {
+      result = OM_RESULT_ABORT;
+    } else {
+      result = (this->_req_result == CURLE_OK) ? OM_RESULT_OK : OM_RESULT_ERROR;
     }
+
+    this->_req_result_cb(this->_req_user_ptr, result, this->_req_response);
   }
 
-  curl_multi_remove_handle(curl_mult, curl_easy);
+  if(this->_req_response_cb)
+    this->_req_response_cb(this->_req_user_ptr, this->_get_data_buf, this->_get_data_len, this->_req_response);
 
-  #ifdef DEBUG
-  std::cout << "\n";
-  std::cout << "DEBUG => OmConnect::_perform_run_fn : _req_result=" << std::to_string(self->_req_result) << " (" << curl_easy_strerror((CURLcode)self->_req_result) << ")\n";
-  #endif // DEBUG
+  // clear instance
+  this->clear();
+}
 
-  DWORD resultCode = 0;
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmConnect::_xfer_submit(OmConnect* conn)
+{
+  EnterCriticalSection(&__xfer.lock);
+
+  // launch event loop and completion threads with the first request
+  if(!__xfer.hcth) {
+    __xfer.hcth = Om_threadCreate(OmConnect::_xfer_done_fn, nullptr);
+    if(!__xfer.hcth) {
+      LeaveCriticalSection(&__xfer.lock);
+      return false;
+    }
+  }
+
+  if(!__xfer.hth) {
+    __xfer.hth = Om_threadCreate(OmConnect::_xfer_run_fn, nullptr);
+    if(!__xfer.hth) {
+      LeaveCriticalSection(&__xfer.lock);
+      return false;
+    }
+  }
+
+  conn->_perform_run = true;
+
+  // insert after requests of same or higher priority
+  size_t i = 0;
+  while(i < __xfer.queue.size() && __xfer.queue[i]->_req_priority >= conn->_req_priority)
+    ++i;
+
+  __xfer.queue.insert(__xfer.queue.begin() + i, conn);
+
+  LeaveCriticalSection(&__xfer.lock);
+
+  // wake up event loop to start request
+  curl_multi_wakeup(__xfer.hmult);
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmConnect::_xfer_detach(OmConnect* conn)
+{
+  if(InterlockedCompareExchange(&__curl_initialized, 2, 2) != 2)
+    return;
+
+  EnterCriticalSection(&__xfer.lock);
+
+  // no callback must be called anymore
+  conn->_req_detach = true;
+  conn->_req_abort = true;
+
+  // not started yet, simply forget it
+  Om_eraseValue(__xfer.queue, conn);
+
+  if(GetCurrentThreadId() == __xfer.tid) {
+
+    // called from within a transfer callback, we own the multi handle
+    if(Om_arrayContain(__xfer.active, conn)) {
+      curl_multi_remove_handle(__xfer.hmult, conn->_heasy);
+      Om_eraseValue(__xfer.active, conn);
+    }
+
+    Om_eraseValue(__xfer.done, conn);
+
+  } else {
+
+    // called from within a result callback, we own the ended transfers
+    bool is_completer = (GetCurrentThreadId() == __xfer.cid);
+
+    if(is_completer) Om_eraseValue(__xfer.done, conn);
+
+    // wait for event loop and completion thread to release this instance,
+    // they may be calling a callback that sends message to this thread
+    while(Om_arrayContain(__xfer.active, conn) || Om_arrayContain(__xfer.done, conn) ||
+          (__xfer.current == conn && !is_completer) || __xfer.signal == conn) {
+      LeaveCriticalSection(&__xfer.lock);
+      curl_multi_wakeup(__xfer.hmult);
+      __xfer_wait();
+      EnterCriticalSection(&__xfer.lock);
+      if(is_completer) Om_eraseValue(__xfer.done, conn);
+    }
+  }
+
+  conn->_perform_run = false;
+
+  LeaveCriticalSection(&__xfer.lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+DWORD WINAPI OmConnect::_xfer_run_fn(void* ptr)
+{
+  OM_UNUSED(ptr);
 
-  // close file handle if instance created it
-  if(self->_get_file_own && self->_get_file_hnd) {
-    CloseHandle(self->_get_file_hnd);
-    self->_get_file_hnd = nullptr;
-  }
+  #ifdef DEBUG
+  std::cout << "DEBUG => OmConnect::_xfer_run_fn : enter\n";
+  #endif // DEBUG
 
-  if(self->_get_data_buf) {
+  __xfer.tid = GetCurrentThreadId();
 
-    if(self->_req_result != CURLE_OK) {
+  CURLM* curl_mult = __xfer.hmult;
 
-      Om_free(self->_get_data_buf);
-      self->_get_data_buf = nullptr;
+  // number of running handles
+  int32_t running_count = 0;
 
-      self->_get_data_len = 0;
-      self->_get_data_cap = 0;
+  CURLMsg* curl_msg;
+  int msgs_left;
 
-    } else {
+  while(true) {
 
-      // in the extremely improbable case capacity is not
-      //  enough to add null char we reallocate buffer
-      if(self->_get_data_len + 1 > self->_get_data_cap) {
-        self->_get_data_cap++;
-        self->_get_data_buf = static_cast<uint8_t*>(Om_realloc(self->_get_data_buf, self->_get_data_cap));
+    EnterCriticalSection(&__xfer.lock);
+
+    // drop aborted requests which did not start yet
+    for(size_t i = 0; i < __xfer.queue.size(); ) {
+      if(__xfer.queue[i]->_req_abort) {
+        __xfer.done.push_back(__xfer.queue[i]);
+        __xfer.queue.erase(__xfer.queue.begin() + i);
+      } else {
+        ++i;
       }
+    }
 
-      // add null-char or die
-      if(self->_get_data_buf) {
-        self->_get_data_buf[self->_get_data_len] = '\0';
+    // remove aborted transfers
+    for(size_t i = 0; i < __xfer.active.size(); ) {
+      if(__xfer.active[i]->_req_abort) {
+        curl_multi_remove_handle(curl_mult, __xfer.active[i]->_heasy);
+        __xfer.done.push_back(__xfer.active[i]);
+        __xfer.active.erase(__xfer.active.begin() + i);
       } else {
-        self->_get_data_len = 0;
-        self->_get_data_cap = 0;
+        ++i;
       }
+    }
+
+    // start queued requests as soon as a slot is available
+    while(__xfer.queue.size()) {
+
+      if(__xfer.slots > 0 && __xfer.active.size() >= __xfer.slots)
+        break;
 
+      OmConnect* conn = __xfer.queue.front();
+      __xfer.queue.erase(__xfer.queue.begin());
+
+      curl_multi_add_handle(curl_mult, conn->_heasy);
+      __xfer.active.push_back(conn);
     }
-  }
 
-  #ifdef DEBUG
-  std::cout << "DEBUG => OmConnect::_perform_run_fn : leave\n";
-  #endif // DEBUG
+    LeaveCriticalSection(&__xfer.lock);
+
+    CURLMcode curlm_code = curl_multi_perform(curl_mult, &running_count);
 
-  return resultCode;
+    // collect ended transfers
+    while((curl_msg = curl_multi_info_read(curl_mult, &msgs_left))) {
+
+      if(curl_msg->msg != CURLMSG_DONE)
+        continue;
+
+      CURL* curl_easy = curl_msg->easy_handle;
+
+      char* priv = nullptr;
+      curl_easy_getinfo(curl_easy, CURLINFO_PRIVATE, &priv);
+      OmConnect* conn = reinterpret_cast<OmConnect*>(priv);
+
+      // get transfer result code
+      conn->_req_result = curl_msg->data.result;
+      // get HTTP response code
+      curl_easy_getinfo(curl_easy, CURLINFO_RESPONSE_CODE, &conn->_req_response);
+
+      curl_multi_remove_handle(curl_mult, curl_easy);
+
+      EnterCriticalSection(&__xfer.lock);
+      Om_eraseValue(__xfer.active, conn);
+      __xfer.done.push_back(conn);
+      LeaveCriticalSection(&__xfer.lock);
+    }
+
+    // blocking requests only signal their caller and are completed here,
+    // others are handed to completion thread so their callbacks never hold
+    // other transfers
+    EnterCriticalSection(&__xfer.lock);
+
+    for(size_t i = 0; i < __xfer.done.size(); ) {
+
+      if(!__xfer.done[i]->_perform_hev) {
+        ++i; continue;
+      }
+
+      __xfer.signal = __xfer.done[i];
+      __xfer.done.erase(__xfer.done.begin() + i);
+
+      LeaveCriticalSection(&__xfer.lock);
+
+      __xfer.signal->_perform_done();
+
+      EnterCriticalSection(&__xfer.lock);
+
+      __xfer.signal = nullptr;
+    }
+
+    if(__xfer.done.size())
+      SetEvent(__xfer.hev);
+
+    bool pending = (__xfer.queue.size() && (__xfer.slots == 0 || __xfer.active.size() < __xfer.slots));
+
+    LeaveCriticalSection(&__xfer.lock);
+
+    // wait for activity, wake up or timeout, unless slots were freed
+    if(curlm_code == CURLM_OK && !pending)
+      curl_multi_poll(curl_mult, nullptr, 0, 1000, nullptr);
+  }
+
+  return 0;
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-VOID CALLBACK OmConnect::_perform_end_fn(void* ptr, uint8_t timer)
-{
-  OM_UNUSED(timer);
+DWORD WINAPI OmConnect::_xfer_done_fn(void* ptr)
+{
+  OM_UNUSED(ptr);
 
-  #ifdef DEBUG
-  std::cout << "DEBUG => OmConnect::_perform_end : enter\n";
-  #endif // DEBUG
+  __xfer.cid = GetCurrentThreadId();
 
-  OmConnect* self = static_cast<OmConnect*>(ptr);
+  while(true) {
 
-  // free and reset all thread data
-  Om_threadClear(self->_perform_hth, self->_perform_hwo);
-  self->_perform_hth = nullptr;
-  self->_perform_hwo = nullptr;
+    WaitForSingleObject(__xfer.hev, INFINITE);
 
-  if(self->_req_result_cb) {
+    // complete ended transfers, callbacks are called without lock so
+    // they can submit new requests
+    EnterCriticalSection(&__xfer.lock);
 
-    OmResult result;
+    while(__xfer.done.size()) {
 
-    if(self->_req_abort) {
-      result = OM_RESULT_ABORT;
-    } else {
-      result = (self->_req_result == CURLE_OK) ? OM_RESULT_OK : OM_RESULT_ERROR;
+      __xfer.current = __xfer.done.front();
+      __xfer.done.erase(__xfer.done.begin());
+
+      LeaveCriticalSection(&__xfer.lock);
+
+      __xfer.current->_perform_done();
+
+      EnterCriticalSection(&__xfer.lock);
+
+      __xfer.current = nullptr;
     }
 
-    self->_req_result_cb(self->_req_user_ptr, result, self->_req_response);
+    LeaveCriticalSection(&__xfer.lock);
   }
 
-  if(self->_req_response_cb)
-    self->_req_response_cb(self->_req_user_ptr, self->_get_data_buf, self->_get_data_len, self->_req_response);
-
-  // clear instance
-  self->clear();
+  return 0;
 }
 
 ///
@@ -765,6 +1005,10 @@ size_t OmConnect::_perform_write_fio_fn(char *recv_data, size_t recv_s, size_t r
                                   &dwBytesWritten,
                                   nullptr);
 
+  // update checksum with data actually written
+  if(self->_get_hash_st)
+    Om_hashStateUpdate(self->_get_hash_st, recv_data, dwBytesWritten);
+
   if(self->_req_abort)
     return CURL_WRITEFUNC_ERROR;
 
@@ -792,6 +1036,10 @@ int OmConnect::_perform_progress_fn(void* ptr, int64_t dltot, int64_t dlnow, int
     self->_rate_time = clock();
   }
 
+  // instance is being destroyed
+  if(self->_req_detach)
+    return 1; //< abort process
+
   if(self->_req_download_cb) {
     if(!self->_req_download_cb( self->_req_user_ptr,
                                 self->_progress_tot,
@@ -807,6 +1055,65 @@ int OmConnect::_perform_progress_fn(void* ptr, int64_t dltot, int64_t dlnow, int
 }
 
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+size_t OmConnect::_perform_header_fn(char *recv_data, size_t recv_s, size_t recv_n, void *ptr)
+{
+  OmConnect* self = static_cast<OmConnect*>(ptr);
+
+  size_t recv_len = recv_s * recv_n;
+
+  OmCString header(recv_data, recv_len);
+
+  // new response after redirection, forget previous validators
+  if(header.compare(0, 5, "HTTP/") == 0) {
+    self->_resp_etag.clear();
+    self->_resp_modified.clear();
+    return recv_len;
+  }
+
+  size_t colon = header.find(':');
+  if(colon == OmCString::npos)
+    return recv_len;
+
+  OmCString name = header.substr(0, colon);
+  for(size_t i = 0; i < name.size(); ++i)
+    name[i] = tolower(name[i]);
+
+  // header value without leading spaces and trailing CRLF
+  size_t beg = header.find_first_not_of(" \t", colon + 1);
+  size_t end = header.find_last_not_of(" \t\r\n");
+
+  OmCString value;
+  if(beg != OmCString::npos && end != OmCString::npos && end >= beg)
+    value = header.substr(beg, end - beg + 1);
+
+  if(name == "etag") {
+    self->_resp_etag = value;
+  } else if(name == "last-modified") {
+    self->_resp_modified = value;
+  }
+
+  return recv_len;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmWString OmConnect::httpGetEtag() const
+{
+  return Om_toUTF16(this->_resp_etag);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmWString OmConnect::httpGetModified() const
+{
+  return Om_toUTF16(this->_resp_modified);
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
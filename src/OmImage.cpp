@@ -232,6 +232,33 @@ bool OmImage::load(uint8_t* data, size_t size)
 }
 
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmImage::loadPixels(uint8_t* pixels, unsigned width, unsigned height)
+{
+  // clear all previous data
+  this->clear();
+
+  if(!pixels || !width || !height) {
+    this->_ercode = OM_IMAGE_ERR_LOAD;
+    return false;
+  }
+
+  this->_data = pixels;
+  this->_width = width;
+  this->_height = height;
+
+  // create HBITMAP from data
+  this->_hbmp = Om_imgEncodeHbmp(this->_data, width, height, 4);
+
+  // image is loaded and valid
+  this->_valid = true;
+
+  return true;
+}
+
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -15,6 +15,8 @@
   along with Open Mod Manager. If not, see <http://www.gnu.org/licenses/>.
 */
 #include <algorithm>            //< std::find
+#include <map>
+#include <unordered_map>
 
 #include "OmBaseApp.h"
 
@@ -23,6 +25,7 @@
 #include "OmUtilErr.h"
 #include "OmUtilStr.h"
 #include "OmUtilAlg.h"
+#include "OmUtilWin.h"
 
 #include "OmArchive.h"          //< Archive compression methods / level
 
@@ -36,6 +39,34 @@
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 #include "OmModChan.h"
 
+/// \brief Default repository query threads
+///
+/// Default count of repositories queried concurrently.
+///
+#define QUERY_DEF_THREADS       8
+
+/// \brief Maximum repository query threads
+///
+/// Maximum count of worker threads used to query repositories, also used
+/// when no limit is defined.
+///
+#define QUERY_MAX_THREADS       32
+
+/// \brief Maximum Mod operations worker threads
+///
+/// Maximum count of worker threads shared by all concurrent Mod operations
+/// to copy files, regardless count of operations running at once.
+///
+#define MODOPS_MAX_WORKERS      8
+
+/// \brief Maximum Mod operation threads
+///
+/// Maximum count of Mod install or restore operations allowed to run
+/// concurrently. Each operation spreads its own file copies over worker
+/// threads taken from a shared budget, so this is kept low.
+///
+#define MODOPS_MAX_THREADS      4
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -50,6 +81,8 @@ OmModChan::OmModChan(OmModHub* ModHub) :
   _modpack_notify_ptr(nullptr),
   _netpack_notify_cb(nullptr),
   _netpack_notify_ptr(nullptr),
+  _depgraph_dirty(true),
+  _depgraph_cycles(0),
   _locked_mod_library(false),
   _locked_net_library(false),
   _modops_abort(false),
@@ -65,8 +98,6 @@ OmModChan::OmModChan(OmModHub* ModHub) :
   _download_abort(false),
   _download_dones(0),
   _download_percent(0),
-  _download_start_hth(nullptr),
-  _download_start_hwo(nullptr),
   _download_begin_cb(nullptr),
   _download_download_cb(nullptr),
   _download_result_cb(nullptr),
@@ -86,6 +117,9 @@ OmModChan::OmModChan(OmModHub* ModHub) :
   _query_hth(nullptr),
   _query_hwo(nullptr),
   _query_dones(0),
+  _query_added(0),
+  _query_changed(0),
+  _query_removed(0),
   _query_percent(0),
   _query_begin_cb(nullptr),
   _query_result_cb(nullptr),
@@ -93,10 +127,12 @@ OmModChan::OmModChan(OmModHub* ModHub) :
   _query_user_ptr(nullptr),
   _library_devmode(true),
   _library_showhidden(false),
+  _install_mode(OM_INSTALL_COPY),
   _warn_overlaps(true),
   _warn_extra_inst(true),
   _backup_method(OM_METHOD_ZSTD),
   _backup_level(OM_LEVEL_FAST),
+  _backup_dedup(false),
   _warn_extra_unin(true),
   _warn_extra_dnld(true),
   _warn_miss_deps(true),
@@ -104,10 +140,37 @@ OmModChan::OmModChan(OmModHub* ModHub) :
   _warn_upgd_brk_deps(true),
   _upgd_rename(false),
   _down_max_rate(0),
-  _down_max_thread(0)
+  _down_max_thread(0),
+  _query_max_thread(QUERY_DEF_THREADS),
+  _log_defer(false),
+  _journal_hfile(nullptr),
+  _journal_pend(0),
+  _workers_max(0),
+  _workers_used(0),
+  _workers_users(0)
 {
   // set parameters for library monitor
   this->_monitor.setCallback(OmModChan::_monitor_notify_fn, this);
+
+  InitializeCriticalSection(&this->_log_defer_lock);
+  InitializeCriticalSection(&this->_path_index_lock);
+  InitializeCriticalSection(&this->_depgraph_lock);
+  InitializeCriticalSection(&this->_blobs_lock);
+  InitializeCriticalSection(&this->_journal_lock);
+  InitializeCriticalSection(&this->_workers_lock);
+
+  // define worker threads budget according available processors
+  SYSTEM_INFO sys_info;
+  GetSystemInfo(&sys_info);
+
+  this->_workers_max = sys_info.dwNumberOfProcessors;
+  if(this->_workers_max > MODOPS_MAX_WORKERS) this->_workers_max = MODOPS_MAX_WORKERS;
+  if(this->_workers_max < 1) this->_workers_max = 1;
+  InitializeCriticalSection(&this->_modops_lock);
+  InitializeCriticalSection(&this->_modops_cb_lock);
+  InitializeCriticalSection(&this->_download_lock);
+  InitializeCriticalSection(&this->_query_lock);
+  InitializeCriticalSection(&this->_query_cb_lock);
 }
 
 ///
@@ -116,6 +179,18 @@ OmModChan::OmModChan(OmModHub* ModHub) :
 OmModChan::~OmModChan()
 {
   this->close();
+
+  DeleteCriticalSection(&this->_log_defer_lock);
+  DeleteCriticalSection(&this->_path_index_lock);
+  DeleteCriticalSection(&this->_depgraph_lock);
+  DeleteCriticalSection(&this->_blobs_lock);
+  DeleteCriticalSection(&this->_journal_lock);
+  DeleteCriticalSection(&this->_workers_lock);
+  DeleteCriticalSection(&this->_modops_lock);
+  DeleteCriticalSection(&this->_modops_cb_lock);
+  DeleteCriticalSection(&this->_download_lock);
+  DeleteCriticalSection(&this->_query_lock);
+  DeleteCriticalSection(&this->_query_cb_lock);
 }
 
 ///
@@ -161,6 +236,15 @@ void OmModChan::close()
     while(this->_download_queue.size())
       Sleep(50);
   }
+
+  // pending operations, if any, will be recovered at next opening
+  if(this->_journal_hfile) {
+    CloseHandle(this->_journal_hfile);
+    this->_journal_hfile = nullptr;
+  }
+  this->_journal_buff.clear();
+  this->_journal_pend = 0;
+  this->_journal_opers.clear();
 
   this->_lasterr.clear();
 
@@ -206,8 +290,6 @@ void OmModChan::close()
   this->_download_abort = false;
   this->_download_dones = 0;
   this->_download_percent = 0;
-  this->_download_start_hth = nullptr;
-  this->_download_start_hwo = nullptr;
   this->_download_queue.clear();
   this->_download_array.clear();
   this->_download_begin_cb = nullptr;
@@ -228,7 +310,11 @@ void OmModChan::close()
 
   this->_query_abort = false;
   this->_query_queue.clear();
+  this->_query_array.clear();
   this->_query_dones = 0;
+  this->_query_added = 0;
+  this->_query_changed = 0;
+  this->_query_removed = 0;
   this->_query_percent = 0;
   this->_query_begin_cb = nullptr;
   this->_query_result_cb = nullptr;
@@ -238,11 +324,13 @@ void OmModChan::close()
   this->_cust_library_path = false;
   this->_library_devmode = true;
   this->_library_showhidden = false;
+  this->_install_mode = OM_INSTALL_COPY;
   this->_warn_overlaps = true;
   this->_warn_extra_inst = true;
   this->_cust_backup_path = false;
   this->_backup_method = OM_METHOD_ZSTD;
   this->_backup_level = OM_LEVEL_FAST;
+  this->_backup_dedup = false;
   this->_warn_extra_unin = true;
   this->_warn_extra_dnld = true;
   this->_warn_miss_deps = true;
@@ -251,6 +339,7 @@ void OmModChan::close()
   this->_upgd_rename = false;
   this->_down_max_rate = 0;
   this->_down_max_thread = 0;
+  this->_query_max_thread = QUERY_DEF_THREADS;
 }
 
 ///
@@ -394,6 +483,14 @@ bool OmModChan::open(const OmWString& path)
     this->setBackupComp(this->_backup_method, this->_backup_level);
   }
 
+  if(this->_xml.hasChild(L"backup_dedup")) {
+    this->_backup_dedup = this->_xml.child(L"backup_dedup").attrAsInt(L"enable");
+  } else {
+    // create default values, blobs are stored uncompressed so they are
+    // enabled by default only when Backups are not compressed either
+    this->setBackupDedup(this->_backup_method < 0);
+  }
+
   if(this->_xml.hasChild(L"library_sort")) {
     this->_modpack_list_sort = this->_xml.child(L"library_sort").attrAsInt(L"sort");
   } else {
@@ -416,6 +513,16 @@ bool OmModChan::open(const OmWString& path)
     this->setLibraryShowhidden(this->_library_showhidden); //< create default
   }
 
+  if(this->_xml.hasChild(L"install_mode")) {
+    this->_install_mode = this->_xml.child(L"install_mode").attrAsInt(L"mode");
+    // ensure consistent value
+    if(this->_install_mode < OM_INSTALL_COPY || this->_install_mode > OM_INSTALL_AUTO)
+      this->setInstallMode(OM_INSTALL_COPY);
+  } else {
+    // create default values
+    this->setInstallMode(this->_install_mode);
+  }
+
   if(this->_xml.hasChild(L"remotes_sort")) {
     this->_netpack_list_sort = this->_xml.child(L"remotes_sort").attrAsInt(L"sort");
   } else {
@@ -526,6 +633,12 @@ bool OmModChan::open(const OmWString& path)
       this->setDownLimits(this->_down_max_rate, this->_down_max_thread);
     }
 
+    if(network_node.hasChild(L"query_limits")) {
+      this->_query_max_thread = network_node.child(L"query_limits").attrAsInt(L"thread");
+    } else {
+      this->setQueryLimits(this->_query_max_thread);
+    }
+
   } else {
     // create default
     this->_xml.addChild(L"network");
@@ -533,12 +646,33 @@ bool OmModChan::open(const OmWString& path)
     this->setWarnMissDnld(this->_warn_miss_dnld);
     this->setWarnUpgdBrkDeps(this->_warn_upgd_brk_deps);
     this->setDownLimits(this->_down_max_rate, this->_down_max_thread);
+    this->setQueryLimits(this->_query_max_thread);
   }
 
   this->_log(OM_LOG_OK, L"open", L"OK");
 
+  // roll back incomplete Backups from interrupted operations, others are
+  // restored once Library is loaded
+  OmWStringArray restores;
+  this->_journal_rollback(&restores);
+
+  // blobs left under temporary name by an interrupted store are not valid
+  // and were put back by roll back if needed
+  OmWString blobs_dir;
+  Om_concatPaths(blobs_dir, this->_backup_path, OM_MODCHAN_BLOBS_DIR);
+
+  if(Om_isDir(blobs_dir)) {
+    OmWStringArray blobs_tmp;
+    Om_lsFileFiltered(&blobs_tmp, blobs_dir, L"*.tmp", true, true);
+    for(size_t i = 0; i < blobs_tmp.size(); ++i)
+      Om_fileDelete(blobs_tmp[i]);
+  }
+
   // Load library
   this->reloadModLibrary();
+
+  if(!restores.empty())
+    this->_journal_restore(restores);
 
   // start library monitoring
   if(this->accessesLibrary(OM_ACCESS_DIR_READ))
@@ -868,6 +1002,9 @@ void OmModChan::_monitor_notify_fn(void* ptr, OmNotify notify, uint64_t param)
 
   if(has_changes) {
 
+    // Mod identities or dependencies may have changed
+    self->_depgraph_invalidate();
+
     // if an element was added to list we need to sort again
     if(has_created) {
 
@@ -898,8 +1035,171 @@ void OmModChan::clearModLibrary()
 
     this->_modpack_list.clear();
   }
+
+  this->_depgraph_invalidate();
 }
 
+/// \brief Library cache map
+///
+/// Typedef for an STL map of Library cache XML nodes keyed by Source path
+///
+typedef std::map<OmWString, OmXmlNode> OmLibCacheMap;
+
+/// \brief Maximum library scan threads
+///
+/// Maximum count of worker threads used to parse Backups and Sources
+/// while reloading Mod Library.
+///
+#define LIBSCAN_MAX_THREADS     8
+
+/// \brief Library scan job structure
+///
+/// Structure to describe a single Backup or Source to be parsed by
+/// library scan worker threads.
+///
+typedef struct libscan_job_
+{
+  OmModPack*      ModPack;  //< Mod Pack to parse Backup or Source for
+
+  OmWString       path;     //< Backup or Source path
+
+  bool            owned;    //< Mod Pack was created for this job
+
+  bool            skip;     //< Job was superseded and must be ignored
+
+  bool            result;   //< Parse result
+
+  bool            cached;   //< Source was setup from Library cache
+
+  bool            isfile;   //< Source is a file, thus can be cached
+
+  uint64_t        size;     //< Source file size
+
+  uint64_t        mtime;    //< Source file last write time
+
+} libscan_job_t;
+
+/// \brief Library scan context structure
+///
+/// Shared context for library scan worker threads, workers pull jobs
+/// from the shared list, the Library cache is only read by workers.
+///
+typedef struct libscan_context_
+{
+  std::vector<libscan_job_t>  jobs;       //< Jobs list
+
+  bool                        backup;     //< Jobs are Backups to parse
+
+  const OmLibCacheMap*        cache_map;  //< Library cache nodes map
+
+  volatile LONG               next;       //< Next job to be processed
+
+} libscan_context_t;
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static void __libscan_parse(libscan_context_t* lctx, libscan_job_t* job)
+{
+  if(lctx->backup) {
+    job->result = job->ModPack->parseBackup(job->path);
+    return;
+  }
+
+  WIN32_FILE_ATTRIBUTE_DATA fa;
+
+  // directories are never cached since their modification time is unreliable
+  if(!GetFileAttributesExW(job->path.c_str(), GetFileExInfoStandard, &fa) || (fa.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+    job->result = job->ModPack->parseSource(job->path);
+    return;
+  }
+
+  job->isfile = true;
+  job->size = (static_cast<uint64_t>(fa.nFileSizeHigh) << 32) | fa.nFileSizeLow;
+  job->mtime = (static_cast<uint64_t>(fa.ftLastWriteTime.dwHighDateTime) << 32) | fa.ftLastWriteTime.dwLowDateTime;
+
+  OmLibCacheMap::const_iterator it = lctx->cache_map->find(job->path);
+
+  if(it != lctx->cache_map->end()) {
+    if(it->second.attrAsUint64(L"size") == job->size && it->second.attrAsUint64(L"mtime") == job->mtime) {
+      if(job->ModPack->loadSourceCache(job->path, it->second)) {
+        job->cached = true;
+        job->result = true;
+        return;
+      }
+    }
+  }
+
+  job->result = job->ModPack->parseSource(job->path);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static DWORD WINAPI __libscan_run_fn(void* ptr)
+{
+  libscan_context_t* lctx = static_cast<libscan_context_t*>(ptr);
+
+  while(true) {
+
+    // pick next job in list
+    LONG j = InterlockedIncrement(&lctx->next) - 1;
+    if(j >= static_cast<LONG>(lctx->jobs.size()))
+      break;
+
+    libscan_job_t* job = &lctx->jobs[j];
+
+    if(!job->skip)
+      __libscan_parse(lctx, job);
+  }
+
+  return 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static void __libscan_run(libscan_context_t* lctx)
+{
+  lctx->next = 0;
+
+  if(lctx->jobs.empty())
+    return;
+
+  // define worker threads count according available processors
+  SYSTEM_INFO sys_info;
+  GetSystemInfo(&sys_info);
+
+  size_t thread_cnt = sys_info.dwNumberOfProcessors;
+  if(thread_cnt > LIBSCAN_MAX_THREADS) thread_cnt = LIBSCAN_MAX_THREADS;
+  if(thread_cnt > lctx->jobs.size()) thread_cnt = lctx->jobs.size();
+  if(thread_cnt < 1) thread_cnt = 1;
+
+  HANDLE hth[LIBSCAN_MAX_THREADS];
+  DWORD hth_cnt = 0;
+
+  // a single job is not worth a thread
+  if(thread_cnt > 1) {
+    for(size_t t = 0; t < thread_cnt; ++t) {
+      hth[hth_cnt] = Om_threadCreate(__libscan_run_fn, lctx);
+      if(hth[hth_cnt]) hth_cnt++;
+    }
+  }
+
+  if(hth_cnt) {
+
+    WaitForMultipleObjects(hth_cnt, hth, true, INFINITE);
+
+    for(DWORD t = 0; t < hth_cnt; ++t)
+      CloseHandle(hth[t]);
+
+  } else {
+
+    // no thread available, process jobs in current thread
+    __libscan_run_fn(lctx);
+  }
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -914,6 +1214,8 @@ void OmModChan::reloadModLibrary()
     this->_modpack_list.clear();
   }
 
+  this->_depgraph_invalidate();
+
   if(!this->accessesLibrary(OM_ACCESS_DIR_READ)) { // check for read access
     #ifdef DEBUG
     std::cout << "DEBUG => OmModChan::reloadModLibrary X\n";
@@ -923,24 +1225,71 @@ void OmModChan::reloadModLibrary()
 
   OmWStringArray paths;
 
+  // Backups and Sources are parsed by worker threads, logs they produce
+  // are held back then forwarded once all workers ended
+  this->_defer_log(true);
+
+  libscan_context_t lctx;
+  lctx.cache_map = nullptr;
+
   // get Backup directory content
   Om_lsFileFiltered(&paths, this->_backup_path, L"*.zip", true, true);
   Om_lsFileFiltered(&paths, this->_backup_path, L"*." OM_BCK_FILE_EXT, true, true);
   Om_lsDir(&paths, this->_backup_path, true, true);
 
-  // add all available and valid Backups
+  // Backup blob store is not a Backup
+  for(size_t i = 0; i < paths.size(); ++i) {
+    if(Om_namesMatches(Om_getFilePart(paths[i]), OM_MODCHAN_BLOBS_DIR)) {
+      paths.erase(paths.begin() + i); break;
+    }
+  }
+
+  // parse all available Backups
+  lctx.backup = true;
+
+  lctx.jobs.resize(paths.size());
   for(size_t i = 0; i < paths.size(); ++i) {
+    libscan_job_t& job = lctx.jobs[i];
+    job.ModPack = new OmModPack(this);
+    job.path = paths[i];
+    job.owned = true;
+    job.skip = job.result = job.cached = job.isfile = false;
+    job.size = job.mtime = 0;
+  }
+
+  __libscan_run(&lctx);
 
-    OmModPack* ModPack = new OmModPack(this);
+  // add all valid Backups, mapped by hash to be linked with Sources
+  std::unordered_map<uint64_t, OmModPack*> backup_map;
 
-    if(ModPack->parseBackup(paths[i])) {
-      this->_modpack_list.push_back(ModPack);
+  for(size_t i = 0; i < lctx.jobs.size(); ++i) {
+    if(lctx.jobs[i].result) {
+      this->_modpack_list.push_back(lctx.jobs[i].ModPack);
+      backup_map[lctx.jobs[i].ModPack->hash()] = lctx.jobs[i].ModPack;
     } else {
-      delete ModPack;
+      delete lctx.jobs[i].ModPack;
     }
-
   }
 
+  // load Library cache, unchanged Sources are setup from it instead
+  // of being parsed again
+  OmWString cache_path;
+  Om_concatPaths(cache_path, this->_home, OM_MODCHN_LIBCACHE);
+
+  OmXmlConf cache_cfg;
+  if(!cache_cfg.load(cache_path, OM_XMAGIC_LCH))
+    cache_cfg.init(cache_path, OM_XMAGIC_LCH);
+
+  OmLibCacheMap cache_map;
+
+  OmXmlNodeArray cache_nodes;
+  cache_cfg.children(cache_nodes, L"source");
+
+  for(size_t i = 0; i < cache_nodes.size(); ++i)
+    cache_map[cache_nodes[i].attrAsString(L"path")] = cache_nodes[i];
+
+  bool cache_changed = false;
+
   // get Library directory content
   paths.clear();
   Om_lsFileFiltered(&paths, this->_library_path, L"*.zip", true, this->_library_showhidden);
@@ -948,32 +1297,97 @@ void OmModChan::reloadModLibrary()
   if(this->_library_devmode)
     Om_lsDir(&paths, this->_library_path, true, this->_library_showhidden);
 
-  // Link Sources to matching Backup, or add new Sources
+  // parse all Sources, linking them to matching Backup or to new Mod Pack
+  lctx.backup = false;
+  lctx.cache_map = &cache_map;
+
+  std::unordered_map<OmModPack*, size_t> linked_map;
+
+  lctx.jobs.clear();
+  lctx.jobs.resize(paths.size());
   for(size_t i = 0; i < paths.size(); ++i) {
 
-    uint64_t name_hash = Om_getXXHash3(Om_getFilePart(paths[i]));
+    libscan_job_t& job = lctx.jobs[i];
+    job.path = paths[i];
+    job.skip = job.result = job.cached = job.isfile = false;
+    job.size = job.mtime = 0;
 
-    bool found = false;
+    std::unordered_map<uint64_t, OmModPack*>::iterator it = backup_map.find(Om_getXXHash3(Om_getFilePart(paths[i])));
 
-    // check whether this Mod Source matches an existing Backup
-    for(size_t p = 0; p < this->_modpack_list.size(); p++) {
-      if(name_hash == this->_modpack_list[p]->hash()) {
-        this->_modpack_list[p]->parseSource(paths[i]);
-        found = true; break;
-      }
+    if(it != backup_map.end()) {
+
+      // the same Backup cannot be parsed twice concurrently, the last
+      // Source found supersedes the previous one
+      std::unordered_map<OmModPack*, size_t>::iterator lt = linked_map.find(it->second);
+      if(lt != linked_map.end())
+        lctx.jobs[lt->second].skip = true;
+
+      linked_map[it->second] = i;
+
+      job.ModPack = it->second;
+      job.owned = false;
+
+    } else {
+
+      job.ModPack = new OmModPack(this);
+      job.owned = true;
     }
+  }
+
+  __libscan_run(&lctx);
+
+  // add new Sources and update Library cache
+  for(size_t i = 0; i < lctx.jobs.size(); ++i) {
 
-    // no Backup found for this Mod Source, adding new
-    if(!found) {
-      OmModPack* ModPack = new OmModPack(this);
-      if(ModPack->parseSource(paths[i])) {
-        this->_modpack_list.push_back(ModPack);
+    libscan_job_t& job = lctx.jobs[i];
+
+    if(job.owned) {
+      if(job.result) {
+        this->_modpack_list.push_back(job.ModPack);
       } else {
-        delete ModPack;
+        delete job.ModPack;
       }
     }
+
+    if(job.skip || !job.isfile)
+      continue;
+
+    OmLibCacheMap::iterator it = cache_map.find(job.path);
+
+    if(it != cache_map.end()) {
+
+      OmXmlNode cache_node = it->second;
+      cache_map.erase(it);
+
+      if(job.cached)
+        continue;
+
+      // outdated cache entry
+      cache_cfg.remChild(cache_node);
+      cache_changed = true;
+    }
+
+    if(job.result) {
+      OmXmlNode cache_node = cache_cfg.addChild(L"source");
+      cache_node.setAttr(L"size", job.size);
+      cache_node.setAttr(L"mtime", job.mtime);
+      job.ModPack->saveSourceCache(cache_node);
+      cache_changed = true;
+    }
   }
 
+  // forward logs produced by worker threads
+  this->_defer_log(false);
+
+  // remove cache entries of Sources which no longer exist
+  for(OmLibCacheMap::iterator it = cache_map.begin(); it != cache_map.end(); ++it) {
+    cache_cfg.remChild(it->second);
+    cache_changed = true;
+  }
+
+  if(cache_changed)
+    cache_cfg.save();
+
   // sort library
   this->sortModLibrary(); //< this will send rebuild notification
 
@@ -996,6 +1410,11 @@ bool OmModChan::refreshModLibrary()
 {
   bool has_change = false;
 
+  // all Mods are refreshed, pending changes are irrelevant
+  EnterCriticalSection(&this->_path_index_lock);
+  this->_overlap_changes.clear();
+  LeaveCriticalSection(&this->_path_index_lock);
+
   for(size_t i = 0; i < this->_modpack_list.size(); ++i) {
 
     // refresh Net Pack status
@@ -1015,6 +1434,48 @@ bool OmModChan::refreshModLibrary()
 
   return has_change;
 }
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModChan::refreshModChanges()
+{
+  bool has_change = false;
+
+  // take pending changes
+  OmUint64Array changes;
+
+  EnterCriticalSection(&this->_path_index_lock);
+  changes.swap(this->_overlap_changes);
+  LeaveCriticalSection(&this->_path_index_lock);
+
+  if(changes.empty())
+    return false;
+
+  std::sort(changes.begin(), changes.end());
+
+  for(size_t i = 0; i < this->_modpack_list.size(); ++i) {
+
+    // only Mods whose status may have changed
+    if(!std::binary_search(changes.begin(), changes.end(), this->_modpack_list[i]->hash()))
+      continue;
+
+    if(this->_modpack_list[i]->refreshAnalytics()) {
+
+      // notify changes
+      if(this->_modpack_notify_cb)
+        this->_modpack_notify_cb(this->_modpack_notify_ptr, OM_NOTIFY_ALTERED, this->_modpack_list[i]->hash());
+
+      has_change = true;
+    }
+  }
+
+  #ifdef DEBUG
+  std::cout << "DEBUG => OmModChan::refreshModChanges " << (has_change ? "~=" : "==") << "\n";
+  #endif
+
+  return has_change;
+}
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
@@ -1041,6 +1502,8 @@ bool OmModChan::ghostbusterModLibrary()
 
       // remove from list
       this->_modpack_list.erase(this->_modpack_list.begin() + p); --p;
+
+      this->_depgraph_invalidate();
 
       has_change = true;
     }
@@ -1341,6 +1804,9 @@ void OmModChan::sortModLibrary()
     std::reverse(this->_modpack_list.begin(), this->_modpack_list.end());
   }
 
+  // dependency graph nodes follow library order
+  this->_depgraph_invalidate();
+
   if(this->_modpack_notify_cb)
     this->_modpack_notify_cb(this->_modpack_notify_ptr, OM_NOTIFY_REBUILD, 0);
 }
@@ -1380,13 +1846,7 @@ void OmModChan::setModLibrarySort(OmSort sorting)
 ///
 bool OmModChan::isOverlapped(size_t index) const
 {
-  uint64_t mod_hash = this->_modpack_list[index]->hash();
-
-  for(size_t i = 0; i < this->_modpack_list.size(); ++i)
-    if(this->_modpack_list[i]->hasOverlap(mod_hash))
-      return true;
-
-  return false;
+  return this->isOverlapped(this->_modpack_list[index]);
 }
 
 ///
@@ -1394,13 +1854,13 @@ bool OmModChan::isOverlapped(size_t index) const
 ///
 bool OmModChan::isOverlapped(const OmModPack* ModPack) const
 {
-  uint64_t mod_hash = ModPack->hash();
+  EnterCriticalSection(&this->_path_index_lock);
 
-  for(size_t i = 0; i < this->_modpack_list.size(); ++i)
-    if(this->_modpack_list[i]->hasOverlap(mod_hash))
-      return true;
+  bool is_overlapped = (this->_overlap_index.count(ModPack->hash()) > 0);
 
-  return false;
+  LeaveCriticalSection(&this->_path_index_lock);
+
+  return is_overlapped;
 }
 
 ///
@@ -1408,10 +1868,11 @@ bool OmModChan::isOverlapped(const OmModPack* ModPack) const
 ///
 void OmModChan::findOverlaps(const OmModPack* ModPack, OmUint64Array* overlaps) const
 {
-  for(size_t i = 0; i < this->_modpack_list.size(); ++i)
-    if(this->_modpack_list[i]->hasBackup())
-      if(ModPack->canOverlap(this->_modpack_list[i]))
-        overlaps->push_back(this->_modpack_list[i]->hash());
+  OmPModPackArray found;
+  this->findOverlaps(ModPack, &found);
+
+  for(size_t i = 0; i < found.size(); ++i)
+    overlaps->push_back(found[i]->hash());
 }
 
 ///
@@ -1419,10 +1880,40 @@ void OmModChan::findOverlaps(const OmModPack* ModPack, OmUint64Array* overlaps)
 ///
 void OmModChan::findOverlaps(const OmModPack* ModPack, OmPModPackArray* overlaps) const
 {
+  std::unordered_map<const OmModPack*, bool> found;
+
+  EnterCriticalSection(&this->_path_index_lock);
+
+  for(size_t i = 0; i < ModPack->sourceEntryCount(); ++i) {
+
+    const OmModEntry_t& entry = ModPack->getSourceEntry(i);
+
+    if(OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR)) //< we don't care directories
+      continue;
+
+    OmPathIndex::const_iterator it = this->_path_index.find(Om_getPathHash(entry.path));
+    if(it == this->_path_index.end())
+      continue;
+
+    for(size_t j = 0; j < it->second.size(); ++j) {
+
+      if(OM_HAS_BIT(it->second[j].attr, OM_MODENTRY_DIR))
+        continue;
+
+      if(it->second[j].ModPack != ModPack)
+        found[it->second[j].ModPack] = true;
+    }
+  }
+
+  LeaveCriticalSection(&this->_path_index_lock);
+
+  if(found.empty())
+    return;
+
+  // keep library order
   for(size_t i = 0; i < this->_modpack_list.size(); ++i)
-    if(this->_modpack_list[i]->hasBackup())
-      if(ModPack->canOverlap(this->_modpack_list[i]))
-        overlaps->push_back(this->_modpack_list[i]);
+    if(found.count(this->_modpack_list[i]))
+      overlaps->push_back(this->_modpack_list[i]);
 }
 
 ///
@@ -1442,95 +1933,905 @@ void OmModChan::getOverlaps(const OmModPack* ModPack, OmPModPackArray* overlaps)
 ///
 bool OmModChan::backupEntryExists(const OmWString& path, int32_t attr) const
 {
-  for(size_t i = 0; i < this->_modpack_list.size(); ++i)
-    if(this->_modpack_list[i]->hasBackup())
-      if(this->_modpack_list[i]->backupHasEntry(path, attr))
-        return true;
+  bool exists = false;
 
-  return false;
-}
+  EnterCriticalSection(&this->_path_index_lock);
 
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-bool OmModChan::isDependency(const OmModPack* ModPack) const
-{
-  for(size_t i = 0; i < this->_modpack_list.size(); ++i)
-    if(ModPack != this->_modpack_list[i])
-      if(this->_modpack_list[i]->hasDepend(ModPack->iden()))
-        return true;
+  OmPathIndex::const_iterator it = this->_path_index.find(Om_getPathHash(path));
 
-  return false;
+  if(it != this->_path_index.end()) {
+    for(size_t i = 0; i < it->second.size(); ++i) {
+      if(it->second[i].attr == attr) {
+        exists = true; break;
+      }
+    }
+  }
+
+  LeaveCriticalSection(&this->_path_index_lock);
+
+  return exists;
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-bool OmModChan::hasMissingDepend(const OmModPack* ModPack) const
+void OmModChan::indexBackup(const OmModPack* ModPack)
 {
+  OmPathRef_t ref;
+  ref.ModPack = ModPack;
 
-  for(size_t i = 0; i < ModPack->dependCount(); ++i) {
-
-    bool is_missing = true;
-
-    for(size_t j = 0; j < this->_modpack_list.size(); ++j) {
-
-      // ignore directory Mods
-      if(this->_modpack_list[j]->sourceIsDir())
-        continue;
+  EnterCriticalSection(&this->_path_index_lock);
 
-      if(ModPack->getDependIden(i) == this->_modpack_list[j]->iden()) {
+  for(size_t i = 0; i < ModPack->backupEntryCount(); ++i) {
 
-        // recursively check
-        if(this->hasMissingDepend(this->_modpack_list[j]))
-          return true;
+    const OmModEntry_t& entry = ModPack->getBackupEntry(i);
 
-        is_missing = false;
+    ref.attr = entry.attr;
 
-        break;
-      }
-    }
+    this->_path_index[Om_getPathHash(entry.path)].push_back(ref);
+  }
 
-    if(is_missing)
-      return true;
+  // Mods overlapped by this one, their status has changed
+  for(size_t i = 0; i < ModPack->overlapCount(); ++i) {
+    this->_overlap_index[ModPack->getOverlapHash(i)].push_back(ModPack);
+    this->_overlap_changes.push_back(ModPack->getOverlapHash(i));
   }
 
-  return false;
+  this->_overlap_changes.push_back(ModPack->hash());
+
+  LeaveCriticalSection(&this->_path_index_lock);
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModChan::_get_modops_depends(const OmModPack* ModPack, OmPModPackArray* depends, OmWStringArray* missings) const
+void OmModChan::unindexBackup(const OmModPack* ModPack)
 {
-  for(size_t i = 0; i < ModPack->dependCount(); ++i) {
+  EnterCriticalSection(&this->_path_index_lock);
 
-    bool missing = true;
+  for(size_t i = 0; i < ModPack->backupEntryCount(); ++i) {
 
-    for(size_t j = 0; j < this->_modpack_list.size(); ++j) {
+    OmPathIndex::iterator it = this->_path_index.find(Om_getPathHash(ModPack->getBackupEntry(i).path));
+    if(it == this->_path_index.end())
+      continue;
+
+    for(size_t j = 0; j < it->second.size(); ++j) {
+      if(it->second[j].ModPack == ModPack) {
+        it->second.erase(it->second.begin() + j); break;
+      }
+    }
+
+    if(it->second.empty())
+      this->_path_index.erase(it);
+  }
+
+  for(size_t i = 0; i < ModPack->overlapCount(); ++i) {
+
+    OmOverlapIndex::iterator it = this->_overlap_index.find(ModPack->getOverlapHash(i));
+    if(it == this->_overlap_index.end())
+      continue;
+
+    Om_eraseValue(it->second, ModPack);
+
+    if(it->second.empty())
+      this->_overlap_index.erase(it);
+
+    this->_overlap_changes.push_back(ModPack->getOverlapHash(i));
+  }
+
+  this->_overlap_changes.push_back(ModPack->hash());
+
+  LeaveCriticalSection(&this->_path_index_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_blob_path(OmWString* path, const OmWString& key) const
+{
+  Om_concatPaths(*path, this->_backup_path, OM_MODCHAN_BLOBS_DIR);
+  path->append(L"\\");
+  path->append(key);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+int32_t OmModChan::storeBackupBlob(OmWString* key, const OmWString& path)
+{
+  // content checksum is the blob key, it may be already known
+  if(key->empty() && !Om_getXXH128sum(key, path))
+    return GetLastError();
+
+  OmWString blob_path;
+  this->_blob_path(&blob_path, *key);
+
+  int32_t result = 0;
+
+  EnterCriticalSection(&this->_blobs_lock);
+
+  if(!Om_isFile(blob_path)) {
+
+    OmWString blob_tree = Om_getDirPart(blob_path);
+
+    if(!Om_isDir(blob_tree))
+      result = Om_dirCreateRecursive(blob_tree);
+
+    if(result == 0) {
+
+      // blob is first written under temporary name so a partially written
+      // file is never mistaken for a valid blob
+      OmWString temp_path = blob_path + L".tmp";
+
+      // a file with several hard links shares its data with another file
+      // (possibly a Library Source) it must be copied, not moved
+      if(Om_fileLinkCount(path) > 1) {
+        result = Om_fileCopy(path, temp_path, true);
+      } else {
+        result = Om_fileMove(path, temp_path);
+      }
+
+      if(result == 0)
+        result = Om_fileMove(temp_path, blob_path);
+    }
+  }
+
+  if(result == 0)
+    this->_blobs_refs[*key]++;
+
+  LeaveCriticalSection(&this->_blobs_lock);
+
+  return result;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+int32_t OmModChan::fetchBackupBlob(const OmWString& key, const OmWString& path)
+{
+  OmWString blob_path;
+  this->_blob_path(&blob_path, key);
+
+  int32_t result;
+
+  EnterCriticalSection(&this->_blobs_lock);
+
+  uint32_t refs = 0;
+
+  std::unordered_map<OmWString, uint32_t>::iterator it = this->_blobs_refs.find(key);
+  if(it != this->_blobs_refs.end()) {
+    refs = --it->second;
+    if(refs == 0) this->_blobs_refs.erase(it);
+  }
+
+  if(refs == 0) {
+    // last reference, no need to keep blob
+    result = Om_fileMove(blob_path, path);
+  } else {
+    result = Om_fileCopy(blob_path, path, true);
+  }
+
+  LeaveCriticalSection(&this->_blobs_lock);
+
+  return result;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::acquireBackupBlob(const OmWString& key)
+{
+  EnterCriticalSection(&this->_blobs_lock);
+  this->_blobs_refs[key]++;
+  LeaveCriticalSection(&this->_blobs_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::releaseBackupBlob(const OmWString& key, bool purge)
+{
+  EnterCriticalSection(&this->_blobs_lock);
+
+  uint32_t refs = 0;
+
+  std::unordered_map<OmWString, uint32_t>::iterator it = this->_blobs_refs.find(key);
+  if(it != this->_blobs_refs.end()) {
+    refs = --it->second;
+    if(refs == 0) this->_blobs_refs.erase(it);
+  }
+
+  if(purge && refs == 0) {
+
+    OmWString blob_path;
+    this->_blob_path(&blob_path, key);
+
+    int32_t result = Om_fileDelete(blob_path);
+    if(result != 0)
+      this->_log(OM_LOG_WRN, L"releaseBackupBlob", Om_errDelete(L"Backup blob file", blob_path, result));
+  }
+
+  LeaveCriticalSection(&this->_blobs_lock);
+}
+
+/// \brief Journal operation structure
+///
+/// Structure to describe the state of an interrupted operation as read
+/// from operations journal.
+///
+typedef struct journal_oper_
+{
+  wchar_t         phase;    //< Last operation phase record
+
+  OmWString       bck_root; //< Backup data root, for directory Backup
+
+  OmWStringArray  paths;    //< Entries moved from Target to Backup
+
+  OmWStringArray  blobs;    //< Blob keys of moved entries
+
+} journal_oper_t;
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_journal_write(const OmCString& record, bool sync)
+{
+  this->_journal_buff.append(record);
+  this->_journal_pend++;
+
+  if(!sync && this->_journal_pend < OM_JOURNAL_BATCH)
+    return;
+
+  if(!this->_journal_hfile) {
+
+    OmWString journal_path;
+    Om_concatPaths(journal_path, this->_home, OM_MODCHN_JOURNAL);
+
+    HANDLE hFile = CreateFileW(journal_path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr,
+                               OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if(hFile == INVALID_HANDLE_VALUE) {
+      this->_log(OM_LOG_WRN, L"journal", Om_errCreate(L"journal file", journal_path, GetLastError()));
+      this->_journal_buff.clear();
+      this->_journal_pend = 0;
+      return;
+    }
+
+    // previous journal may end with a partially written record
+    if(GetLastError() == ERROR_ALREADY_EXISTS)
+      this->_journal_buff.insert(0, 1, '\n');
+
+    this->_journal_hfile = hFile;
+  }
+
+  DWORD wb = 0;
+  bool done = WriteFile(this->_journal_hfile, this->_journal_buff.c_str(), this->_journal_buff.size(), &wb, nullptr) &&
+              wb == this->_journal_buff.size() && FlushFileBuffers(this->_journal_hfile);
+
+  if(!done) {
+
+    OmWString journal_path;
+    Om_concatPaths(journal_path, this->_home, OM_MODCHN_JOURNAL);
+
+    this->_log(OM_LOG_WRN, L"journal", Om_errSave(L"journal file", journal_path, Om_getErrorStr(GetLastError())));
+
+    // file is reopened at next write, a partially written record is then
+    // terminated before new ones
+    CloseHandle(this->_journal_hfile);
+    this->_journal_hfile = nullptr;
+  }
+
+  this->_journal_buff.clear();
+  this->_journal_pend = 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::journalOper(OmJournalOp oper, const OmWString& bck_path, const OmWString& bck_root)
+{
+  EnterCriticalSection(&this->_journal_lock);
+
+  OmWString record;
+
+  switch(oper)
+  {
+  case OM_JOURNAL_BACKUP:
+    this->_journal_opers.insert(bck_path);
+    record = L"B\t" + bck_path + L"\t" + bck_root;
+    break;
+
+  case OM_JOURNAL_APPLY:
+    if(this->_journal_opers.count(bck_path))
+      record = L"A\t" + bck_path;
+    break;
+
+  case OM_JOURNAL_RESTORE:
+    this->_journal_opers.insert(bck_path);
+    record = L"R\t" + bck_path;
+    break;
+
+  case OM_JOURNAL_END:
+    if(this->_journal_opers.erase(bck_path)) {
+
+      if(this->_journal_opers.empty()) {
+
+        // no more pending operation, journal is no longer needed
+        if(this->_journal_hfile) {
+          CloseHandle(this->_journal_hfile);
+          this->_journal_hfile = nullptr;
+        }
+
+        this->_journal_buff.clear();
+        this->_journal_pend = 0;
+
+        OmWString journal_path;
+        Om_concatPaths(journal_path, this->_home, OM_MODCHN_JOURNAL);
+
+        if(Om_pathExists(journal_path))
+          Om_fileDelete(journal_path);
+
+      } else {
+        record = L"E\t" + bck_path;
+      }
+    }
+    break;
+  }
+
+  if(!record.empty())
+    this->_journal_write(Om_toUTF8(record + L"\n"), true);
+
+  LeaveCriticalSection(&this->_journal_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::journalEntry(const OmWString& bck_path, const OmWString& path, const OmWString& blob)
+{
+  EnterCriticalSection(&this->_journal_lock);
+
+  this->_journal_write(Om_toUTF8(L"M\t" + bck_path + L"\t" + path + L"\t" + blob + L"\n"), false);
+
+  LeaveCriticalSection(&this->_journal_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::journalSync()
+{
+  EnterCriticalSection(&this->_journal_lock);
+
+  if(this->_journal_pend)
+    this->_journal_write(OmCString(), true);
+
+  LeaveCriticalSection(&this->_journal_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+size_t OmModChan::acquireWorkers(size_t count)
+{
+  EnterCriticalSection(&this->_workers_lock);
+
+  // keep one worker for each other operation that may start meanwhile
+  size_t reserve = 0;
+  if(this->_workers_users + 1 < MODOPS_MAX_THREADS)
+    reserve = MODOPS_MAX_THREADS - (this->_workers_users + 1);
+
+  size_t avail = 0;
+  if(this->_workers_used + reserve < this->_workers_max)
+    avail = this->_workers_max - (this->_workers_used + reserve);
+
+  if(count > avail) count = avail;
+  if(count < 1) count = 1;
+
+  this->_workers_used += count;
+  this->_workers_users++;
+
+  LeaveCriticalSection(&this->_workers_lock);
+
+  return count;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::releaseWorkers(size_t count)
+{
+  EnterCriticalSection(&this->_workers_lock);
+
+  this->_workers_used = (this->_workers_used > count) ? this->_workers_used - count : 0;
+  if(this->_workers_users) this->_workers_users--;
+
+  LeaveCriticalSection(&this->_workers_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_journal_rollback(OmWStringArray* restores)
+{
+  OmWString journal_path;
+  Om_concatPaths(journal_path, this->_home, OM_MODCHN_JOURNAL);
+
+  if(!Om_isFile(journal_path))
+    return;
+
+  OmCString data;
+  Om_loadPlainText(&data, journal_path);
+
+  // interrupted operations, in journal order
+  OmWStringArray opers;
+  std::unordered_map<OmWString, journal_oper_t> state;
+
+  size_t s = 0, e;
+  while((e = data.find('\n', s)) != OmCString::npos) {
+
+    OmWString record = Om_toUTF16(data.substr(s, e - s));
+
+    s = e + 1;
+
+    // split record fields
+    OmWStringArray field;
+
+    size_t fs = 0, fe;
+    while((fe = record.find(L'\t', fs)) != OmWString::npos) {
+      field.push_back(record.substr(fs, fe - fs));
+      fs = fe + 1;
+    }
+    field.push_back(record.substr(fs));
+
+    if(field.size() < 2 || field[0].size() != 1)
+      continue;
+
+    if(field[0][0] == L'E') {
+      state.erase(field[1]);
+      continue;
+    }
+
+    if(!state.count(field[1]))
+      opers.push_back(field[1]);
+
+    journal_oper_t& oper = state[field[1]];
+
+    switch(field[0][0])
+    {
+    case L'B':
+      oper.phase = L'B';
+      oper.bck_root = field.size() > 2 ? field[2] : OmWString();
+      oper.paths.clear();
+      oper.blobs.clear();
+      break;
+
+    case L'M':
+      if(field.size() > 2) {
+        oper.paths.push_back(field[2]);
+        oper.blobs.push_back(field.size() > 3 ? field[3] : OmWString());
+      }
+      break;
+
+    case L'A':
+    case L'R':
+      oper.phase = field[0][0];
+      break;
+    }
+  }
+
+  for(size_t i = 0; i < opers.size(); ++i) {
+
+    std::unordered_map<OmWString, journal_oper_t>::iterator it = state.find(opers[i]);
+    if(it == state.end())
+      continue;
+
+    const OmWString& bck_path = it->first;
+    const journal_oper_t& oper = it->second;
+
+    // operation must end properly once handled
+    this->_journal_opers.insert(bck_path);
+
+    if(oper.phase != L'B') {
+      // Backup is complete, install or restore is finished by restoring it
+      // once Library is loaded
+      restores->push_back(bck_path);
+      continue;
+    }
+
+    // Backup was not completed, files moved from Target are put back
+    OmWString tgt_file, bck_file;
+
+    size_t n = oper.paths.size();
+    while(n--) {
+
+      Om_concatPaths(tgt_file, this->_target_path, oper.paths[n]);
+
+      if(Om_pathExists(tgt_file))
+        continue;
+
+      int32_t result = 0;
+
+      if(!oper.blobs[n].empty()) {
+        this->_blob_path(&bck_file, oper.blobs[n]);
+        if(Om_isFile(bck_file)) {
+          // blob may be referenced by another Backup, so it is copied
+          result = Om_fileCopy(bck_file, tgt_file, true);
+        } else if(Om_isFile(bck_file + L".tmp")) {
+          // interrupted while blob was stored under temporary name
+          result = Om_fileMove(bck_file + L".tmp", tgt_file);
+        }
+      } else if(!oper.bck_root.empty()) {
+        Om_concatPaths(bck_file, oper.bck_root, oper.paths[n]);
+        if(Om_pathExists(bck_file))
+          result = Om_fileMove(bck_file, tgt_file);
+      }
+
+      if(result != 0)
+        this->_log(OM_LOG_WRN, L"journal", Om_errMove(L"Backup to Target file", tgt_file, result));
+    }
+
+    // delete incomplete Backup
+    if(Om_isDir(bck_path)) {
+      Om_dirDeleteRecursive(bck_path);
+    } else if(Om_isFile(bck_path)) {
+      Om_fileDelete(bck_path);
+    }
+
+    this->_log(OM_LOG_WRN, L"journal", L"interrupted Backup rolled back: " + bck_path);
+
+    this->journalOper(OM_JOURNAL_END, bck_path);
+  }
+
+  // journal was fully processed
+  if(this->_journal_opers.empty() && Om_isFile(journal_path))
+    Om_fileDelete(journal_path);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_journal_restore(const OmWStringArray& restores)
+{
+  bool has_change = false;
+
+  for(size_t i = 0; i < restores.size(); ++i) {
+
+    OmModPack* ModPack = nullptr;
+
+    for(size_t p = 0; p < this->_modpack_list.size(); ++p) {
+      if(this->_modpack_list[p]->hasBackup() && Om_namesMatches(this->_modpack_list[p]->backupPath(), restores[i])) {
+        ModPack = this->_modpack_list[p]; break;
+      }
+    }
+
+    if(ModPack) {
+
+      // restore as undo since install may not have been completed, Backup
+      // files may already have been restored by the interrupted operation
+      ModPack->restoreData(nullptr, nullptr, true, true);
+
+      this->_log(OM_LOG_WRN, L"journal", L"interrupted operation restored: " + ModPack->iden());
+
+      has_change = true;
+
+    } else {
+
+      // Backup definition is already gone, delete remaining data
+      if(Om_isDir(restores[i])) {
+        Om_dirDeleteRecursive(restores[i]);
+      } else if(Om_isFile(restores[i])) {
+        Om_fileDelete(restores[i]);
+      }
+    }
+
+    this->journalOper(OM_JOURNAL_END, restores[i]);
+  }
+
+  if(has_change) {
+    this->ghostbusterModLibrary();
+    this->refreshModLibrary();
+  }
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModChan::isDependency(const OmModPack* ModPack) const
+{
+  bool is_depend = false;
+
+  EnterCriticalSection(&this->_depgraph_lock);
+
+  if(this->_depgraph_dirty)
+    this->_depgraph_build();
+
+  OmIdenIndex::const_iterator it = this->_depgraph_rdeps.find(ModPack->iden());
+  if(it != this->_depgraph_rdeps.end()) {
+    for(size_t i = 0; i < it->second.size(); ++i) {
+      if(this->_depgraph_nodes[it->second[i]].ModPack != ModPack) {
+        is_depend = true; break;
+      }
+    }
+  }
+
+  LeaveCriticalSection(&this->_depgraph_lock);
+
+  return is_depend;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModChan::hasMissingDepend(const OmModPack* ModPack) const
+{
+  bool has_missing = false;
+
+  EnterCriticalSection(&this->_depgraph_lock);
+
+  if(this->_depgraph_dirty)
+    this->_depgraph_build();
+
+  for(size_t i = 0; i < ModPack->dependCount(); ++i) {
+
+    int32_t n = this->_depgraph_resolve(ModPack->getDependIden(i));
+
+    if(n < 0) {
+      has_missing = true; break;
+    }
+
+    // self reference is ignored
+    if(this->_depgraph_nodes[n].ModPack == ModPack)
+      continue;
+
+    // flag is propagated from dependencies at graph build
+    if(this->_depgraph_nodes[n].has_missing) {
+      has_missing = true; break;
+    }
+  }
+
+  LeaveCriticalSection(&this->_depgraph_lock);
+
+  return has_missing;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_depgraph_invalidate()
+{
+  // wait for any pending build to finish so it cannot clear this flag
+  EnterCriticalSection(&this->_depgraph_lock);
+  this->_depgraph_dirty = true;
+  LeaveCriticalSection(&this->_depgraph_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_depgraph_build() const
+{
+  // must be called with graph lock held
+  this->_depgraph_nodes.clear();
+  this->_depgraph_idens.clear();
+  this->_depgraph_rdeps.clear();
+
+  size_t node_cnt = this->_modpack_list.size();
+
+  this->_depgraph_nodes.resize(node_cnt);
+
+  // create nodes, indexed by identity in library order
+  for(size_t i = 0; i < node_cnt; ++i) {
+
+    OmDepNode_t& node = this->_depgraph_nodes[i];
+
+    node.ModPack = this->_modpack_list[i];
+    node.has_missing = false;
+    node.cyclic = false;
+    node.rank = 0;
+
+    this->_depgraph_idens[node.ModPack->iden()].push_back(i);
+  }
+
+  // create direct and reverse edges
+  for(size_t i = 0; i < node_cnt; ++i) {
+
+    OmDepNode_t& node = this->_depgraph_nodes[i];
+
+    for(size_t d = 0; d < node.ModPack->dependCount(); ++d) {
+
+      const OmWString& iden = node.ModPack->getDependIden(d);
+
+      Om_push_backUnique(this->_depgraph_rdeps[iden], static_cast<uint32_t>(i));
+
+      int32_t n = this->_depgraph_resolve(iden);
 
-      // rely only on packages
-      if(this->_modpack_list[j]->sourceIsDir())
+      if(n < 0) {
+        Om_push_backUnique(node.missings, iden);
         continue;
+      }
 
-      if(ModPack->getDependIden(i) == this->_modpack_list[j]->iden()) {
+      // self reference is ignored
+      if(static_cast<size_t>(n) == i)
+        continue;
 
-        this->_get_modops_depends(this->_modpack_list[j], depends, missings);
+      if(!Om_arrayContain(node.depends, static_cast<uint32_t>(n))) {
+        node.depends.push_back(n);
+        this->_depgraph_nodes[n].dependents.push_back(i);
+      }
+    }
+  }
 
-        // we add to list only if unique and not already installed, this allow
-        // us to get a consistent dependency list for a bunch of package by
-        // calling this function for each package without clearing the list
-        if(!this->_modpack_list[j]->hasBackup())
-          Om_push_backUnique(*depends, this->_modpack_list[j]);
+  // propagate missing dependency flag to all dependents
+  OmIndexArray stack;
 
-        missing = false;
-        break;
+  for(size_t i = 0; i < node_cnt; ++i) {
+    if(!this->_depgraph_nodes[i].missings.empty()) {
+      this->_depgraph_nodes[i].has_missing = true;
+      stack.push_back(i);
+    }
+  }
+
+  while(!stack.empty()) {
+
+    uint32_t n = stack.back(); stack.pop_back();
+
+    const OmIndexArray& dependents = this->_depgraph_nodes[n].dependents;
+
+    for(size_t i = 0; i < dependents.size(); ++i) {
+      if(!this->_depgraph_nodes[dependents[i]].has_missing) {
+        this->_depgraph_nodes[dependents[i]].has_missing = true;
+        stack.push_back(dependents[i]);
+      }
+    }
+  }
+
+  // topological ranking, nodes that never get free of pending dependencies
+  // are part of or depend on a cycle
+  OmIndexArray pending(node_cnt);
+  OmIndexArray queue;
+
+  for(size_t i = 0; i < node_cnt; ++i) {
+    pending[i] = this->_depgraph_nodes[i].depends.size();
+    if(pending[i] == 0) queue.push_back(i);
+  }
+
+  uint32_t rank = 0;
+
+  for(size_t q = 0; q < queue.size(); ++q) {
+
+    OmDepNode_t& node = this->_depgraph_nodes[queue[q]];
+
+    node.rank = rank++;
+
+    for(size_t i = 0; i < node.dependents.size(); ++i)
+      if(--pending[node.dependents[i]] == 0)
+        queue.push_back(node.dependents[i]);
+  }
+
+  size_t cycles = node_cnt - queue.size();
+
+  if(cycles) {
+
+    for(size_t i = 0; i < node_cnt; ++i) {
+      if(pending[i] > 0) {
+        this->_depgraph_nodes[i].cyclic = true;
+        this->_depgraph_nodes[i].rank = rank++;
       }
     }
 
-    if(missing)
+    // graph is rebuilt on any library change, warn only when cycles changed
+    if(cycles != this->_depgraph_cycles) {
+      wchar_t cycle_str[80];
+      swprintf(cycle_str, 80, L"%u Mods are part of or depend on a dependency cycle", static_cast<unsigned>(cycles));
+      this->_log(OM_LOG_WRN, L"dependencies", cycle_str);
+    }
+  }
+
+  this->_depgraph_cycles = cycles;
+
+  this->_depgraph_dirty = false;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+int32_t OmModChan::_depgraph_resolve(const OmWString& iden) const
+{
+  OmIdenIndex::const_iterator it = this->_depgraph_idens.find(iden);
+  if(it == this->_depgraph_idens.end())
+    return -1;
+
+  // rely only on packages
+  for(size_t i = 0; i < it->second.size(); ++i)
+    if(!this->_depgraph_nodes[it->second[i]].ModPack->sourceIsDir())
+      return it->second[i];
+
+  return -1;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_depgraph_closure(const OmModPack* ModPack, OmIndexArray* closure, OmWStringArray* missings) const
+{
+  // callers reading nodes from closure must also hold graph lock
+  EnterCriticalSection(&this->_depgraph_lock);
+
+  if(this->_depgraph_dirty)
+    this->_depgraph_build();
+
+  std::vector<bool> visited(this->_depgraph_nodes.size(), false);
+  OmIndexArray stack;
+
+  for(size_t i = 0; i < ModPack->dependCount(); ++i) {
+
+    int32_t n = this->_depgraph_resolve(ModPack->getDependIden(i));
+
+    if(n < 0) {
       Om_push_backUnique(*missings, ModPack->getDependIden(i));
+      continue;
+    }
+
+    if(this->_depgraph_nodes[n].ModPack != ModPack && !visited[n]) {
+      visited[n] = true;
+      stack.push_back(n);
+    }
+  }
+
+  // walk graph, visited flags protect against cycles
+  while(!stack.empty()) {
+
+    uint32_t n = stack.back(); stack.pop_back();
+
+    const OmDepNode_t& node = this->_depgraph_nodes[n];
+
+    closure->push_back(n);
+
+    for(size_t i = 0; i < node.missings.size(); ++i)
+      Om_push_backUnique(*missings, node.missings[i]);
+
+    for(size_t i = 0; i < node.depends.size(); ++i) {
+      if(this->_depgraph_nodes[node.depends[i]].ModPack != ModPack && !visited[node.depends[i]]) {
+        visited[node.depends[i]] = true;
+        stack.push_back(node.depends[i]);
+      }
+    }
+  }
+
+  LeaveCriticalSection(&this->_depgraph_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_get_modops_depends(const OmModPack* ModPack, OmPModPackArray* depends, OmWStringArray* missings) const
+{
+  EnterCriticalSection(&this->_depgraph_lock);
+
+  OmIndexArray closure;
+  this->_depgraph_closure(ModPack, &closure, missings);
+
+  // sort by topological rank so dependencies come first
+  std::vector<std::pair<uint32_t, uint32_t>> ranked;
+
+  for(size_t i = 0; i < closure.size(); ++i)
+    ranked.push_back(std::pair<uint32_t, uint32_t>(this->_depgraph_nodes[closure[i]].rank, closure[i]));
+
+  std::sort(ranked.begin(), ranked.end());
+
+  // we add to list only if unique and not already installed, this allow
+  // us to get a consistent dependency list for a bunch of package by
+  // calling this function for each package without clearing the list
+  for(size_t i = 0; i < ranked.size(); ++i) {
+
+    OmModPack* Depend = this->_depgraph_nodes[ranked[i].second].ModPack;
+
+    if(!Depend->hasBackup())
+      Om_push_backUnique(*depends, Depend);
   }
+
+  LeaveCriticalSection(&this->_depgraph_lock);
 }
 
 ///
@@ -1557,31 +2858,49 @@ void OmModChan::prepareInstalls(const OmPModPackArray& selection, OmPModPackArra
   for(size_t i = 0; i < selection.size(); ++i)
     Om_push_backUnique(*installs, selection.at(i));
 
-  // get installation footprint of Mods to be installed
-  std::vector<OmModEntryArray> footprintArray;
-  OmModEntryArray footprint;
+  // simulated installation index of Mods to be installed, keyed by path hash
+  std::unordered_map<uint64_t, OmIndexArray> install_index;
+
+  OmPModPackArray found_overlaps;
+  OmIndexArray install_overlaps;
 
   // get overlaps list including simulated installation
   for(size_t i = 0; i < installs->size(); ++i) {
 
+    const OmModPack* ModPack = installs->at(i);
+
     // test overlapping against installed Mods
-    for(size_t j = 0; j < this->_modpack_list.size(); ++j) {
-      if(this->_modpack_list[j]->hasBackup()) {
-        if(installs->at(i)->canOverlap(this->_modpack_list[j]))
-          overlaps->push_back(this->_modpack_list[j]->iden());
-      }
-    }
+    found_overlaps.clear();
+    this->findOverlaps(ModPack, &found_overlaps);
+
+    for(size_t j = 0; j < found_overlaps.size(); ++j)
+      overlaps->push_back(found_overlaps[j]->iden());
+
+    // test overlapping against Mods to be installed, then add this one
+    // to simulated installation
+    install_overlaps.clear();
 
-    // test overlapping against Mods to be installed
-    for(size_t j = 0; j < footprintArray.size(); ++j) {
-      if(installs->at(i)->canOverlap(footprintArray[j]))
-        overlaps->push_back(installs->at(j)->iden());
+    for(size_t e = 0; e < ModPack->sourceEntryCount(); ++e) {
+
+      const OmModEntry_t& entry = ModPack->getSourceEntry(e);
+
+      if(OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR)) //< we don't care directories
+        continue;
+
+      OmIndexArray& installers = install_index[Om_getPathHash(entry.path)];
+
+      for(size_t j = 0; j < installers.size(); ++j)
+        if(installers[j] != i)
+          Om_push_backUnique(install_overlaps, installers[j]);
+
+      if(installers.empty() || installers.back() != i)
+        installers.push_back(i);
     }
 
-    // create installation footprint of package
-    footprint.clear();
-    installs->at(i)->getFootprint(&footprint);
-    footprintArray.push_back(footprint);
+    std::sort(install_overlaps.begin(), install_overlaps.end());
+
+    for(size_t j = 0; j < install_overlaps.size(); ++j)
+      overlaps->push_back(installs->at(install_overlaps[j])->iden());
   }
 }
 
@@ -1641,46 +2960,81 @@ void OmModChan::prepareRestores(const OmPModPackArray& selection, OmPModPackArra
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModChan::_get_cleaning_depends(const OmModPack* ModPack, const OmPModPackArray& selection, OmPModPackArray* depends) const
+void OmModChan::_get_cleaning_depends(const OmModPack* ModPack, const OmPModPackArray& selection, OmPModPackArray* depends, std::vector<const OmModPack*>* stack) const
 {
   // recursively found all installed (that have backup) dependencies Mods for the
   // specified Mod, then for each, verify if unused and can be uninstalled along
   // the first specified Mod
 
-  for(size_t i = 0; i < this->_modpack_list.size(); ++i) {
+  EnterCriticalSection(&this->_depgraph_lock);
 
-    // search only among installed Mods
-    if(!this->_modpack_list[i]->hasBackup() || Om_arrayContain(selection, this->_modpack_list[i]))
+  if(this->_depgraph_dirty)
+    this->_depgraph_build();
+
+  // gather installed Mods this one depends on, in library order
+  OmIndexArray candidates;
+
+  for(size_t i = 0; i < ModPack->dependCount(); ++i) {
+
+    OmIdenIndex::const_iterator it = this->_depgraph_idens.find(ModPack->getDependIden(i));
+    if(it == this->_depgraph_idens.end())
       continue;
 
-    if(ModPack->hasDepend(this->_modpack_list[i]->iden())) {
+    for(size_t j = 0; j < it->second.size(); ++j) {
 
-      bool is_breaking = false;
+      OmModPack* Depend = this->_depgraph_nodes[it->second[j]].ModPack;
 
-      // check whether this dependency Mod can be restored/uninstalled
-      // without breaking sibling dependency install
-      for(size_t j = 0; j < this->_modpack_list[i]->dependCount(); ++j) {
+      // search only among installed Mods
+      if(Depend->hasBackup() && !Om_arrayContain(selection, Depend))
+        Om_push_backUnique(candidates, it->second[j]);
+    }
+  }
 
-        // try to find this dependency in Mod Library
-        OmModPack* Sibling = this->findModpack(this->_modpack_list[i]->getDependIden(j));
+  std::sort(candidates.begin(), candidates.end());
 
-        // If Mod is found, check whether it is installed, meaning we cannot
-        // restore this dependency yet
-        if(Sibling && Sibling != ModPack && Sibling->hasBackup()) {
-          is_breaking = true; break;
-        }
-      }
+  // Mods being explored, protect against cycles
+  stack->push_back(ModPack);
+
+  for(size_t i = 0; i < candidates.size(); ++i) {
+
+    OmModPack* Depend = this->_depgraph_nodes[candidates[i]].ModPack;
+
+    if(Om_arrayContain(*stack, static_cast<const OmModPack*>(Depend)))
+      continue;
+
+    bool is_breaking = false;
 
-      if(!is_breaking) {
+    // check whether this dependency Mod can be restored/uninstalled
+    // without breaking sibling dependency install
+    for(size_t j = 0; j < Depend->dependCount(); ++j) {
+
+      // try to find this dependency in Mod Library
+      OmIdenIndex::const_iterator it = this->_depgraph_idens.find(Depend->getDependIden(j));
+      if(it == this->_depgraph_idens.end())
+        continue;
 
-        // check recursively, this give depth-first sorted list
-        this->_get_cleaning_depends(this->_modpack_list[i], selection, depends);
+      OmModPack* Sibling = this->_depgraph_nodes[it->second[0]].ModPack;
 
-        // add only if unique
-        Om_push_backUnique(*depends, this->_modpack_list[i]);
+      // If Mod is found, check whether it is installed, meaning we cannot
+      // restore this dependency yet
+      if(Sibling != ModPack && Sibling->hasBackup()) {
+        is_breaking = true; break;
       }
     }
+
+    if(!is_breaking) {
+
+      // check recursively, this give depth-first sorted list
+      this->_get_cleaning_depends(Depend, selection, depends, stack);
+
+      // add only if unique
+      Om_push_backUnique(*depends, Depend);
+    }
   }
+
+  stack->pop_back();
+
+  LeaveCriticalSection(&this->_depgraph_lock);
 }
 
 ///
@@ -1721,9 +3075,10 @@ void OmModChan::prepareCleaning(const OmPModPackArray& selection, OmPModPackArra
 {
   // get list of extra dependencies that can be cleaned with selection
   OmPModPackArray found_depends;
+  std::vector<const OmModPack*> stack;
   for(size_t i = 0; i < selection.size(); ++i) {
 
-    this->_get_cleaning_depends(selection[i], selection, &found_depends);
+    this->_get_cleaning_depends(selection[i], selection, &found_depends, &stack);
   }
 
   // get overlappers Mods of the found unused dependencies
@@ -1810,8 +3165,10 @@ void OmModChan::queueModOps(const OmPModPackArray& selection, Om_beginCb begin_c
   // reset abort flag
   this->_modops_abort = false;
 
+  EnterCriticalSection(&this->_modops_lock);
   for(size_t i = 0; i < selection.size(); ++i)
     Om_push_backUnique(this->_modops_queue, selection[i]);
+  LeaveCriticalSection(&this->_modops_lock);
 
   if(!this->_modops_hth) {
 
@@ -1867,12 +3224,114 @@ OmResult OmModChan::execModOps(const OmPModPackArray& selection, Om_beginCb begi
   for(size_t i = 0; i < selection.size(); ++i)
     Om_push_backUnique(this->_modops_queue, selection[i]);
 
-  // run install process without thread
-  OmResult result = static_cast<OmResult>(OmModChan::_modops_run_fn(this));
+  // run install process without thread, operations are processed one
+  // after the other since callbacks are expected in calling thread
+  OmResult result = static_cast<OmResult>(this->_modops_run(false));
   OmModChan::_modops_end_fn(this, 0);
 
   return result;
 }
+
+/// \brief Mod operation job states
+///
+/// Processing states of Mod operation scheduler jobs.
+///
+#define MODOPS_JOB_PEND   0   //< waiting to be processed
+#define MODOPS_JOB_WORK   1   //< currently processing
+#define MODOPS_JOB_DONE   2   //< processed
+
+/// \brief Mod operation job structure
+///
+/// Structure to describe a single Mod install or restore operation within
+/// the Mod operation scheduler, along with data to detect conflicts with
+/// other operations.
+///
+typedef struct modops_job_
+{
+  OmModChan*        ModChan;    //< Mod Channel the operation belongs to
+
+  OmModPack*        ModPack;    //< Mod to install or restore
+
+  bool              restore;    //< Operation is a restore, otherwise an install
+
+  OmUint64Array     files;      //< Sorted path hashes of files written or deleted
+
+  OmUint64Array     dirs;       //< Sorted path hashes of involved directories
+
+  OmUint64Array     mkdirs;     //< Sorted path hashes of directories to be created
+
+  OmPModPackArray   relatives;  //< Mods this one depends on, at any depth
+
+  OmIndexArray      waits;      //< Previous jobs that must be processed first
+
+  int32_t           state;      //< Job processing state
+
+  OmResult          result;     //< Operation result
+
+} modops_job_t;
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static void __modops_job_footprint(modops_job_t* job, const OmModEntry_t& entry, OmWStringArray* dir_paths = nullptr)
+{
+  if(OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR)) {
+    job->dirs.push_back(Om_getPathHash(entry.path));
+    if(dir_paths) dir_paths->push_back(entry.path);
+  } else {
+    job->files.push_back(Om_getPathHash(entry.path));
+  }
+
+  // parent directories may be created or deleted too, even when
+  // not explicitly listed
+  for(size_t i = 0; i < entry.path.size(); ++i) {
+    if(entry.path[i] == L'\\' || entry.path[i] == L'/') {
+      job->dirs.push_back(Om_getPathHash(entry.path.substr(0, i)));
+      if(dir_paths) dir_paths->push_back(entry.path.substr(0, i));
+    }
+  }
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static bool __modops_intersects(const OmUint64Array& a, const OmUint64Array& b)
+{
+  size_t i = 0, j = 0;
+
+  while(i < a.size() && j < b.size()) {
+    if(a[i] == b[j]) return true;
+    if(a[i] < b[j]) { ++i; } else { ++j; }
+  }
+
+  return false;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static bool __modops_conflicts(const modops_job_t& a, const modops_job_t& b)
+{
+  // dependency relation, order must be kept
+  if(Om_arrayContain(a.relatives, b.ModPack) || Om_arrayContain(b.relatives, a.ModPack))
+    return true;
+
+  // both write or delete the same file
+  if(__modops_intersects(a.files, b.files))
+    return true;
+
+  // restore may delete directories the other one relies on
+  if(a.restore || b.restore) {
+    if(__modops_intersects(a.dirs, b.dirs) || __modops_intersects(a.files, b.dirs) || __modops_intersects(a.dirs, b.files))
+      return true;
+  }
+
+  // both would create then claim the same directory in their Backup
+  if(__modops_intersects(a.mkdirs, b.dirs) || __modops_intersects(a.dirs, b.mkdirs))
+    return true;
+
+  return false;
+}
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
@@ -1881,85 +3340,254 @@ DWORD WINAPI OmModChan::_modops_run_fn(void* ptr)
 {
   OmModChan* self = static_cast<OmModChan*>(ptr);
 
+  return self->_modops_run(true);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+DWORD WINAPI OmModChan::_modops_job_fn(void* ptr)
+{
+  modops_job_t* job = static_cast<modops_job_t*>(ptr);
+
+  job->result = job->ModChan->_modops_exec(job->ModPack, job->restore);
+
+  return 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmResult OmModChan::_modops_exec(OmModPack* ModPack, bool restore)
+{
+  OmResult result;
+
+  if(restore) {
+
+    // This is a Restore operation
+    result = ModPack->restoreData(OmModChan::_modops_progress_fn, this);
+
+  } else {
+
+    // This is an Install operation
+    result = ModPack->makeBackup(OmModChan::_modops_progress_fn, this);
+    if(result == OM_RESULT_OK)
+      result = ModPack->applySource(OmModChan::_modops_progress_fn, this);
+
+    // restore any stored Backup data
+    if(result != OM_RESULT_OK)
+      ModPack->restoreData(OmModChan::_modops_progress_fn, this, true);
+  }
+
+  return result;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+DWORD OmModChan::_modops_run(bool parallel)
+{
   DWORD exit_code = OM_RESULT_OK;
 
   #ifdef DEBUG
   std::wcout << "DEBUG => OmModChan::_modops_run_fn : enter\n";
   #endif // DEBUG
 
-  while(self->_modops_queue.size()) {
+  // Operations are scheduled in queue order, but an operation only waits
+  // for previous ones it conflicts with, either by dependency relation or
+  // by sharing files or directories, others run concurrently.
+  std::deque<modops_job_t> jobs; //< deque keeps references valid
 
-    OmModPack* ModPack = self->_modops_queue.front();
+  size_t thread_max = 1;
 
-    if(self->_modops_abort) {
+  if(parallel) {
+    // define worker threads count according available processors
+    SYSTEM_INFO sys_info;
+    GetSystemInfo(&sys_info);
 
-      // flush all queue with abort result
+    thread_max = sys_info.dwNumberOfProcessors;
+    if(thread_max > MODOPS_MAX_THREADS) thread_max = MODOPS_MAX_THREADS;
+    if(thread_max < 1) thread_max = 1;
+  }
 
-      if(self->_modops_result_cb)
-        self->_modops_result_cb(self->_modops_user_ptr, OM_RESULT_ABORT, reinterpret_cast<uint64_t>(ModPack));
+  HANDLE hth[MODOPS_MAX_THREADS];
+  size_t hth_job[MODOPS_MAX_THREADS];
+  DWORD hth_cnt = 0;
 
-      self->_modops_queue.pop_front();
+  size_t done_cnt = 0;
 
-      continue;
+  while(true) {
+
+    // gather newly queued Mods
+    OmPModPackArray queued;
+
+    EnterCriticalSection(&this->_modops_lock);
+    for(size_t i = 0; i < this->_modops_queue.size(); ++i)
+      queued.push_back(this->_modops_queue[i]);
+    LeaveCriticalSection(&this->_modops_lock);
+
+    for(size_t i = 0; i < queued.size(); ++i) {
+
+      bool known = false;
+      for(size_t j = 0; j < jobs.size(); ++j) {
+        if(jobs[j].ModPack == queued[i] && jobs[j].state != MODOPS_JOB_DONE) {
+          known = true; break;
+        }
+      }
+
+      if(known)
+        continue;
+
+      jobs.push_back(modops_job_t());
+
+      modops_job_t& job = jobs.back();
+      job.ModChan = this;
+      job.ModPack = queued[i];
+      job.restore = queued[i]->hasBackup();
+      job.state = MODOPS_JOB_PEND;
+      job.result = OM_RESULT_OK;
+
+      if(job.restore) {
+        for(size_t e = 0; e < job.ModPack->backupEntryCount(); ++e)
+          __modops_job_footprint(&job, job.ModPack->getBackupEntry(e));
+      } else {
+
+        OmWStringArray dir_paths;
+
+        for(size_t e = 0; e < job.ModPack->sourceEntryCount(); ++e)
+          __modops_job_footprint(&job, job.ModPack->getSourceEntry(e), &dir_paths);
+
+        std::sort(dir_paths.begin(), dir_paths.end());
+        dir_paths.erase(std::unique(dir_paths.begin(), dir_paths.end()), dir_paths.end());
+
+        // directories not yet existing are created, and recorded for deletion
+        // in Backup, by the first install to run, others must wait for it
+        for(size_t d = 0; d < dir_paths.size(); ++d)
+          if(!Om_isDir(Om_concatPaths(this->_target_path, dir_paths[d])))
+            job.mkdirs.push_back(Om_getPathHash(dir_paths[d]));
+
+        std::sort(job.mkdirs.begin(), job.mkdirs.end());
+      }
+
+      std::sort(job.files.begin(), job.files.end());
+      std::sort(job.dirs.begin(), job.dirs.end());
+
+      OmIndexArray closure;
+      OmWStringArray missings;
+
+      EnterCriticalSection(&this->_depgraph_lock);
+
+      this->_depgraph_closure(job.ModPack, &closure, &missings);
+
+      for(size_t c = 0; c < closure.size(); ++c)
+        job.relatives.push_back(this->_depgraph_nodes[closure[c]].ModPack);
+
+      LeaveCriticalSection(&this->_depgraph_lock);
+
+      // wait for previous conflicting jobs
+      for(size_t j = 0; j + 1 < jobs.size(); ++j)
+        if(jobs[j].state != MODOPS_JOB_DONE && __modops_conflicts(jobs[j], job))
+          job.waits.push_back(j);
     }
 
-    // call client result callback so it can perform proper operations
-    if(self->_modops_begin_cb)
-      self->_modops_begin_cb(self->_modops_user_ptr, reinterpret_cast<uint64_t>(ModPack));
+    // launch ready jobs, or flush them with abort result
+    for(size_t j = 0; j < jobs.size(); ++j) {
+
+      modops_job_t& job = jobs[j];
+
+      if(job.state != MODOPS_JOB_PEND)
+        continue;
+
+      if(this->_modops_abort) {
+
+        job.result = OM_RESULT_ABORT;
+
+      } else {
+
+        if(hth_cnt >= thread_max)
+          break;
+
+        bool ready = true;
+        for(size_t w = 0; w < job.waits.size(); ++w) {
+          if(jobs[job.waits[w]].state != MODOPS_JOB_DONE) {
+            ready = false; break;
+          }
+        }
+
+        if(!ready)
+          continue;
+
+        // call client begin callback so it can perform proper operations
+        if(this->_modops_begin_cb) {
+          EnterCriticalSection(&this->_modops_cb_lock);
+          this->_modops_begin_cb(this->_modops_user_ptr, reinterpret_cast<uint64_t>(job.ModPack));
+          LeaveCriticalSection(&this->_modops_cb_lock);
+        }
+
+        job.state = MODOPS_JOB_WORK;
+
+        if(parallel) {
+          hth[hth_cnt] = Om_threadCreate(OmModChan::_modops_job_fn, &job);
+          if(hth[hth_cnt]) {
+            hth_job[hth_cnt] = j;
+            hth_cnt++;
+            continue;
+          }
+        }
 
-    OmResult result;
+        // no thread, process in current thread
+        OmModChan::_modops_job_fn(&job);
+      }
 
-    if(ModPack->hasBackup()) {
+      // job ended or was flushed in current thread
+      job.state = MODOPS_JOB_DONE;
+      done_cnt++;
 
-      // This is a Restore operation
-      result = ModPack->restoreData(OmModChan::_modops_progress_fn, self);
+      this->_modops_done(job.ModPack, job.restore, job.result, &exit_code);
 
-      // refresh Mod Packs analytical parameters
-      self->refreshModLibrary();
+      // processing took time, new Mods may have been queued meanwhile
+      if(!this->_modops_abort)
+        break;
+    }
 
-      // call client result callback so it can perform proper operations
-      if(self->_modops_result_cb)
-        self->_modops_result_cb(self->_modops_user_ptr, result, reinterpret_cast<uint64_t>(ModPack));
-
-      if(result != OM_RESULT_OK) {
-        exit_code = result;
-        if(result == OM_RESULT_ABORT)
-          self->_modops_abort = true;
-      }
+    if(hth_cnt) {
 
-    } else {
+      // wait for any worker to end
+      DWORD w = WaitForMultipleObjects(hth_cnt, hth, false, 50);
 
-      // This is an Install operation
-      result = ModPack->makeBackup(OmModChan::_modops_progress_fn, self);
-      if(result == OM_RESULT_OK)
-        result = ModPack->applySource(OmModChan::_modops_progress_fn, self);
+      if(w < WAIT_OBJECT_0 + hth_cnt) {
 
-      // refresh Mod Packs analytical parameters
-      self->refreshModLibrary();
+        size_t t = w - WAIT_OBJECT_0;
 
-      // call client result callback so it can perform proper operations
-      if(self->_modops_result_cb)
-        self->_modops_result_cb(self->_modops_user_ptr, result, reinterpret_cast<uint64_t>(ModPack));
+        modops_job_t& job = jobs[hth_job[t]];
 
-      if(result != OM_RESULT_OK) {
-
-        exit_code = result;
+        CloseHandle(hth[t]);
 
-        // restore any stored Backup data
-        ModPack->restoreData(OmModChan::_modops_progress_fn, self, true);
+        hth_cnt--;
+        hth[t] = hth[hth_cnt];
+        hth_job[t] = hth_job[hth_cnt];
 
-        // reset progression status
-        if(self->_modops_progress_cb)
-          self->_modops_progress_cb(self->_modops_user_ptr, 0, 0, reinterpret_cast<uint64_t>(ModPack));
+        job.state = MODOPS_JOB_DONE;
+        done_cnt++;
 
-        if(result == OM_RESULT_ABORT)
-          self->_modops_abort = true;
+        this->_modops_done(job.ModPack, job.restore, job.result, &exit_code);
       }
 
+      continue;
     }
 
-    self->_modops_dones++;
-    self->_modops_queue.pop_front();
+    // stop once all known jobs are done and nothing new was queued
+    if(done_cnt == jobs.size()) {
+
+      bool has_new = false;
+
+      EnterCriticalSection(&this->_modops_lock);
+      has_new = !this->_modops_queue.empty();
+      LeaveCriticalSection(&this->_modops_lock);
+
+      if(!has_new)
+        break;
+    }
   }
 
   #ifdef DEBUG
@@ -1969,6 +3597,40 @@ DWORD WINAPI OmModChan::_modops_run_fn(void* ptr)
   return exit_code;
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_modops_done(OmModPack* ModPack, bool restore, OmResult result, DWORD* exit_code)
+{
+  // refresh analytical parameters of Mods affected by operation before
+  // result is sent, overlap index is updated by each operation under lock
+  // so this is safe while others are running
+  this->refreshModChanges();
+
+  EnterCriticalSection(&this->_modops_cb_lock);
+
+  // call client result callback so it can perform proper operations
+  if(this->_modops_result_cb)
+    this->_modops_result_cb(this->_modops_user_ptr, result, reinterpret_cast<uint64_t>(ModPack));
+
+  // reset progression status
+  if(result != OM_RESULT_OK && !restore && this->_modops_progress_cb)
+    this->_modops_progress_cb(this->_modops_user_ptr, 0, 0, reinterpret_cast<uint64_t>(ModPack));
+
+  LeaveCriticalSection(&this->_modops_cb_lock);
+
+  if(result != OM_RESULT_OK) {
+    *exit_code = result;
+    if(result == OM_RESULT_ABORT)
+      this->_modops_abort = true;
+  }
+
+  EnterCriticalSection(&this->_modops_lock);
+  this->_modops_dones++;
+  Om_eraseValue(this->_modops_queue, ModPack);
+  LeaveCriticalSection(&this->_modops_lock);
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -1976,6 +3638,8 @@ bool OmModChan::_modops_progress_fn(void* ptr, size_t tot, size_t cur, uint64_t
 {
   OmModChan* self = static_cast<OmModChan*>(ptr);
 
+  EnterCriticalSection(&self->_modops_lock);
+
   // compute global queue progress percentage
   double queue_percents = self->_modops_dones * 100;
   for(size_t i = 0; i < self->_modops_queue.size(); ++i)
@@ -1983,9 +3647,18 @@ bool OmModChan::_modops_progress_fn(void* ptr, size_t tot, size_t cur, uint64_t
 
   self->_modops_percent = queue_percents / (self->_modops_dones + self->_modops_queue.size());
 
-  if(self->_modops_progress_cb)
-    if(!self->_modops_progress_cb(self->_modops_user_ptr, tot, cur, param))
+  LeaveCriticalSection(&self->_modops_lock);
+
+  if(self->_modops_progress_cb) {
+
+    // client callbacks are never called concurrently
+    EnterCriticalSection(&self->_modops_cb_lock);
+    bool proceed = self->_modops_progress_cb(self->_modops_user_ptr, tot, cur, param);
+    LeaveCriticalSection(&self->_modops_cb_lock);
+
+    if(!proceed)
       self->abortModOps();
+  }
 
   return !self->_modops_abort;
 }
@@ -2146,28 +3819,8 @@ int32_t OmModChan::indexOfNetpack(const OmNetPack* NetPack) const
 ///
 void OmModChan::_get_missing_depends(const OmModPack* ModPack, OmWStringArray* missings) const
 {
-  for(size_t i = 0; i < ModPack->dependCount(); ++i) {
-
-    bool is_missing = true;
-
-    for(size_t m = 0; m < this->_modpack_list.size(); ++m) {
-
-      // ignore directory Mods
-      if(this->_modpack_list[m]->sourceIsDir())
-        continue;
-
-      if(ModPack->getDependIden(i) == this->_modpack_list[m]->iden()) {
-
-        this->_get_missing_depends(ModPack, missings);
-
-        is_missing = false;
-        break;
-      }
-    }
-
-    if(is_missing)
-      Om_push_backUnique(*missings, ModPack->getDependIden(i));
-  }
+  OmIndexArray closure;
+  this->_depgraph_closure(ModPack, &closure, missings);
 }
 
 ///
@@ -2358,8 +4011,10 @@ void OmModChan::startDownloads(const OmPNetPackArray& selection, Om_beginCb begi
   this->_download_abort = false;
 
   // add to queue
+  EnterCriticalSection(&this->_download_lock);
   for(size_t i = 0; i < selection.size(); ++i)
     Om_push_backUnique(this->_download_queue, selection[i]);
+  LeaveCriticalSection(&this->_download_lock);
 
   // starts queued downloads (according current limits)
   this->_download_srart_queued();
@@ -2371,14 +4026,20 @@ void OmModChan::startDownloads(const OmPNetPackArray& selection, Om_beginCb begi
 void OmModChan::stopDownloads()
 {
   // flush download queue
+  EnterCriticalSection(&this->_download_lock);
+
   while(this->_download_queue.size()) {
 
     OmNetPack* NetPack = this->_download_queue.front();
 
+    this->_download_queue.pop_front();
+
+    LeaveCriticalSection(&this->_download_lock);
+
     if(this->_download_result_cb) // call result callback with error
       this->_download_result_cb(this->_download_user_ptr, OM_RESULT_ABORT, reinterpret_cast<uint64_t>(NetPack));
 
-    this->_download_queue.pop_front();
+    EnterCriticalSection(&this->_download_lock);
   }
 
   // start sequential stops of running downloads
@@ -2392,6 +4053,8 @@ void OmModChan::stopDownloads()
     // through the result callback
     this->_download_array.back()->stopDownload();
   }
+
+  LeaveCriticalSection(&this->_download_lock);
 }
 
 ///
@@ -2407,69 +4070,43 @@ void OmModChan::stopDownload(size_t index)
 ///
 void OmModChan::_download_srart_queued()
 {
-  // prevent simultaneous startings
-  if(!this->_download_start_hth) {
-    this->_download_start_hth = Om_threadCreate(OmModChan::_download_start_run_fn, this);
-    this->_download_start_hwo = Om_threadWaitEnd(this->_download_start_hth, OmModChan::_download_start_end_fn, this);
-  }
-}
+  // downloads are started right away as long as slots are available, the
+  // next ones are started from result callback once a download ended
+  while(true) {
 
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-DWORD WINAPI OmModChan::_download_start_run_fn(void* ptr)
-{
-  OmModChan* self = static_cast<OmModChan*>(ptr);
+    EnterCriticalSection(&this->_download_lock);
 
-  while(self->_download_queue.size()) {
+    if(this->_download_queue.empty() || this->_download_abort) {
+      LeaveCriticalSection(&this->_download_lock);
+      break;
+    }
 
-    if(self->_down_max_thread > 0) {
-      if(self->_download_array.size() >= self->_down_max_thread) {
-        Sleep(250);
-        continue;
+    if(this->_down_max_thread > 0) {
+      if(this->_download_array.size() >= this->_down_max_thread) {
+        LeaveCriticalSection(&this->_download_lock);
+        break;
       }
     }
 
-    OmNetPack* NetPack = self->_download_queue.front();
+    OmNetPack* NetPack = this->_download_queue.front();
 
-    // add download to stack
-    Om_push_backUnique(self->_download_array, NetPack);
+    this->_download_queue.pop_front();
 
-    if(self->_download_begin_cb)
-      self->_download_begin_cb(self->_download_user_ptr, reinterpret_cast<uint64_t>(NetPack));
+    // add download to stack
+    Om_push_backUnique(this->_download_array, NetPack);
 
-    // start download
-    if(!NetPack->startDownload(OmModChan::_download_download_fn, OmModChan::_download_result_fn, self, self->_down_max_rate)) {
+    LeaveCriticalSection(&this->_download_lock);
 
-      if(self->_download_result_cb) // call result callback with error
-        self->_download_result_cb(self->_download_user_ptr, OM_RESULT_ERROR, reinterpret_cast<uint64_t>(NetPack));
-    }
+    if(this->_download_begin_cb)
+      this->_download_begin_cb(this->_download_user_ptr, reinterpret_cast<uint64_t>(NetPack));
 
-    self->_download_queue.pop_front();
+    // start download, it is performed by the shared transfer engine
+    if(!NetPack->startDownload(OmModChan::_download_download_fn, OmModChan::_download_result_fn, this, this->_down_max_rate)) {
 
-    // wait a bit to prevent flood
-    Sleep(250);
+      // remove from stack and call result callback with error
+      OmModChan::_download_result_fn(this, OM_RESULT_ERROR, reinterpret_cast<uint64_t>(NetPack));
+    }
   }
-
-  return 0;
-}
-
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-VOID WINAPI OmModChan::_download_start_end_fn(void* ptr, uint8_t fired)
-{
-  OM_UNUSED(fired);
-
-  OmModChan* self = static_cast<OmModChan*>(ptr);
-
-  // unlock the local library
-  self->_locked_mod_library = false;
-
-  Om_threadClear(self->_download_start_hth, self->_download_start_hwo);
-
-  self->_download_start_hth = nullptr;
-  self->_download_start_hwo = nullptr;
 }
 
 ///
@@ -2480,11 +4117,15 @@ bool OmModChan::_download_download_fn(void* ptr, int64_t tot, int64_t cur, int64
   OmModChan* self = static_cast<OmModChan*>(ptr);
 
   // update global progress
+  EnterCriticalSection(&self->_download_lock);
+
   double queue_percents = self->_download_dones * 100;
   for(size_t i = 0; i < self->_download_array.size(); ++i)
     queue_percents += self->_download_array[i]->downloadProgress();
 
   self->_download_percent = queue_percents / (self->_download_dones + self->_download_array.size() + self->_download_queue.size());
+
+  LeaveCriticalSection(&self->_download_lock);
 
   if(self->_download_download_cb)
     if(!self->_download_download_cb(self->_download_user_ptr, tot, cur, rate, param))
@@ -2525,24 +4166,34 @@ void OmModChan::_download_result_fn(void* ptr, OmResult result, uint64_t param)
   self->refreshNetLibrary();
 
   // remove download from stack
+  EnterCriticalSection(&self->_download_lock);
+
   Om_eraseValue(self->_download_array, NetPack);
 
   // increase download done count
   self->_download_dones++;
 
+  LeaveCriticalSection(&self->_download_lock);
+
   // call client callback
   if(self->_download_result_cb)
     self->_download_result_cb(self->_download_user_ptr, final_result, param);
 
-  if(self->_download_array.size()) {
+  // a slot is now free, start next queued download
+  self->_download_srart_queued();
 
-    // if abort request was fired, we must stop downloads sequentially to
-    // prevent callback concurrent calls that mess up all process
-    if(self->_download_abort) {
-      self->_download_array.back()->stopDownload();
-    }
+  EnterCriticalSection(&self->_download_lock);
 
-  } else {
+  bool ended = self->_download_array.empty() && self->_download_queue.empty();
+
+  // if abort request was fired, we must stop downloads sequentially to
+  // prevent callback concurrent calls that mess up all process
+  if(self->_download_array.size() && self->_download_abort)
+    self->_download_array.back()->stopDownload();
+
+  LeaveCriticalSection(&self->_download_lock);
+
+  if(ended) {
 
     self->_locked_net_library = false;
 
@@ -3039,6 +4690,9 @@ void OmModChan::removeRepository(size_t index)
 
   OmNetRepo* NetRepo = this->_repository_list[index];
 
+  // forget cached query response
+  NetRepo->deleteQueryCache();
+
   // get <network> node
 
   if(this->_xml.hasChild(L"network")) {
@@ -3073,12 +4727,26 @@ void OmModChan::removeRepository(size_t index)
   this->_repository_list.erase(this->_repository_list.begin() + index);
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+size_t OmModChan::queriesQueueSize() const
+{
+  EnterCriticalSection(&this->_query_lock);
+
+  size_t size = this->_query_queue.size() + this->_query_array.size();
+
+  LeaveCriticalSection(&this->_query_lock);
+
+  return size;
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
 void OmModChan::abortQueries()
 {
-  if(this->_query_queue.size()) {
+  if(this->queriesQueueSize()) {
 
     this->_query_abort = true;
 
@@ -3093,7 +4761,7 @@ void OmModChan::abortQueries()
 ///
 void OmModChan::queueQueries(const OmPNetRepoArray& selection, Om_beginCb begin_cb, Om_resultCb result_cb, Om_notifyCb notify_cb, void* user_ptr)
 {
-  if(this->_query_queue.empty()) {
+  if(this->queriesQueueSize() == 0) {
 
     // another operation is currently processing
     if(this->_locked_net_library) {
@@ -3130,8 +4798,10 @@ void OmModChan::queueQueries(const OmPNetRepoArray& selection, Om_beginCb begin_
   // lock the network library to prevent concurrent array manipulation
   this->_locked_net_library = true;
 
+  EnterCriticalSection(&this->_query_lock);
   for(size_t i = 0; i < selection.size(); ++i)
     this->_query_queue.push_back(selection[i]);
+  LeaveCriticalSection(&this->_query_lock);
 
   // reset abort stat
   this->_query_abort = false;
@@ -3159,22 +4829,81 @@ DWORD WINAPI OmModChan::_query_run_fn(void* ptr)
 
   DWORD exit_code = 0;
 
-  while(self->_query_queue.size()) {
+  // define worker threads count according fan-out limit
+  EnterCriticalSection(&self->_query_lock);
+  size_t thread_cnt = self->_query_queue.size();
+  LeaveCriticalSection(&self->_query_lock);
+
+  if(self->_query_max_thread > 0 && thread_cnt > self->_query_max_thread) thread_cnt = self->_query_max_thread;
+  if(thread_cnt > QUERY_MAX_THREADS) thread_cnt = QUERY_MAX_THREADS;
+
+  HANDLE hth[QUERY_MAX_THREADS];
+  DWORD hth_cnt = 0;
+
+  // a single query is not worth a thread
+  if(thread_cnt > 1) {
+    for(size_t t = 0; t < thread_cnt; ++t) {
+      hth[hth_cnt] = Om_threadCreate(OmModChan::_query_work_fn, self);
+      if(hth[hth_cnt]) hth_cnt++;
+    }
+  }
+
+  if(hth_cnt) {
+
+    WaitForMultipleObjects(hth_cnt, hth, true, INFINITE);
+
+    for(DWORD t = 0; t < hth_cnt; ++t)
+      CloseHandle(hth[t]);
+  }
+
+  // process remaining queries in current thread, if any
+  OmModChan::_query_work_fn(self);
+
+  #ifdef DEBUG
+  std::wcout << "DEBUG => OmModChan::_query_run : leave\n";
+  #endif // DEBUG
+
+  return exit_code;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+DWORD WINAPI OmModChan::_query_work_fn(void* ptr)
+{
+  OmModChan* self = static_cast<OmModChan*>(ptr);
+
+  while(true) {
+
+    EnterCriticalSection(&self->_query_lock);
+
+    if(self->_query_queue.empty()) {
+      LeaveCriticalSection(&self->_query_lock);
+      break;
+    }
 
     OmNetRepo* NetRepo = self->_query_queue.front();
 
-    // FIXME: Je ne pense que cette partie est inutile, le verifier
+    self->_query_queue.pop_front();
+
+    if(!self->_query_abort)
+      self->_query_array.push_back(NetRepo);
+
+    LeaveCriticalSection(&self->_query_lock);
+
+    // callbacks are called by one worker at a time
+    EnterCriticalSection(&self->_query_cb_lock);
+
     if(self->_query_abort) {
 
       // update queue progress before sending result
       self->_query_dones = 0; self->_query_percent = 0;
 
       // flush all queue with abort result
-
       if(self->_query_result_cb)
         self->_query_result_cb(self->_query_user_ptr, OM_RESULT_ABORT, reinterpret_cast<uint64_t>(NetRepo));
 
-      self->_query_queue.pop_front();
+      LeaveCriticalSection(&self->_query_cb_lock);
 
       continue;
     }
@@ -3182,89 +4911,159 @@ DWORD WINAPI OmModChan::_query_run_fn(void* ptr)
     if(self->_query_begin_cb)
       self->_query_begin_cb(self->_query_user_ptr, reinterpret_cast<uint64_t>(NetRepo));
 
+    LeaveCriticalSection(&self->_query_cb_lock);
+
+    // performed concurrently with other workers
     OmResult result = NetRepo->query();
 
-    if(result == OM_RESULT_OK) {
+    // merge to Network Library as soon as query completes
+    EnterCriticalSection(&self->_query_cb_lock);
+
+    self->_query_merge(NetRepo, result);
+
+    LeaveCriticalSection(&self->_query_cb_lock);
+  }
+
+  return 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_query_merge(OmNetRepo* NetRepo, OmResult result)
+{
+  this->_query_added = 0;
+  this->_query_changed = 0;
+  this->_query_removed = 0;
 
-      // update repository title if possible
-      if(!NetRepo->title().empty()) {
+  if(result == OM_RESULT_OK) {
+
+    // update repository title if possible
+    if(!NetRepo->title().empty()) {
 
-        OmXmlNodeArray repository_nodes;
-        self->_xml.child(L"network").children(repository_nodes, L"repository");
+      OmXmlNodeArray repository_nodes;
+      this->_xml.child(L"network").children(repository_nodes, L"repository");
 
-        for(size_t i = 0; i < repository_nodes.size(); ++i) {
-          if(repository_nodes[i].attrAsString(L"base") == NetRepo->base()) {
-            if(repository_nodes[i].attrAsString(L"name") == NetRepo->name()) {
-              repository_nodes[i].setAttr(L"title", NetRepo->title()); break;
-            }
+      for(size_t i = 0; i < repository_nodes.size(); ++i) {
+        if(repository_nodes[i].attrAsString(L"base") == NetRepo->base()) {
+          if(repository_nodes[i].attrAsString(L"name") == NetRepo->name()) {
+            repository_nodes[i].setAttr(L"title", NetRepo->title()); break;
           }
         }
-
-        self->_xml.save();
       }
 
-      // Add or Merge Repository referenced Mods to list
+      this->_xml.save();
+    }
+
+    // Merge Repository referenced Mods to list, only what changed
+
+    // 1. index current Network Library by Mod identity
+    std::unordered_map<OmWString, size_t> iden_map;
+    iden_map.reserve(this->_netpack_list.size() + NetRepo->referenceCount());
+
+    for(size_t i = 0; i < this->_netpack_list.size(); ++i)
+      iden_map[this->_netpack_list[i]->iden()] = i;
+
+    // Net Packs still referenced by this Repository
+    std::vector<bool> keep_list(this->_netpack_list.size(), false);
+
+    // whether Net Packs list order must be rebuilt
+    bool need_rebuild = false;
+
+    // 2. add, replace or keep referenced Mods in lists
+    for(size_t r = 0; r < NetRepo->referenceCount(); ++r) {
+
+      const OmXmlNode& ref_node = NetRepo->getReference(r);
+
+      std::unordered_map<OmWString, size_t>::iterator it = iden_map.find(ref_node.attrAsString(L"ident"));
 
-      // 1. remove / clear reference that previously belong this Repository
-      size_t net_size = self->_netpack_list.size();
-      while(net_size--) {
-        if(self->_netpack_list[net_size]->NetRepo() == NetRepo) {
-          delete self->_netpack_list[net_size];
-          self->_netpack_list.erase(self->_netpack_list.begin() + net_size);
+      if(it != iden_map.end()) {
+
+        OmNetPack* PrevPack = this->_netpack_list[it->second];
+
+        if(PrevPack->NetRepo() != NetRepo) {
+
+          // Mod referenced by several Repositories is owned by the first one
+          // in Repositories list, regardless which answered first
+          if(this->indexOfRepository(PrevPack->NetRepo()) < this->indexOfRepository(NetRepo))
+            continue;
+
+        } else {
+
+          // unchanged reference, keep the existing object and its states
+          if(PrevPack->refHash() == OmNetPack::getReferenceHash(NetRepo, ref_node)) {
+            keep_list[it->second] = true; continue;
+          }
         }
       }
 
-      // 2. parse and add referenced Mods in lists
-      for(size_t r = 0; r < NetRepo->referenceCount(); ++r) {
+      OmNetPack* NetPack = new OmNetPack(this);
 
-        OmNetPack* NetPack = new OmNetPack(self);
+      if(NetPack->parseReference(NetRepo, r)) {
 
-        if(NetPack->parseReference(NetRepo, r)) {
+        if(it != iden_map.end()) {
 
-          // we want to be sure Net Pack is unique in list
-          bool is_unique = true;
+          OmNetPack* PrevPack = this->_netpack_list[it->second];
 
-          for(size_t j = 0; j < self->_netpack_list.size(); ++j) {
+          if(PrevPack->hash() != NetPack->hash())
+            need_rebuild = true;
 
-            if(self->_netpack_list[j]->iden() == NetPack->iden()) {
+          delete PrevPack; //< remove previous
+          this->_netpack_list[it->second] = NetPack; //< replace object
+          keep_list[it->second] = true;
 
-              delete self->_netpack_list[j]; //< remove previous
-              self->_netpack_list[j] = NetPack; //< replace object
-              is_unique = false; break;
-            }
-          }
+          this->_query_changed++;
 
-          if(is_unique)
-            self->_netpack_list.push_back(NetPack);
+          if(!need_rebuild && this->_netpack_notify_cb)
+            this->_netpack_notify_cb(this->_netpack_notify_ptr, OM_NOTIFY_ALTERED, NetPack->hash());
 
         } else {
 
-          self->_log(OM_LOG_WRN, L"queryNetRepository", NetPack->lastError());
-          delete NetPack;
+          iden_map[NetPack->iden()] = this->_netpack_list.size();
+          this->_netpack_list.push_back(NetPack);
+          keep_list.push_back(true);
+
+          this->_query_added++;
         }
-      }
-
-      self->sortNetLibrary(); //< this will send rebuild notification
-
-      self->refreshNetLibrary();
 
+      } else {
+
+        this->_log(OM_LOG_WRN, L"queryNetRepository", NetPack->lastError());
+        delete NetPack;
+      }
     }
 
-    // update queue progress before sending result
-    self->_query_dones++;
-    self->_query_percent = static_cast<double>(self->_query_dones * 100) / (self->_query_dones + self->_query_queue.size());
+    // 3. remove references that no longer belong this Repository
+    size_t net_size = this->_netpack_list.size();
+    while(net_size--) {
+      if(!keep_list[net_size] && this->_netpack_list[net_size]->NetRepo() == NetRepo) {
+        delete this->_netpack_list[net_size];
+        this->_netpack_list.erase(this->_netpack_list.begin() + net_size);
+        this->_query_removed++;
+      }
+    }
 
-    if(self->_query_result_cb)
-      self->_query_result_cb(self->_query_user_ptr, result, reinterpret_cast<uint64_t>(NetRepo));
+    if(this->_query_added || this->_query_removed || need_rebuild)
+      this->sortNetLibrary(); //< this will send rebuild notification
 
-    self->_query_queue.pop_front();
+    if(this->_query_added || this->_query_changed || this->_query_removed)
+      this->refreshNetLibrary();
   }
 
-  #ifdef DEBUG
-  std::wcout << "DEBUG => OmModChan::_query_run : leave\n";
-  #endif // DEBUG
+  // update queue progress before sending result
+  EnterCriticalSection(&this->_query_lock);
 
-  return exit_code;
+  this->_query_dones++;
+  this->_query_percent = static_cast<double>(this->_query_dones * 100) / (this->_query_dones + this->_query_queue.size() + this->_query_array.size() - 1);
+
+  LeaveCriticalSection(&this->_query_lock);
+
+  if(this->_query_result_cb)
+    this->_query_result_cb(this->_query_user_ptr, result, reinterpret_cast<uint64_t>(NetRepo));
+
+  EnterCriticalSection(&this->_query_lock);
+  Om_eraseValue(this->_query_array, NetRepo);
+  LeaveCriticalSection(&this->_query_lock);
 }
 
 ///
@@ -3290,6 +5089,7 @@ VOID WINAPI OmModChan::_query_end_fn(void* ptr, uint8_t fired)
   self->_query_hwo = nullptr;
 
   self->_query_queue.clear();
+  self->_query_array.clear();
 
   // call notify callback
   if(self->_query_notify_cb)
@@ -3621,6 +5421,28 @@ void OmModChan::setLibraryShowhidden(bool enable)
   this->reloadModLibrary();
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::setInstallMode(int32_t mode)
+{
+  if(!this->_xml.valid())
+    return;
+
+  if(mode < OM_INSTALL_COPY || mode > OM_INSTALL_AUTO)
+    mode = OM_INSTALL_COPY;
+
+  this->_install_mode = mode;
+
+  if(this->_xml.hasChild(L"install_mode")) {
+    this->_xml.child(L"install_mode").setAttr(L"mode", this->_install_mode);
+  } else {
+    this->_xml.addChild(L"install_mode").setAttr(L"mode", this->_install_mode);
+  }
+
+  this->_xml.save();
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -3754,6 +5576,25 @@ void OmModChan::setBackupComp(int32_t method, int32_t level)
   this->_xml.save();
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::setBackupDedup(bool enable)
+{
+  if(!this->_xml.valid())
+    return;
+
+  this->_backup_dedup = enable;
+
+  if(this->_xml.hasChild(L"backup_dedup")) {
+    this->_xml.child(L"backup_dedup").setAttr(L"enable", this->_backup_dedup ? 1 : 0);
+  } else {
+    this->_xml.addChild(L"backup_dedup").setAttr(L"enable", this->_backup_dedup ? 1 : 0);
+  }
+
+  this->_xml.save();
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -3892,15 +5733,91 @@ void OmModChan::setDownLimits(uint32_t rate, uint32_t thread)
   this->_xml.save();
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::setQueryLimits(uint32_t thread)
+{
+  if(!this->_xml.valid())
+    return;
+
+  this->_query_max_thread = thread;
+
+  OmXmlNode network_node;
+
+  if(this->_xml.hasChild(L"network")) {
+    network_node = this->_xml.child(L"network");
+  } else {
+    network_node = this->_xml.addChild(L"network");
+  }
+
+  OmXmlNode limits_node;
+
+  if(network_node.hasChild(L"query_limits")) {
+    limits_node = network_node.child(L"query_limits");
+  } else {
+    limits_node = network_node.addChild(L"query_limits");
+  }
+
+  limits_node.setAttr(L"thread", static_cast<int>(this->_query_max_thread));
+
+  this->_xml.save();
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
 void OmModChan::_log(unsigned level, const OmWString& origin,  const OmWString& detail) const
 {
   OmWString root(L"ModChan["); root.append(this->_title); root.append(L"].");
+
+  // concurrent Mod operations and Library parsing workers log from their
+  // own thread, deferral state is checked under lock, escalated logs are
+  // serialized by Mod Manager
+  EnterCriticalSection(&this->_log_defer_lock);
+
+  if(this->_log_defer) {
+
+    this->_log_defer_lvl.push_back(level);
+    this->_log_defer_org.push_back(root + origin);
+    this->_log_defer_dtl.push_back(detail);
+
+    LeaveCriticalSection(&this->_log_defer_lock);
+
+    return;
+  }
+
+  LeaveCriticalSection(&this->_log_defer_lock);
+
   this->_Modhub->escalateLog(level, root + origin, detail);
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModChan::_defer_log(bool enable)
+{
+  EnterCriticalSection(&this->_log_defer_lock);
+
+  this->_log_defer = enable;
+
+  // held back logs are taken out under lock, workers may still be logging
+  OmIndexArray defer_lvl;
+  OmWStringArray defer_org, defer_dtl;
+
+  if(!enable) {
+    defer_lvl.swap(this->_log_defer_lvl);
+    defer_org.swap(this->_log_defer_org);
+    defer_dtl.swap(this->_log_defer_dtl);
+  }
+
+  LeaveCriticalSection(&this->_log_defer_lock);
+
+  // forward held back logs in order they were produced
+  for(size_t i = 0; i < defer_lvl.size(); ++i)
+    this->_Modhub->escalateLog(defer_lvl[i], defer_org[i], defer_dtl[i]);
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -52,7 +52,8 @@ OmModMan::OmModMan() :
   _icon_size(16),
   _no_markdown(false)
 {
-
+  // log may be written by worker threads
+  InitializeCriticalSection(&this->_log_lock);
 }
 
 ///
@@ -67,6 +68,8 @@ OmModMan::~OmModMan()
   if(this->_log_hfile) {
     CloseHandle(this->_log_hfile);
   }
+
+  DeleteCriticalSection(&this->_log_lock);
 }
 
 ///
@@ -1055,6 +1058,8 @@ void OmModMan::notifyNetLibraryStop()
 ///
 void OmModMan::addLogNotify(Om_notifyCb notify_cb, void* user_ptr)
 {
+  EnterCriticalSection(&this->_log_lock);
+
   if(!Om_arrayContain(this->_log_notify_cb, notify_cb)) {
 
     this->_log_notify_cb.push_back(notify_cb);
@@ -1062,6 +1067,8 @@ void OmModMan::addLogNotify(Om_notifyCb notify_cb, void* user_ptr)
     this->_log_user_ptr.push_back(user_ptr);
 
   }
+
+  LeaveCriticalSection(&this->_log_lock);
 }
 
 
@@ -1070,6 +1077,8 @@ void OmModMan::addLogNotify(Om_notifyCb notify_cb, void* user_ptr)
 ///
 void OmModMan::removeLogNotify(Om_notifyCb notify_cb)
 {
+  EnterCriticalSection(&this->_log_lock);
+
   for(size_t i = 0; i < this->_log_notify_cb.size(); ++i) {
 
     if(this->_log_notify_cb[i] == notify_cb) {
@@ -1081,6 +1090,22 @@ void OmModMan::removeLogNotify(Om_notifyCb notify_cb)
       break;
     }
   }
+
+  LeaveCriticalSection(&this->_log_lock);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmWString OmModMan::currentLog() const
+{
+  EnterCriticalSection(&this->_log_lock);
+
+  OmWString log_str = this->_log_str;
+
+  LeaveCriticalSection(&this->_log_lock);
+
+  return log_str;
 }
 
 ///
@@ -1114,14 +1139,15 @@ void OmModMan::_log(unsigned level, const OmWString& origin, const OmWString& de
 
   log_entry += L"\r\n";
 
+  // log is written from worker threads too, callbacks are called outside
+  // the lock since they may send messages to UI thread which may be
+  // logging meanwhile
+  EnterCriticalSection(&this->_log_lock);
+
   #ifdef DEBUG
   std::wcout << log_entry; //< print to standard output
   #endif
 
-  // send new log to callback functions
-  for(size_t i = 0; i < this->_log_notify_cb.size(); ++i)
-    this->_log_notify_cb[i](this->_log_user_ptr[i], OM_NOTIFY_CREATED, reinterpret_cast<uint64_t>(log_entry.c_str()));
-
   // write to log file
   if(this->_log_hfile) {
 
@@ -1133,6 +1159,15 @@ void OmModMan::_log(unsigned level, const OmWString& origin, const OmWString& de
   }
 
   this->_log_str += log_entry;
+
+  OmNotifyCbArray notify_cb = this->_log_notify_cb;
+  OmPVoidArray user_ptr = this->_log_user_ptr;
+
+  LeaveCriticalSection(&this->_log_lock);
+
+  // send new log to callback functions
+  for(size_t i = 0; i < notify_cb.size(); ++i)
+    notify_cb[i](user_ptr[i], OM_NOTIFY_CREATED, reinterpret_cast<uint64_t>(log_entry.c_str()));
 }
 
 ///
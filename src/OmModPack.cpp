@@ -25,7 +25,10 @@
 #include "OmUtilHsh.h"
 #include "OmUtilPkg.h"
 #include "OmUtilB64.h"
+#include "OmUtilZip.h"
 #include <ctime>
+#include <algorithm>          //< std::sort
+#include <unordered_set>
 
 #include "OmModChan.h"
 
@@ -85,952 +88,2517 @@ static void __parse_source_dir(OmModEntryArray* ent_ls, const OmWString& orig, c
   FindClose(hnd);
 }
 
-
+/// \brief Read archive entry to string
 ///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+/// Read archive entry data to string through streamed reading by chunks.
 ///
-OmModPack::OmModPack() :
-  _ModChan(nullptr),
-  _hash(0),
-  _has_src(false),
-  _src_isdir(false),
-  _has_bck(false),
-  _bck_isdir(false),
-  _is_overlapped(false),
-  _op_backup(false),
-  _op_restore(false),
-  _op_apply(false),
-  _op_progress(0)
+/// \param[in]  zip      : Archive object opened for reading
+/// \param[in]  i        : Entry index in archive
+/// \param[out] data     : String object to be filled with entry data
+/// \param[out] error    : Error string in case of failure
+///
+/// \return True if operation succeed, false otherwise
+///
+static bool __read_zip_entry(const OmArchive& zip, size_t i, OmCString* data, OmWString* error)
 {
+  data->clear();
 
+  uint64_t entry_size = zip.entrySize(i);
+
+  if(!zip.entryReadOpen(i)) {
+    *error = zip.lastErrorStr();
+    return false;
+  }
+
+  data->reserve(entry_size);
+
+  size_t chunk = 65536;
+
+  while(true) {
+
+    size_t used = data->size();
+    data->resize(used + chunk);
+
+    int64_t rb = zip.entryRead(&(*data)[used], chunk);
+    if(rb < 0) {
+      *error = zip.lastErrorStr();
+      zip.entryClose();
+      data->clear(); return false;
+    }
+
+    data->resize(used + rb);
+
+    if(rb == 0)
+      break;
+  }
+
+  if(!zip.entryClose()) {
+    *error = zip.lastErrorStr();
+    data->clear(); return false;
+  }
+
+  return true;
 }
 
+/// \brief Maximum apply threads
 ///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+/// Maximum count of worker threads used to extract or copy Source
+/// files to Target during Mod install.
 ///
-OmModPack::OmModPack(OmModChan* ModChan) :
-  _ModChan(ModChan),
-  _hash(0),
-  _has_src(false),
-  _src_isdir(false),
-  _has_bck(false),
-  _bck_isdir(false),
-  _is_overlapped(false),
-  _op_backup(false),
-  _op_restore(false),
-  _op_apply(false),
-  _op_progress(0)
+#define APPLY_MAX_THREADS       8
+
+/// \brief Apply job structure
+///
+/// Structure to describe a single file to be extracted or copied to
+/// Target by apply worker threads.
+///
+typedef struct apply_job_
 {
+  uint64_t        size;   //< Source file size, for scheduling
+  uint32_t        index;  //< Source entry index
 
-}
+} apply_job_t;
+
+/// \brief Apply context structure
+///
+/// Shared context for apply worker threads, each worker owns its own
+/// Source archive reader and pulls jobs from the shared queue.
+///
+typedef struct apply_context_
+{
+  const OmModEntryArray*    entries;    //< Source entries list
+
+  std::vector<apply_job_t>  queue;      //< Jobs queue, largest files first
+
+  OmWString                 src_path;   //< Source archive path
+
+  OmWString                 src_root;   //< Source directory root
+
+  bool                      src_isdir;  //< Source is directory
+
+  OmWString                 tgt_root;   //< Target directory root
+
+  int32_t                   inst_mode;  //< Directory Source install mode
+
+  volatile LONG             can_link;   //< Hard links still worth trying
+
+  volatile LONG             can_clone;  //< Clone still worth trying
+
+  volatile LONG64           bytes_skip; //< Bytes left untouched in Target
+
+  volatile LONG64           bytes_done; //< Bytes written to Target
+
+  volatile LONG             next;       //< Next job to be processed
+
+  volatile LONG             done;       //< Processed jobs count
+
+  volatile LONG             abort;      //< Abort requested
+
+  CRITICAL_SECTION          lock;       //< Error report lock
+
+  OmWString                 error;      //< First encountered error
+
+} apply_context_t;
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-OmModPack::~OmModPack()
+static bool __apply_job_compare(const apply_job_t& a, const apply_job_t& b)
 {
+  // largest first, then keep Source order
+  if(a.size != b.size)
+    return (a.size > b.size);
 
+  return (a.index < b.index);
 }
 
+/// \brief Directory cache structure
 ///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+/// Operation-scoped set of directories known to exist under a root, so
+/// trees are created once and per-file existence checks are skipped.
+/// Counters keep track of file system calls actually performed.
 ///
-void OmModPack::clearAll()
+typedef struct dir_cache_
 {
-  // Source and Backup sides
-  this->clearSource();
-  this->clearBackup();
+  OmWString                     root;     //< Root directory, must exist
 
-  // General properties
-  this->_iden.clear();
-  this->_hash = 0;
-  this->_core.clear();
-  this->_name.clear();
-  this->_version.clear();
+  bool                          fresh;    //< Root was just created, thus empty
 
-  this->_op_backup = false;
-  this->_op_restore = false;
-  this->_op_apply = false;
-  this->_op_progress = 0;
-}
+  std::unordered_set<uint64_t>  known;    //< Existing directories path hashes
 
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-bool OmModPack::refreshAnalytics()
-{
-  bool has_changes = false;
-
-  // check for overlapping
-  if(!this->_ModChan)
-    return false;
-
-  bool is_overlapped = false;
-
-  for(size_t i = 0; i < this->_ModChan->modpackCount(); ++i) {
-    if(this->_ModChan->getModpack(i)->hasOverlap(this->_hash)) {
-      is_overlapped = true; break;
-    }
-  }
-
-  if(is_overlapped != this->_is_overlapped)
-    has_changes = true;
-
-  this->_is_overlapped = is_overlapped;
-
-  return has_changes;
-}
+  std::unordered_set<uint64_t>  made;     //< Created directories path hashes
+
+  uint32_t                      stat_cnt; //< Existence checks performed
+
+  uint32_t                      make_cnt; //< Directories created
+
+  uint32_t                      hit_cnt;  //< Checks answered by cache
+
+  clock_t                       time;     //< Time spent in file system calls
+
+} dir_cache_t;
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModPack::clearSource()
+static void __dir_cache_init(dir_cache_t* dcache, const OmWString& root, bool fresh)
 {
-  // Package source properties
-  this->_has_src = false;
-  this->_src_time = 0;
-  this->_src_path.clear();
-  this->_src_isdir = false;
-  this->_src_root.clear();
-  this->_src_entry.clear();
-  this->_src_depend.clear();
-
-  // Optional properties liked to source
-  this->_category.clear();
-  this->_description.clear();
-  this->_description_time = 0;
-  this->_thumbnail.clear();
-  this->_thumbnail_time = 0;
-}
-
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-void OmModPack::_src_parse_dir(OmModEntryArray* entries, const OmWString& orig, const OmWString& from)
-{
-  OmWString item;
-  OmWString root;
-
-  OmModEntry_t entry;
-  entry.cdid = -1;
-
-  OmWString srch(orig);
-  srch += L"\\*";
-
-  WIN32_FIND_DATAW fd;
-  HANDLE hnd = FindFirstFileW(srch.c_str(), &fd);
-  if(hnd != INVALID_HANDLE_VALUE) {
-    do {
-      // skip this and parent folder
-      if(!wcscmp(fd.cFileName, L".")) continue;
-      if(!wcscmp(fd.cFileName, L"..")) continue;
-
-      item = from + L"\\"; item += fd.cFileName;
-
-      entry.path = item;
-
-      if(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-        entry.attr = OM_MODENTRY_DIR;
-        entries->push_back(entry);
-        // go deep in tree
-        root = orig + L"\\"; root += fd.cFileName;
-        OmModPack::_src_parse_dir(entries, root, item);
-      } else {
-        entry.attr = 0;
-        entries->push_back(entry);
-      }
-    } while(FindNextFileW(hnd, &fd));
-  }
-  FindClose(hnd);
-}
+  dcache->root = root;
+  dcache->fresh = fresh;
+  dcache->known.clear();
+  dcache->made.clear();
+  dcache->stat_cnt = 0;
+  dcache->make_cnt = 0;
+  dcache->hit_cnt = 0;
+  dcache->time = 0;
+}
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-bool OmModPack::parseSource(const OmWString& path)
+static int32_t __dir_cache_make(dir_cache_t* dcache, const OmWString& path)
 {
-  this->clearSource();
+  if(path.empty())
+    return 0;
 
-  bool isdir = false;
+  uint64_t hash = Om_getPathHash(path);
 
-  OmWString src_root, src_iden;
+  if(dcache->known.count(hash)) {
+    dcache->hit_cnt++;
+    return 0;
+  }
 
-  if(Om_isDir(path)) {
+  // parents first, they are then known for siblings
+  OmWString parent = Om_getDirPart(path);
 
-    // Parse legacy/development Mod Package directory
+  int32_t result = __dir_cache_make(dcache, parent);
+  if(result != 0)
+    return result;
 
-    isdir = true;
+  OmWString dir_path;
+  Om_concatPaths(dir_path, dcache->root, path);
 
-    //__parse_source_dir(&this->_src_entry, path, L"");
-    OmModPack::_src_parse_dir(&this->_src_entry, path, L"");
-    src_root = path;
+  // nothing can exist within a directory we just created
+  if(!dcache->fresh && (parent.empty() || !dcache->made.count(Om_getPathHash(parent)))) {
+    dcache->stat_cnt++;
+    if(Om_isDir(dir_path)) {
+      dcache->known.insert(hash);
+      return 0;
+    }
+  }
 
-    src_iden = Om_getFilePart(path);
+  dcache->make_cnt++;
+  result = Om_dirCreate(dir_path);
 
-  } else if(Om_isFileZip(path)) {
+  // another Mod operation may have created it meanwhile
+  if(result == ERROR_ALREADY_EXISTS)
+    result = 0;
 
-    // Parse compressed file Mod Package
+  if(result == 0) {
+    dcache->known.insert(hash);
+    dcache->made.insert(hash);
+  }
 
-    OmArchive source_zip;
+  return result;
+}
 
-    if(!source_zip.read(path)) {
-      this->_error(L"parseSource", Om_errLoad(L"archive file", path, source_zip.lastErrorStr()));
-      return false;
-    }
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static int32_t __dir_cache_path(dir_cache_t* dcache, const OmWString& path)
+{
+  clock_t time = clock();
 
-    // Try to find modern Mod Package XML definition file
-    OmXmlConf source_cfg;
+  int32_t result = __dir_cache_make(dcache, path);
 
-    int32_t zcd_idx;
-    OmWString zcd_path;
+  dcache->time += clock() - time;
 
-    // Search in backward since XML definition file is usually the last added
-    // in zip archive so appear at the end of Central Directory.
-    unsigned i = source_zip.entryCount();
-    while(i--) {
+  return result;
+}
 
-      source_zip.entryPath(i, zcd_path);
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static int32_t __dir_cache_tree(dir_cache_t* dcache, OmWStringArray& paths, OmWString* failed)
+{
+  clock_t time = clock();
 
-      if(Om_extensionMatches(zcd_path, OM_PKG_DEF_FILE_EXT) || Om_namesMatches(zcd_path, L"ModPack.xml")) {
+  // sorted paths come parents first, unique set is created in one pass
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
 
-        uint64_t data_len = source_zip.entrySize(i);
+  int32_t result = 0;
 
-        char* data_buf = new(std::nothrow) char[data_len+1];
-        if(!data_buf) {
-          this->_error(L"parseSource", Om_errBadAlloc(L"definition file extraction", zcd_path));
-          return false;
-        }
+  for(size_t i = 0; i < paths.size(); ++i) {
+    result = __dir_cache_make(dcache, paths[i]);
+    if(result != 0) {
+      Om_concatPaths(*failed, dcache->root, paths[i]);
+      break;
+    }
+  }
 
-        if(!source_zip.entrySave(i, data_buf)) {
-          this->_error(L"parseSource", Om_errZipExtr(L"definition file", zcd_path, source_zip.lastErrorStr()));
-          delete [] data_buf; return false;
-        }
+  dcache->time += clock() - time;
 
-        data_buf[data_len] = '\0';
+  return result;
+}
 
-        if(!source_cfg.parse(Om_toUTF16(data_buf), OM_XMAGIC_PKG)) {
-          this->_error(L"parseSource", Om_errParse(L"definition file", zcd_path, source_cfg.lastErrorStr()));
-          delete [] data_buf; return false;
-        }
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static OmWString __dir_cache_report(const dir_cache_t& dcache)
+{
+  wchar_t report_str[128];
+  swprintf(report_str, 128, L"%u directory checks, %u created, %u cached in %.3fs",
+           dcache.stat_cnt, dcache.make_cnt, dcache.hit_cnt, (double)dcache.time/CLOCKS_PER_SEC);
 
-        delete [] data_buf;
+  return OmWString(report_str);
+}
 
-        break;
-      }
-    }
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static void __apply_set_error(apply_context_t* actx, const OmWString& error)
+{
+  EnterCriticalSection(&actx->lock);
 
-    // Either we found XML definition file, or we try to parse this Package the old fashion
-    if(source_cfg.valid()) {
+  // only the first error is relevant
+  if(actx->error.empty())
+    actx->error = error;
 
-      src_root = source_cfg.child(L"install").content();
+  LeaveCriticalSection(&actx->lock);
 
-      // search for <dependencies>
-      if(source_cfg.hasChild(L"dependencies")) {
+  // stop all other workers
+  InterlockedExchange(&actx->abort, 1);
+}
 
-        OmXmlNodeArray xml_iden_ls;
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static bool __entry_unchanged(const OmModEntry_t& entry, bool src_isdir, const OmWString& src_file, const OmWString& tgt_file)
+{
+  WIN32_FILE_ATTRIBUTE_DATA attr_data;
+  if(!GetFileAttributesExW(tgt_file.c_str(), GetFileExInfoStandard, &attr_data))
+    return false;
 
-        source_cfg.child(L"dependencies").children(xml_iden_ls, L"ident");
+  if(attr_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+    return false;
 
-        for(size_t i = 0; i < xml_iden_ls.size(); ++i)
-          this->_src_depend.push_back(xml_iden_ls[i].content());
-      }
+  // size first, this discards most of modified files without reading them
+  uint64_t tgt_size = (static_cast<uint64_t>(attr_data.nFileSizeHigh) << 32) | attr_data.nFileSizeLow;
+  if(tgt_size != entry.size)
+    return false;
 
-      // search for <category>
-      if(source_cfg.hasChild(L"category")) {
-        this->_category = source_cfg.child(L"category").content();
-      }
+  if(src_isdir) {
 
-      // search for <description>
-      if(source_cfg.hasChild(L"description")) {
-        Om_toCRLF(&this->_description, source_cfg.child(L"description").content());
-      }
-
-      // search for <thumbnail>
-      if(source_cfg.hasChild(L"thumbnail")) {
-
-        OmWString mimetype, charset;
-
-        // decode the DataURI
-        size_t png_size;
-        uint8_t* png_data = Om_decodeDataUri(&png_size, mimetype, charset, source_cfg.child(L"thumbnail").content());
-
-        // load png data as thumbnail
-        if(png_data) {
-          this->_thumbnail.load(png_data, png_size);
-          Om_free(png_data);
-        }
-      }
+    // no stored checksum for directory Source, both files are hashed
+    uint64_t src_xxh, tgt_xxh;
 
-      // search for <picture> (old format, deprectated)
-      if(source_cfg.hasChild(L"picture")) {
+    if(!Om_getXXHdigest(&src_xxh, src_file) || !Om_getXXHdigest(&tgt_xxh, tgt_file))
+      return false;
 
-        zcd_path = source_cfg.child(L"picture").content();
+    return (src_xxh == tgt_xxh);
+  }
 
-        zcd_idx = source_zip.entryLocate(zcd_path);
+  // compare with CRC-32 from zip central-directory
+  uint32_t tgt_crc;
 
-        if(zcd_idx >= 0) {
+  if(!Om_getCRC32digest(&tgt_crc, tgt_file))
+    return false;
 
-          uint64_t data_len = source_zip.entrySize(zcd_idx);
+  return (tgt_crc == entry.crc);
+}
 
-          uint8_t* data_buf = new(std::nothrow) uint8_t[data_len];
-          if(data_buf) {
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static int32_t __unlink_target(const OmWString& path, bool always)
+{
+  // a Target file which is a hard link shares its data with another file
+  // (Library Source or Backup), writing in place would alter both, so the
+  // link is removed first and a new file is created in place of it.
+  if(!always && Om_fileLinkCount(path) < 2)
+    return 0;
 
-            if(source_zip.entrySave(zcd_idx, data_buf)) {
-              if(!this->_thumbnail.loadThumbnail(data_buf, data_len, OM_MODPACK_THUMB_SIZE, OM_SIZE_FILL)) {
-                this->_log(OM_LOG_WRN, L"parseSource", L"thumbnail image: "+this->_thumbnail.lastErrorStr());
-              }
-            } else {
-              this->_log(OM_LOG_WRN, L"parseSource", Om_errZipExtr(L"thumbnail image",zcd_path,source_zip.lastErrorStr()));
-            }
-            delete [] data_buf;
-          } else {
-            this->_log(OM_LOG_WRN, L"parseSource", Om_errBadAlloc(L"thumbnail image extraction",zcd_path));
-          }
-        }
-      }
+  if(!Om_isFile(path))
+    return 0;
 
-    } else {
+  return Om_fileDelete(path);
+}
 
-      // We are here with a zip file without Mod Pack XML definition, we try
-      // to parse it the old fashion, we search for data root directory named
-      // exactly the same as file name.
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static int32_t __apply_file(apply_context_t* actx, const OmWString& src, const OmWString& tgt)
+{
+  bool try_clone = (actx->inst_mode == OM_INSTALL_REFLINK || actx->inst_mode == OM_INSTALL_AUTO);
+  bool try_link = (actx->inst_mode == OM_INSTALL_HARDLINK || actx->inst_mode == OM_INSTALL_AUTO);
 
-      bool has_root = false;
+  // clone and link both require the target file to not exist
+  int32_t result = __unlink_target(tgt, try_clone || try_link);
+  if(result != 0)
+    return result;
 
-      src_root = Om_getNamePart(path);
+  if(try_clone && actx->can_clone) {
 
-      for(size_t i = 0; i < source_zip.entryCount(); ++i) {
+    if(Om_fileClone(src, tgt) == 0)
+      return 0;
 
-        source_zip.entryPath(i, zcd_path);
+    // volume does not support block cloning, do not try again
+    InterlockedExchange(&actx->can_clone, 0);
+  }
 
-        if(Om_isRootOfPath(src_root, zcd_path)) {
-          has_root = true; break;
-        }
-      }
+  if(try_link && actx->can_link) {
 
-      if(!has_root) {
-        this->_error(L"parseSource", L"\""+path+L"\": unknown or wrong Mod Pack architecture.");
-        return false;
-      }
+    if(Om_fileLink(src, tgt) == 0)
+      return 0;
 
-      // search for a readme file to use as description
-      zcd_idx = source_zip.entryLocate(L"readme.txt");
-      if(zcd_idx >= 0) {
+    // Source and Target on different volumes or file system does not
+    // support hard links, do not try again
+    InterlockedExchange(&actx->can_link, 0);
+  }
 
-        uint64_t data_len = source_zip.entrySize(zcd_idx);
+  // Copy and overwrite
+  return Om_fileCopy(src, tgt, true);
+}
 
-        char* data_buf = new(std::nothrow) char[data_len+1];
-        if(data_buf) {
-          if(source_zip.entrySave(zcd_idx, data_buf)) {
-            data_buf[data_len] = '\0';
-            this->_description = Om_toUTF16(data_buf);
-          } else {
-            this->_log(OM_LOG_WRN, L"parseSource", Om_errZipExtr(L"readme file", L"readme.txt", source_zip.lastErrorStr()));
-          }
-          delete [] data_buf;
-        } else {
-          this->_log(OM_LOG_WRN, L"parseSource", Om_errBadAlloc(L"readme file extraction", L"readme.txt"));
-        }
-      }
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static DWORD WINAPI __apply_run_fn(void* ptr)
+{
+  apply_context_t* actx = static_cast<apply_context_t*>(ptr);
+
+  // each worker owns its own archive reader
+  OmArchive source_zip;
+
+  if(!actx->src_isdir) {
+    if(!source_zip.read(actx->src_path, OM_READER_MAPPED)) {
+      __apply_set_error(actx, Om_errLoad(L"Source archive file", actx->src_path, source_zip.lastErrorStr()));
+      return 1;
     }
+    // Target tree was created beforehand
+    source_zip.setSaveTree(false);
+  }
 
-    // Mod Pack appear valid, now we gather all Mod entries
-    for(size_t i = 0; i < source_zip.entryCount(); ++i) {
+  OmWString tgt_file, src_file;
 
-      source_zip.entryPath(i, zcd_path);
+  while(!actx->abort) {
 
-      OmModEntry_t entry;
+    // pick next job in queue
+    LONG n = InterlockedIncrement(&actx->next) - 1;
+    if(n >= static_cast<LONG>(actx->queue.size()))
+      break;
 
-      if(Om_getRelativePath(&entry.path, src_root, zcd_path)) {
+    const OmModEntry_t& entry = actx->entries->at(actx->queue[n].index);
 
-        entry.cdid = i;
+    Om_concatPaths(tgt_file, actx->tgt_root, entry.path);
 
-        if(source_zip.entryIsDir(i)) {
-          entry.attr = OM_MODENTRY_DIR;
-        } else {
-          entry.attr = 0;
-        }
+    if(actx->src_isdir)
+      Om_concatPaths(src_file, actx->src_root, entry.path);
 
-        this->_src_entry.push_back(entry);
-      }
+    // Target already holds the same content, nothing to write
+    if(__entry_unchanged(entry, actx->src_isdir, src_file, tgt_file)) {
+      InterlockedExchangeAdd64(&actx->bytes_skip, entry.size);
+      InterlockedIncrement(&actx->done);
+      continue;
     }
 
-    src_iden = Om_getNamePart(path);
+    if(actx->src_isdir) {
 
-  } else {
-    this->_error(L"parseSource", L"unknown or wrong file type \""+path+L"\"");
-    return false;
-  }
+      // copy, clone or link according install mode
+      int32_t result = __apply_file(actx, src_file, tgt_file);
+      if(result != 0) {
+        __apply_set_error(actx, Om_errCopy(L"Source file to Target", tgt_file, result));
+        break;
+      }
 
-  uint64_t src_hash = Om_getXXHash3(Om_getFilePart(path));
+    } else {
 
-  // ultimately check against already parsed data from the Source
-  if(this->_has_bck) {
+      // do not write through an existing hard link
+      int32_t result = __unlink_target(tgt_file, false);
+      if(result != 0) {
+        __apply_set_error(actx, Om_errDelete(L"linked file in Target", tgt_file, result));
+        break;
+      }
 
-    if(src_hash != this->_hash || this->_iden != src_iden) {
-      this->_error(L"parseSource", L"parsed Source mismatch already parsed Backup \""+path+L"\"");
-      return false;
+      // extract to destination
+      if(!source_zip.entrySave(entry.cdid, tgt_file)) {
+        __apply_set_error(actx, Om_errZipExtr(L"Source file to Target", tgt_file, source_zip.lastErrorStr()));
+        break;
+      }
     }
 
-  } else {
+    InterlockedExchangeAdd64(&actx->bytes_done, entry.size);
+    InterlockedIncrement(&actx->done);
 
-    this->_hash = src_hash;
+    #ifdef DEBUG
+    Sleep(50); //< for debug
+    #endif
+  }
 
-    this->_iden = src_iden;
+  if(!actx->src_isdir) source_zip.close();
 
-    // parse other Mod common infos from identity
-    OmWString vers_str;
-    if(Om_parseModIdent(this->_iden, &this->_core, &vers_str, &this->_name))
-      this->_version.parse(vers_str);
-  }
+  return 0;
+}
 
-  // All appear correct, now finalizing Mod Package setup
-  this->_src_path = path;
+/// \brief Save As batch context structure
+///
+/// Context for archive batch progression callbacks, forwarding entries
+/// progression to progress callback and entries data progression to
+/// compress callback of saveAs.
+///
+typedef struct saveas_context_
+{
+  OmModPack*      ModPack;      //< Mod Pack being saved
 
-  this->_src_isdir = isdir;
+  Om_progressCb   progress_cb;  //< Entries progression callback
 
-  this->_src_root = src_root;
+  Om_progressCb   compress_cb;  //< Compression progression callback
 
-  this->_src_home = Om_getDirPart(path);
+  void*           user_ptr;     //< Callbacks user pointer
 
-  this->_src_time = Om_itemTime(path);
-
-  if(this->_src_isdir) {
-
-    this->loadDirDescription();
-
-    this->loadDirThumbnail();
-  }
+  size_t          done;         //< Count of entries added to archive
 
-  this->_has_src = true;
+  bool            abort;        //< Process aborted by callback
 
-  return true;
-}
+} saveas_context_t;
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-bool OmModPack::refreshSource()
+static bool __saveas_batch_fn(void* ptr, size_t tot, size_t cur, uint64_t param)
 {
-  if(this->_has_src) {
+  saveas_context_t* sctx = static_cast<saveas_context_t*>(ptr);
 
-    if(this->_src_isdir) {
-      // we cannot rely on time for directory changes, we refresh in all cases
-      this->parseSource(OmWString(this->_src_path));
-      return true;
-    } else {
-      if(this->_src_time != Om_itemTime(this->_src_path))
-        return this->parseSource(OmWString(this->_src_path));
-    }
-  }
+  OM_UNUSED(param);
 
-  return false;
+  sctx->done = cur;
+
+  if(sctx->progress_cb)
+    if(!sctx->progress_cb(sctx->user_ptr, tot, cur, reinterpret_cast<uint64_t>(sctx->ModPack)))
+      sctx->abort = true;
+
+  return !sctx->abort;
 }
-
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-int32_t OmModPack::getSourceCompMethod() const
-{
-  int32_t result = -1;
-
-  if(this->_has_src) {
-
-    OmArchive source_zip;
-
-    if(!source_zip.read(this->_src_path))
-      return result;
-
-    if(source_zip.entryCount()) {
-
-      result = 0; //< Store (no compression)
-
-      // verify the whole archive is consistent
-      for(size_t i = 0; i < source_zip.entryCount(); ++i) {
-
-        int32_t method = source_zip.entryMethod(i);
-
-        // search for Non-Store compression method
-        if(method != 0) {
-
-          if(result == 0) { //< mean this is the first time result is set
-            result = method;
-          } else if(method != result) {
-            // method changed within the same Central directory
-            result = -1; break;
-          }
-        }
-      }
-    }
-
-    source_zip.close();
-
-  }
-
-  return result;
-}
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-bool OmModPack::loadDirDescription()
+static bool __saveas_compress_fn(void* ptr, size_t tot, size_t cur, uint64_t param)
 {
-  // build bas file path prototypes to search
-  OmWString found_path, test_path[2];
-
-  Om_concatPaths(test_path[0], this->_src_home, this->_iden);
-  Om_concatPaths(test_path[1], this->_src_home, this->_core);
-
-  bool found, changed = false;
-
-  found = false;
-  // Try text file with same identity, then core name
-  for(unsigned i = 0; i < 2; ++i) {
-    if(Om_isFile(found_path = test_path[i] + L".txt")) {
-      found = true; break;
-    }
-  }
+  saveas_context_t* sctx = static_cast<saveas_context_t*>(ptr);
 
-  if(found) {
-    time_t new_time = Om_itemTime(found_path);
-    if(new_time != this->_description_time) {
-      Om_loadToUTF16(&this->_description, found_path);
-      this->_description_time = new_time;
-      changed = true;
-    }
-  } else {
-    this->_description_time = 0;
-    this->_description.clear();
-  }
+  if(sctx->compress_cb)
+    if(!sctx->compress_cb(sctx->user_ptr, tot, cur, param))
+      sctx->abort = true;
 
-  return changed;
+  return !sctx->abort;
 }
 
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-bool OmModPack::loadDirThumbnail()
+OmModPack::OmModPack() :
+  _ModChan(nullptr),
+  _hash(0),
+  _has_src(false),
+  _src_isdir(false),
+  _has_bck(false),
+  _bck_isdir(false),
+  _is_overlapped(false),
+  _op_backup(false),
+  _op_restore(false),
+  _op_apply(false),
+  _op_progress(0)
 {
-  // build bas file path prototypes to search
-  OmWString found_path, test_path[2];
-
-  Om_concatPaths(test_path[0], this->_src_home, this->_iden);
-  Om_concatPaths(test_path[1], this->_src_home, this->_core);
-
-  bool found, changed = false;
 
-  // supported image extensions
-  const wchar_t* img_ext[] = {L".jpg", L".png", L".gif", L".bmp"};
+}
 
-  found = false;
-  // try image file with same identity, then core name
-  for(unsigned i = 0; i < 4; ++i) {
-    if(Om_isFile(found_path = test_path[0] + img_ext[i])) {
-      found = true; break;
-    }
-    if(Om_isFile(found_path = test_path[1] + img_ext[i])) {
-      found = true; break;
-    }
-  }
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmModPack::OmModPack(OmModChan* ModChan) :
+  _ModChan(ModChan),
+  _hash(0),
+  _has_src(false),
+  _src_isdir(false),
+  _has_bck(false),
+  _bck_isdir(false),
+  _is_overlapped(false),
+  _op_backup(false),
+  _op_restore(false),
+  _op_apply(false),
+  _op_progress(0)
+{
 
-  if(found) {
-    time_t new_time = Om_itemTime(found_path);
-    if(new_time != this->_thumbnail_time) {
-      this->_thumbnail.loadThumbnail(found_path, OM_MODPACK_THUMB_SIZE, OM_SIZE_FILL);
-      this->_thumbnail_time = new_time;
-      changed = true;
-    }
-  } else {
-    this->_thumbnail_time = 0;
-    this->_thumbnail.clear();
-  }
+}
 
-  return changed;
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmModPack::~OmModPack()
+{
+  // remove from Mod Channel path index and release blobs
+  this->clearBackup();
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModPack::setThumbnail(const OmWString& path)
+void OmModPack::clearAll()
 {
-  this->_thumbnail.loadThumbnail(path, OM_MODPACK_THUMB_SIZE, OM_SIZE_FILL);
-  this->_thumbnail_time = 0;
+  // Source and Backup sides
+  this->clearSource();
+  this->clearBackup();
+
+  // General properties
+  this->_iden.clear();
+  this->_hash = 0;
+  this->_core.clear();
+  this->_name.clear();
+  this->_version.clear();
+
+  this->_op_backup = false;
+  this->_op_restore = false;
+  this->_op_apply = false;
+  this->_op_progress = 0;
 }
-
-
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModPack::setThumbnail(const OmImage& image)
+bool OmModPack::refreshAnalytics()
 {
-  this->_thumbnail.loadThumbnail(image, OM_MODPACK_THUMB_SIZE, OM_SIZE_FILL);
-  this->_thumbnail_time = 0;
+  bool has_changes = false;
+
+  // check for overlapping
+  if(!this->_ModChan)
+    return false;
+
+  bool is_overlapped = this->_ModChan->isOverlapped(this);
+
+  if(is_overlapped != this->_is_overlapped)
+    has_changes = true;
+
+  this->_is_overlapped = is_overlapped;
+
+  return has_changes;
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModPack::clearThumbnail()
+void OmModPack::clearSource()
 {
+  // Package source properties
+  this->_has_src = false;
+  this->_src_time = 0;
+  this->_src_path.clear();
+  this->_src_isdir = false;
+  this->_src_root.clear();
+  this->_src_entry.clear();
+  this->_src_depend.clear();
+
+  // Optional properties liked to source
+  this->_category.clear();
+  this->_description.clear();
+  this->_description_time = 0;
   this->_thumbnail.clear();
   this->_thumbnail_time = 0;
-}
-
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-bool OmModPack::hasDepend(const OmWString& ident) const
-{
-  // you don't like raw loops ? I LOVE row loops...
-  for(size_t i = 0; i < this->_src_depend.size(); ++i)
-    if(this->_src_depend[i] == ident)
-      return true;
-
-  return false;
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModPack::deleteDepend(size_t index)
+void OmModPack::_src_parse_dir(OmModEntryArray* entries, const OmWString& orig, const OmWString& from)
 {
-  if(index < this->_src_depend.size())
-    this->_src_depend.erase(this->_src_depend.begin() + index);
+  OmWString item;
+  OmWString root;
+
+  OmModEntry_t entry;
+  entry.cdid = -1;
+  entry.crc = 0;
+
+  OmWString srch(orig);
+  srch += L"\\*";
+
+  WIN32_FIND_DATAW fd;
+  HANDLE hnd = FindFirstFileW(srch.c_str(), &fd);
+  if(hnd != INVALID_HANDLE_VALUE) {
+    do {
+      // skip this and parent folder
+      if(!wcscmp(fd.cFileName, L".")) continue;
+      if(!wcscmp(fd.cFileName, L"..")) continue;
+
+      item = from + L"\\"; item += fd.cFileName;
+
+      entry.path = item;
+
+      if(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+        entry.attr = OM_MODENTRY_DIR;
+        entry.size = 0;
+        entries->push_back(entry);
+        // go deep in tree
+        root = orig + L"\\"; root += fd.cFileName;
+        OmModPack::_src_parse_dir(entries, root, item);
+      } else {
+        entry.attr = 0;
+        entry.size = (static_cast<uint64_t>(fd.nFileSizeHigh) << 32) | fd.nFileSizeLow;
+        entries->push_back(entry);
+      }
+    } while(FindNextFileW(hnd, &fd));
+  }
+  FindClose(hnd);
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModPack::clearBackup()
-{
- this->_has_bck = false;
- this->_bck_path.clear();
- this->_bck_isdir = false;
- this->_bck_root.clear();
- this->_bck_entry.clear();
- this->_bck_overlap.clear();
-}
-
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-bool OmModPack::parseBackup(const OmWString& path)
+bool OmModPack::parseSource(const OmWString& path)
 {
-  this->clearBackup();
+  this->clearSource();
 
   bool isdir = false;
 
-  OmWString bck_root;
-
-  OmXmlConf backup_cfg;
+  OmWString src_root, src_iden;
 
   if(Om_isDir(path)) {
 
-    isdir = true;
-
-    // Parse uncompressed backup raw directory
-    OmWStringArray files_ls;
-    Om_lsFile(&files_ls, path, true);
-
-    for(size_t i = 0; i < files_ls.size(); ++i) {
-
-      if(Om_extensionMatches(files_ls[i], OM_BCK_DEF_FILE_EXT) || Om_namesMatches(files_ls[i], L"ModBack.xml")) {
+    // Parse legacy/development Mod Package directory
 
-        if(!backup_cfg.load(files_ls[i], OM_XMAGIC_BCK)) {
-          this->_error(L"parseBackup", Om_errZipExtr(L"definition file", files_ls[i], backup_cfg.lastErrorStr()));
-          return false;
-        }
+    isdir = true;
 
-        break;
-      }
-    }
+    //__parse_source_dir(&this->_src_entry, path, L"");
+    OmModPack::_src_parse_dir(&this->_src_entry, path, L"");
+    src_root = path;
 
-    bck_root = path;
+    src_iden = Om_getFilePart(path);
 
   } else if(Om_isFileZip(path)) {
 
-    // Parse compressed file backup
+    // Parse compressed file Mod Package
 
-    OmArchive backup_zip;
+    OmArchive source_zip;
 
-    // Open zip file
-    if(!backup_zip.read(path)) {
-      this->_error(L"parseBackup", Om_errLoad(L"archive file", path, backup_zip.lastErrorStr()));
+    if(!source_zip.read(path, OM_READER_MAPPED)) {
+      this->_error(L"parseSource", Om_errLoad(L"archive file", path, source_zip.lastErrorStr()));
       return false;
     }
 
+    // Try to find modern Mod Package XML definition file
+    OmXmlConf source_cfg;
+
+    int32_t zcd_idx;
+    OmWString zcd_path;
+
     // Search in backward since XML definition file is usually the last added
     // in zip archive so appear at the end of Central Directory.
-    unsigned i = backup_zip.entryCount();
+    unsigned i = source_zip.entryCount();
     while(i--) {
 
-      OmWString zcd_path;
-      backup_zip.entryPath(i, zcd_path);
-
-      if(Om_extensionMatches(zcd_path, OM_BCK_DEF_FILE_EXT) || Om_namesMatches(zcd_path, L"ModBack.xml")) {
+      source_zip.entryPath(i, zcd_path);
 
-        uint64_t data_len = backup_zip.entrySize(i);
+      if(Om_extensionMatches(zcd_path, OM_PKG_DEF_FILE_EXT) || Om_namesMatches(zcd_path, L"ModPack.xml")) {
 
-        char* data_buf = new(std::nothrow) char[data_len+1];
-        if(!data_buf) {
-          this->_error(L"parseBackup", Om_errBadAlloc(L"definition file extraction", zcd_path));
-          return false;
-        }
+        OmCString data;
+        OmWString read_err;
 
-        if(!backup_zip.entrySave(i, data_buf)) {
-          delete [] data_buf;
-          this->_error(L"parseBackup", Om_errZipExtr(L"definition file", zcd_path, backup_zip.lastErrorStr()));
+        if(!__read_zip_entry(source_zip, i, &data, &read_err)) {
+          this->_error(L"parseSource", Om_errZipExtr(L"definition file", zcd_path, read_err));
           return false;
         }
 
-        data_buf[data_len] = '\0';
-
-        if(!backup_cfg.parse(Om_toUTF16(data_buf), OM_XMAGIC_BCK)) {
-          delete [] data_buf;
-          this->_error(L"parseBackup", Om_errParse(L"definition file", zcd_path, backup_cfg.lastErrorStr()));
+        if(!source_cfg.parse(Om_toUTF16(data.c_str()), OM_XMAGIC_PKG)) {
+          this->_error(L"parseSource", Om_errParse(L"definition file", zcd_path, source_cfg.lastErrorStr()));
           return false;
         }
 
-        delete [] data_buf;
-
         break;
       }
     }
-  } else {
-
-    // No valid backup data here
-    this->_error(L"parseBackup", L"unknown or wrong file type \""+path+L"\"");
-    return false;
-  }
-
-  OmWString bck_iden;
-  uint64_t bck_hash;
 
-  if(backup_cfg.valid()) {
+    // Either we found XML definition file, or we try to parse this Package the old fashion
+    if(source_cfg.valid()) {
 
-    // verify the Backup definition have the proper nodes
-    if(!backup_cfg.hasChild(L"backup") || !backup_cfg.hasChild(L"ident") || !backup_cfg.hasChild(L"hash")) {
-      this->_error(L"parseBackup", L"definition file is missing essential nodes");
-      return false;
-    }
+      src_root = source_cfg.child(L"install").content();
 
-    bck_root = backup_cfg.child(L"backup").content();
+      // search for <dependencies>
+      if(source_cfg.hasChild(L"dependencies")) {
 
-    bck_iden = backup_cfg.child(L"ident").content();
+        OmXmlNodeArray xml_iden_ls;
 
-    bck_hash = Om_strToUint64(backup_cfg.child(L"hash").content());
+        source_cfg.child(L"dependencies").children(xml_iden_ls, L"ident");
 
+        for(size_t i = 0; i < xml_iden_ls.size(); ++i)
+          this->_src_depend.push_back(xml_iden_ls[i].content());
+      }
 
-    OmXmlNodeArray xml_node_ls;
+      // search for <category>
+      if(source_cfg.hasChild(L"category")) {
+        this->_category = source_cfg.child(L"category").content();
+      }
 
-    // get list of installed files, they are listed in the
-    // backup definition, either as <cpy> or <del> entries.
-    backup_cfg.children(xml_node_ls, L"cpy");
+      // search for <description>
+      if(source_cfg.hasChild(L"description")) {
+        Om_toCRLF(&this->_description, source_cfg.child(L"description").content());
+      }
+
+      // search for <thumbnail>
+      if(source_cfg.hasChild(L"thumbnail")) {
+
+        OmWString mimetype, charset;
+
+        // decode the DataURI
+        size_t png_size;
+        uint8_t* png_data = Om_decodeDataUri(&png_size, mimetype, charset, source_cfg.child(L"thumbnail").content());
+
+        // load png data as thumbnail
+        if(png_data) {
+          this->_thumbnail.load(png_data, png_size);
+          Om_free(png_data);
+        }
+      }
+
+      // search for <picture> (old format, deprectated)
+      if(source_cfg.hasChild(L"picture")) {
+
+        zcd_path = source_cfg.child(L"picture").content();
+
+        zcd_idx = source_zip.entryLocate(zcd_path);
+
+        if(zcd_idx >= 0) {
+
+          OmCString data;
+          OmWString read_err;
+
+          if(__read_zip_entry(source_zip, zcd_idx, &data, &read_err)) {
+            if(!this->_thumbnail.loadThumbnail(reinterpret_cast<uint8_t*>(&data[0]), data.size(), OM_MODPACK_THUMB_SIZE, OM_SIZE_FILL)) {
+              this->_log(OM_LOG_WRN, L"parseSource", L"thumbnail image: "+this->_thumbnail.lastErrorStr());
+            }
+          } else {
+            this->_log(OM_LOG_WRN, L"parseSource", Om_errZipExtr(L"thumbnail image",zcd_path,read_err));
+          }
+        }
+      }
+
+    } else {
+
+      // We are here with a zip file without Mod Pack XML definition, we try
+      // to parse it the old fashion, we search for data root directory named
+      // exactly the same as file name.
+
+      bool has_root = false;
+
+      src_root = Om_getNamePart(path);
+
+      for(size_t i = 0; i < source_zip.entryCount(); ++i) {
+
+        source_zip.entryPath(i, zcd_path);
+
+        if(Om_isRootOfPath(src_root, zcd_path)) {
+          has_root = true; break;
+        }
+      }
+
+      if(!has_root) {
+        this->_error(L"parseSource", L"\""+path+L"\": unknown or wrong Mod Pack architecture.");
+        return false;
+      }
+
+      // search for a readme file to use as description
+      zcd_idx = source_zip.entryLocate(L"readme.txt");
+      if(zcd_idx >= 0) {
+
+        OmCString data;
+        OmWString read_err;
+
+        if(__read_zip_entry(source_zip, zcd_idx, &data, &read_err)) {
+          this->_description = Om_toUTF16(data.c_str());
+        } else {
+          this->_log(OM_LOG_WRN, L"parseSource", Om_errZipExtr(L"readme file", L"readme.txt", read_err));
+        }
+      }
+    }
+
+    // Mod Pack appear valid, now we gather all Mod entries
+    for(size_t i = 0; i < source_zip.entryCount(); ++i) {
+
+      source_zip.entryPath(i, zcd_path);
+
+      OmModEntry_t entry;
+
+      if(Om_getRelativePath(&entry.path, src_root, zcd_path)) {
+
+        entry.cdid = i;
+        entry.size = source_zip.entrySize(i);
+        entry.crc = source_zip.entryCrc(i);
+
+        if(source_zip.entryIsDir(i)) {
+          entry.attr = OM_MODENTRY_DIR;
+        } else {
+          entry.attr = 0;
+        }
+
+        this->_src_entry.push_back(entry);
+      }
+    }
+
+    src_iden = Om_getNamePart(path);
+
+  } else {
+    this->_error(L"parseSource", L"unknown or wrong file type \""+path+L"\"");
+    return false;
+  }
+
+  uint64_t src_hash = Om_getXXHash3(Om_getFilePart(path));
+
+  // ultimately check against already parsed data from the Source
+  if(this->_has_bck) {
+
+    if(src_hash != this->_hash || this->_iden != src_iden) {
+      this->_error(L"parseSource", L"parsed Source mismatch already parsed Backup \""+path+L"\"");
+      return false;
+    }
+
+  } else {
+
+    this->_hash = src_hash;
+
+    this->_iden = src_iden;
+
+    // parse other Mod common infos from identity
+    OmWString vers_str;
+    if(Om_parseModIdent(this->_iden, &this->_core, &vers_str, &this->_name))
+      this->_version.parse(vers_str);
+  }
+
+  // All appear correct, now finalizing Mod Package setup
+  this->_src_path = path;
+
+  this->_src_isdir = isdir;
+
+  this->_src_root = src_root;
+
+  this->_src_home = Om_getDirPart(path);
+
+  this->_src_time = Om_itemTime(path);
+
+  if(this->_src_isdir) {
+
+    this->loadDirDescription();
+
+    this->loadDirThumbnail();
+  }
+
+  this->_has_src = true;
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::loadSourceCache(const OmWString& path, const OmXmlNode& node)
+{
+  this->clearSource();
+
+  // entries from older cache lack size and CRC-32, Source must be parsed
+  if(node.child(L"entries").attrAsInt(L"format") < 2)
+    return false;
+
+  // cached Sources are always archive files
+  OmWString src_iden = Om_getNamePart(path);
+
+  uint64_t src_hash = Om_getXXHash3(Om_getFilePart(path));
+
+  // same check as parseSource against already parsed Backup
+  if(this->_has_bck) {
+
+    if(src_hash != this->_hash || this->_iden != src_iden)
+      return false;
+
+  } else {
+
+    this->_hash = src_hash;
+
+    this->_iden = src_iden;
+
+    // parse other Mod common infos from identity
+    OmWString vers_str;
+    if(Om_parseModIdent(this->_iden, &this->_core, &vers_str, &this->_name))
+      this->_version.parse(vers_str);
+  }
+
+  // entries are stored one per line as "cdid|attr|size|crc|path"
+  const wchar_t* line = node.child(L"entries").content();
+
+  while(*line) {
+
+    OmModEntry_t entry;
+    wchar_t* end;
+
+    entry.cdid = wcstol(line, &end, 10);
+    if(*end != L'|') break;
+
+    entry.attr = wcstol(end + 1, &end, 10);
+    if(*end != L'|') break;
+
+    entry.size = wcstoull(end + 1, &end, 10);
+    if(*end != L'|') break;
+
+    entry.crc = wcstoul(end + 1, &end, 10);
+    if(*end != L'|') break;
+
+    const wchar_t* eol = wcschr(end + 1, L'\n');
+    if(!eol) eol = end + 1 + wcslen(end + 1);
+
+    entry.path.assign(end + 1, eol - (end + 1));
+    this->_src_entry.push_back(entry);
+
+    line = (*eol) ? eol + 1 : eol;
+  }
+
+  OmXmlNodeArray xml_iden_ls;
+  node.children(xml_iden_ls, L"ident");
+
+  for(size_t i = 0; i < xml_iden_ls.size(); ++i)
+    this->_src_depend.push_back(xml_iden_ls[i].content());
+
+  if(node.hasChild(L"category"))
+    this->_category = node.child(L"category").content();
+
+  // XML parser normalizes line endings
+  if(node.hasChild(L"description"))
+    Om_toCRLF(&this->_description, node.child(L"description").content());
+
+  if(node.hasChild(L"thumbnail")) {
+
+    OmXmlNode thumbnail_node = node.child(L"thumbnail");
+
+    if(thumbnail_node.attrAsInt(L"format") == 2) {
+
+      // thumbnail stored as deflated RGBA pixels, no image decoding needed
+      unsigned w = thumbnail_node.attrAsInt(L"width");
+      unsigned h = thumbnail_node.attrAsInt(L"height");
+
+      size_t def_size;
+      uint8_t* def_data = Om_fromBase64(&def_size, thumbnail_node.content());
+
+      if(def_data) {
+        uint8_t* pixels = Om_zInflate(def_data, def_size, w * h * 4);
+        Om_free(def_data);
+
+        if(pixels) {
+          if(!this->_thumbnail.loadPixels(pixels, w, h))
+            Om_free(pixels);
+        }
+      }
+
+    } else {
+
+      OmWString mimetype, charset;
+
+      // decode the DataURI
+      size_t png_size;
+      uint8_t* png_data = Om_decodeDataUri(&png_size, mimetype, charset, thumbnail_node.content());
+
+      // load png data as thumbnail
+      if(png_data) {
+        this->_thumbnail.load(png_data, png_size);
+        Om_free(png_data);
+      }
+    }
+  }
+
+  this->_src_path = path;
+
+  this->_src_isdir = false;
+
+  this->_src_root = node.attrAsString(L"root");
+
+  this->_src_home = Om_getDirPart(path);
+
+  this->_src_time = node.attrAsUint64(L"time");
+
+  this->_has_src = true;
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModPack::saveSourceCache(OmXmlNode& node) const
+{
+  node.setAttr(L"path", this->_src_path);
+  node.setAttr(L"root", this->_src_root);
+  node.setAttr(L"time", static_cast<uint64_t>(this->_src_time));
+
+  // entries are stored one per line as "cdid|attr|size|crc|path"
+  OmWString entries;
+  wchar_t num_buf[64];
+
+  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+    swprintf(num_buf, 64, L"%d|%d|%llu|%u|", this->_src_entry[i].cdid, this->_src_entry[i].attr,
+             static_cast<unsigned long long>(this->_src_entry[i].size), this->_src_entry[i].crc);
+    entries += num_buf;
+    entries += this->_src_entry[i].path;
+    entries += L'\n';
+  }
+
+  OmXmlNode entries_node = node.addChild(L"entries");
+  entries_node.setContent(entries);
+  entries_node.setAttr(L"format", 2);
+
+  for(size_t i = 0; i < this->_src_depend.size(); ++i)
+    node.addChild(L"ident").setContent(this->_src_depend[i]);
+
+  if(!this->_category.empty())
+    node.addChild(L"category").setContent(this->_category);
+
+  if(!this->_description.empty())
+    node.addChild(L"description").setContent(this->_description);
+
+  if(this->_thumbnail.valid()) {
+
+    // store thumbnail pixels as is, only deflated, so loading from cache
+    // does not need any image decoding
+    size_t def_size;
+    uint8_t* def_data = Om_zDeflate(&def_size, this->_thumbnail.data(),
+                                    this->_thumbnail.width() * this->_thumbnail.height() * this->_thumbnail.bpp(), 1);
+    if(def_data) {
+
+      OmXmlNode thumbnail_node = node.addChild(L"thumbnail");
+      thumbnail_node.setContent(Om_toBase64(def_data, def_size));
+      thumbnail_node.setAttr(L"width", static_cast<int>(this->_thumbnail.width()));
+      thumbnail_node.setAttr(L"height", static_cast<int>(this->_thumbnail.height()));
+      thumbnail_node.setAttr(L"format", 2);
+
+      Om_free(def_data);
+
+    } else {
+
+      // Encode image (rgba) to png
+      uint64_t png_size;
+      uint8_t* png_data = Om_imgEncodePng(&png_size,  this->_thumbnail.data(),
+                                                      this->_thumbnail.width(),
+                                                      this->_thumbnail.height(),
+                                                      this->_thumbnail.bpp());
+      if(png_data) {
+
+        // encode png binary data to base64 encoded data URI
+        OmWString data_uri;
+        Om_encodeDataUri(data_uri, L"image/png", L"", png_data, png_size);
+
+        Om_free(png_data);
+
+        node.addChild(L"thumbnail").setContent(data_uri);
+      }
+    }
+  }
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::refreshSource()
+{
+  if(this->_has_src) {
+
+    if(this->_src_isdir) {
+      // we cannot rely on time for directory changes, we refresh in all cases
+      this->parseSource(OmWString(this->_src_path));
+      return true;
+    } else {
+      if(this->_src_time != Om_itemTime(this->_src_path))
+        return this->parseSource(OmWString(this->_src_path));
+    }
+  }
+
+  return false;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+int32_t OmModPack::getSourceCompMethod() const
+{
+  int32_t result = -1;
+
+  if(this->_has_src) {
+
+    OmArchive source_zip;
+
+    if(!source_zip.read(this->_src_path, OM_READER_MAPPED))
+      return result;
+
+    if(source_zip.entryCount()) {
+
+      result = 0; //< Store (no compression)
+
+      // verify the whole archive is consistent
+      for(size_t i = 0; i < source_zip.entryCount(); ++i) {
+
+        int32_t method = source_zip.entryMethod(i);
+
+        // search for Non-Store compression method
+        if(method != 0) {
+
+          if(result == 0) { //< mean this is the first time result is set
+            result = method;
+          } else if(method != result) {
+            // method changed within the same Central directory
+            result = -1; break;
+          }
+        }
+      }
+    }
+
+    source_zip.close();
+
+  }
+
+  return result;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::loadDirDescription()
+{
+  // build bas file path prototypes to search
+  OmWString found_path, test_path[2];
+
+  Om_concatPaths(test_path[0], this->_src_home, this->_iden);
+  Om_concatPaths(test_path[1], this->_src_home, this->_core);
+
+  bool found, changed = false;
+
+  found = false;
+  // Try text file with same identity, then core name
+  for(unsigned i = 0; i < 2; ++i) {
+    if(Om_isFile(found_path = test_path[i] + L".txt")) {
+      found = true; break;
+    }
+  }
+
+  if(found) {
+    time_t new_time = Om_itemTime(found_path);
+    if(new_time != this->_description_time) {
+      Om_loadToUTF16(&this->_description, found_path);
+      this->_description_time = new_time;
+      changed = true;
+    }
+  } else {
+    this->_description_time = 0;
+    this->_description.clear();
+  }
+
+  return changed;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::loadDirThumbnail()
+{
+  // build bas file path prototypes to search
+  OmWString found_path, test_path[2];
+
+  Om_concatPaths(test_path[0], this->_src_home, this->_iden);
+  Om_concatPaths(test_path[1], this->_src_home, this->_core);
+
+  bool found, changed = false;
+
+  // supported image extensions
+  const wchar_t* img_ext[] = {L".jpg", L".png", L".gif", L".bmp"};
+
+  found = false;
+  // try image file with same identity, then core name
+  for(unsigned i = 0; i < 4; ++i) {
+    if(Om_isFile(found_path = test_path[0] + img_ext[i])) {
+      found = true; break;
+    }
+    if(Om_isFile(found_path = test_path[1] + img_ext[i])) {
+      found = true; break;
+    }
+  }
+
+  if(found) {
+    time_t new_time = Om_itemTime(found_path);
+    if(new_time != this->_thumbnail_time) {
+      this->_thumbnail.loadThumbnail(found_path, OM_MODPACK_THUMB_SIZE, OM_SIZE_FILL);
+      this->_thumbnail_time = new_time;
+      changed = true;
+    }
+  } else {
+    this->_thumbnail_time = 0;
+    this->_thumbnail.clear();
+  }
+
+  return changed;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModPack::setThumbnail(const OmWString& path)
+{
+  this->_thumbnail.loadThumbnail(path, OM_MODPACK_THUMB_SIZE, OM_SIZE_FILL);
+  this->_thumbnail_time = 0;
+}
+
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModPack::setThumbnail(const OmImage& image)
+{
+  this->_thumbnail.loadThumbnail(image, OM_MODPACK_THUMB_SIZE, OM_SIZE_FILL);
+  this->_thumbnail_time = 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModPack::clearThumbnail()
+{
+  this->_thumbnail.clear();
+  this->_thumbnail_time = 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::hasDepend(const OmWString& ident) const
+{
+  // you don't like raw loops ? I LOVE row loops...
+  for(size_t i = 0; i < this->_src_depend.size(); ++i)
+    if(this->_src_depend[i] == ident)
+      return true;
+
+  return false;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModPack::deleteDepend(size_t index)
+{
+  if(index < this->_src_depend.size())
+    this->_src_depend.erase(this->_src_depend.begin() + index);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModPack::clearBackup()
+{
+ if(this->_has_bck && this->_ModChan)
+   this->_ModChan->unindexBackup(this);
+
+ // release blobs still referenced, but keep them stored
+ if(this->_ModChan) {
+   for(size_t i = 0; i < this->_bck_entry.size(); ++i)
+     if(!this->_bck_entry[i].blob.empty())
+       this->_ModChan->releaseBackupBlob(this->_bck_entry[i].blob, false);
+ }
+
+ this->_has_bck = false;
+ this->_bck_path.clear();
+ this->_bck_isdir = false;
+ this->_bck_root.clear();
+ this->_bck_entry.clear();
+ this->_bck_overlap.clear();
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::parseBackup(const OmWString& path)
+{
+  this->clearBackup();
+
+  bool isdir = false;
+
+  OmWString bck_root;
+
+  OmXmlConf backup_cfg;
+
+  if(Om_isDir(path)) {
+
+    isdir = true;
+
+    // Parse uncompressed backup raw directory
+    OmWStringArray files_ls;
+    Om_lsFile(&files_ls, path, true);
+
+    for(size_t i = 0; i < files_ls.size(); ++i) {
+
+      if(Om_extensionMatches(files_ls[i], OM_BCK_DEF_FILE_EXT) || Om_namesMatches(files_ls[i], L"ModBack.xml")) {
+
+        if(!backup_cfg.load(files_ls[i], OM_XMAGIC_BCK)) {
+          this->_error(L"parseBackup", Om_errZipExtr(L"definition file", files_ls[i], backup_cfg.lastErrorStr()));
+          return false;
+        }
+
+        break;
+      }
+    }
+
+    bck_root = path;
+
+  } else if(Om_isFileZip(path)) {
+
+    // Parse compressed file backup
+
+    OmArchive backup_zip;
+
+    // Open zip file
+    if(!backup_zip.read(path, OM_READER_MAPPED)) {
+      this->_error(L"parseBackup", Om_errLoad(L"archive file", path, backup_zip.lastErrorStr()));
+      return false;
+    }
+
+    // Search in backward since XML definition file is usually the last added
+    // in zip archive so appear at the end of Central Directory.
+    unsigned i = backup_zip.entryCount();
+    while(i--) {
+
+      OmWString zcd_path;
+      backup_zip.entryPath(i, zcd_path);
+
+      if(Om_extensionMatches(zcd_path, OM_BCK_DEF_FILE_EXT) || Om_namesMatches(zcd_path, L"ModBack.xml")) {
+
+        OmCString data;
+        OmWString read_err;
+
+        if(!__read_zip_entry(backup_zip, i, &data, &read_err)) {
+          this->_error(L"parseBackup", Om_errZipExtr(L"definition file", zcd_path, read_err));
+          return false;
+        }
+
+        if(!backup_cfg.parse(Om_toUTF16(data.c_str()), OM_XMAGIC_BCK)) {
+          this->_error(L"parseBackup", Om_errParse(L"definition file", zcd_path, backup_cfg.lastErrorStr()));
+          return false;
+        }
+
+        break;
+      }
+    }
+  } else {
+
+    // No valid backup data here
+    this->_error(L"parseBackup", L"unknown or wrong file type \""+path+L"\"");
+    return false;
+  }
+
+  OmWString bck_iden;
+  uint64_t bck_hash;
+
+  if(backup_cfg.valid()) {
+
+    // verify the Backup definition have the proper nodes
+    if(!backup_cfg.hasChild(L"backup") || !backup_cfg.hasChild(L"ident") || !backup_cfg.hasChild(L"hash")) {
+      this->_error(L"parseBackup", L"definition file is missing essential nodes");
+      return false;
+    }
+
+    bck_root = backup_cfg.child(L"backup").content();
+
+    bck_iden = backup_cfg.child(L"ident").content();
+
+    bck_hash = Om_strToUint64(backup_cfg.child(L"hash").content());
+
+
+    OmXmlNodeArray xml_node_ls;
+
+    // get list of installed files, they are listed in the
+    // backup definition, either as <cpy> or <del> entries.
+    backup_cfg.children(xml_node_ls, L"cpy");
+
+    for(size_t i = 0; i < xml_node_ls.size(); ++i) {
+
+      OmModEntry_t entry;
+      entry.cdid = xml_node_ls[i].attrAsInt(L"cdi");
+      entry.attr = 0;
+      if(xml_node_ls[i].attrAsInt(L"dir") > 0)
+        entry.attr |= OM_MODENTRY_DIR;
+      entry.path = xml_node_ls[i].content();
+      // file stored in channel blob store
+      if(xml_node_ls[i].hasAttr(L"blob"))
+        entry.blob = xml_node_ls[i].attrAsString(L"blob");
+
+      this->_bck_entry.push_back(entry);
+    }
+
+    backup_cfg.children(xml_node_ls, L"del");
+
+    for(size_t i = 0; i < xml_node_ls.size(); ++i) {
+
+      OmModEntry_t entry;
+      entry.cdid = -1;
+      entry.attr = OM_MODENTRY_DEL;
+      if(xml_node_ls[i].attrAsInt(L"dir") > 0)
+        entry.attr |= OM_MODENTRY_DIR;
+      // note for me in the future, this does not work properly:
+      // entry.attr = OM_MODENTRY_DEL | (xml_node_ls[i].attrAsInt(L"dir") > 0) ? OM_MODENTRY_DIR : 0;
+      entry.path = xml_node_ls[i].content();
+
+      this->_bck_entry.push_back(entry);
+    }
+
+    // retrieve the backup overlap list, they are stored as a list of Hash values
+    // corresponding to package file name
+    if(backup_cfg.hasChild(L"overlap")) {
+
+      OmXmlNodeArray xml_hash_ls;
+      backup_cfg.child(L"overlap").children(xml_hash_ls, L"hash");
+
+      for(size_t i = 0; i < xml_hash_ls.size(); ++i)
+        this->_bck_overlap.push_back(Om_strToUint64(xml_hash_ls[i].content()));
+    }
+
+  } else {
+    this->_error(L"parseBackup", L"definition not found in location \""+path+L"\"");
+    return false;
+  }
+
+  // ultimately check against already parsed data from the Source
+  if(this->_has_src) {
+
+    if(bck_hash != this->_hash || this->_iden != bck_iden) {
+
+      this->_error(L"parseBackup", L"parsed Backup mismatch already parsed Source \""+path+L"\"");
+      return false;
+    }
+
+  } else {
+
+    this->_hash = bck_hash;
+
+    this->_iden = bck_iden;
+
+    // parse other Mod common infos from identity
+    OmWString vers_str;
+    if(Om_parseModIdent(this->_iden, &this->_core, &vers_str, &this->_name))
+      this->_version.parse(vers_str);
+  }
+
+  // All appear correct, now finalizing Mod Backup setup
+  this->_bck_path = path;
+
+  this->_bck_isdir = isdir;
+
+  //this->_bck_home = Om_getDirPart(path);
+
+  this->_bck_root = bck_root;
+
+  this->_has_bck = true;
+
+  if(this->_ModChan) {
+
+    this->_ModChan->indexBackup(this);
+
+    for(size_t i = 0; i < this->_bck_entry.size(); ++i)
+      if(!this->_bck_entry[i].blob.empty())
+        this->_ModChan->acquireBackupBlob(this->_bck_entry[i].blob);
+  }
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::backupHasEntry(const OmWString& path, int32_t attr) const
+{
+  for(size_t i = 0; i < this->_bck_entry.size(); ++i) {
+    if(this->_bck_entry[i].attr == attr)
+      if(this->_bck_entry[i].path == path)
+        return true;
+  }
+
+  return false;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmModPack::getFootprint(OmModEntryArray* footprint) const
+{
+  if(!this->_ModChan) {
+    //this->_error(L"getFootprint", L"no Mod Channel");
+    return;
+  }
+
+  OmModEntry_t entry;
+  entry.cdid = -1;
+
+  OmWString tgt_file;
+
+  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+
+    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), this->_src_entry[i].path);
+
+    entry.path = this->_src_entry[i].path;
+    entry.attr = this->_src_entry[i].attr;
+
+    if(!Om_pathExists(tgt_file))
+      entry.attr |= OM_MODENTRY_DEL;
+
+    footprint->push_back(entry);
+  }
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::hasOverlap(uint64_t hash) const
+{
+  // you don't like raw loops ? I LOVE row loops...
+  for(size_t i = 0; i < this->_bck_overlap.size(); ++i)
+    if(this->_bck_overlap[i] == hash)
+      return true;
+
+  return false;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::canOverlap(const OmModPack* other) const
+{
+  return this->canOverlap(other->_src_entry);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool OmModPack::canOverlap(const OmModEntryArray& footprint) const
+{
+  // index footprint paths to test Source entries against it
+  std::unordered_set<uint64_t> footprint_index;
+
+  for(size_t j = 0; j < footprint.size(); ++j) {
+
+    if(OM_HAS_BIT(footprint[j].attr, OM_MODENTRY_DIR)) //< we don't care directories
+      continue;
+
+    footprint_index.insert(Om_getPathHash(footprint[j].path));
+  }
+
+  if(footprint_index.empty())
+    return false;
+
+  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+
+    if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) //< we don't care directories
+      continue;
+
+    // same path mean overlap
+    if(footprint_index.count(Om_getPathHash(this->_src_entry[i].path)))
+      return true;
+  }
+
+  return false;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmResult OmModPack::makeBackup(Om_progressCb progress_cb, void* user_ptr)
+{
+  if(this->_has_bck)
+    return OM_RESULT_ABORT;
+
+  if(!this->_ModChan) {
+    this->_error(L"makeBackup", L"no Mod Channel");
+    this->_op_backup = false;
+    return OM_RESULT_ABORT;
+  }
+
+  if(!this->_has_src) {
+    this->_error(L"makeBackup", L"Source data missing");
+    this->_op_backup = false;
+    return OM_RESULT_ABORT;
+  }
+
+  // start backup operation
+  this->_op_backup = true;
+
+  // initialize chrono
+  clock_t time = clock();
+
+  // initialize progression callback
+  size_t progress_tot = 0, progress_cur = 0;
+  if(progress_cb) {
+    progress_tot = this->_src_entry.size() * 2;   //< backup + install
+    progress_cur = 0;
+    this->_op_progress =((double)progress_cur / progress_tot) * 100;
+    if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
+      return OM_RESULT_ABORT;
+    }
+  }
+
+  OmArchive backup_zip;
+
+  bool isdir = (this->_ModChan->backupCompMethod() < 0);
+
+  // backed up files go to channel shared blob store
+  bool dedup = this->_ModChan->backupDedup();
+
+  OmWString bck_root;
+
+  OmWString bck_name = Om_getFilePart(this->_src_path);
+
+  OmWString bck_path = this->_ModChan->backupPath() + L"\\";
+
+  if(isdir) {
+
+    bck_path += bck_name;
+
+    bck_root = bck_path + L"\\" + BACKUP_DATA_ROOT_DIR;
+
+    int32_t result = Om_dirCreateRecursive(bck_root);
+    if(result != 0) {
+      this->_error(L"makeBackup", Om_errCreate(L"initial Backup directories", bck_root, result));
+      this->_op_backup = false;
+      return OM_RESULT_ERROR;
+    }
+
+  } else {
+
+    bck_name += L"." OM_BCK_FILE_EXT;
+    bck_path += bck_name;
+
+    bck_root = BACKUP_DATA_ROOT_DIR;
+
+    // initialize zip archive
+    if(!backup_zip.write(bck_path, this->_ModChan->backupCompMethod(), this->_ModChan->backupCompLevel())) {
+      this->_error(L"makeBackup", Om_errInit(L"Backup archive file", bck_path, backup_zip.lastErrorStr()));
+      this->_op_backup = false;
+      return OM_RESULT_ERROR;
+    }
+  }
+
+  // initialize backup XML config
+  OmXmlConf backup_cfg(OM_XMAGIC_BCK);
+
+  backup_cfg.addChild(L"ident").setContent(this->_iden);
+  backup_cfg.addChild(L"hash").setContent(Om_uint64ToStr(this->_hash));
+  backup_cfg.addChild(L"backup").setContent(BACKUP_DATA_ROOT_DIR);
+
+  // Target files moved to Backup are journaled so they can be put back
+  // if process ends unexpectedly
+  this->_ModChan->journalOper(OM_JOURNAL_BACKUP, bck_path, isdir ? bck_root : OmWString());
+
+  bool has_error = false;
+  bool has_abort = false;
+
+  uint64_t bytes_skip = 0;
+
+  // directory Backup tree is created as entries come
+  dir_cache_t bck_dirs;
+  __dir_cache_init(&bck_dirs, bck_root, true);
+
+  // Target files to be moved, they are journaled then moved by batches
+  OmIndexArray move_idx;
+  OmWStringArray move_key;
+
+  OmWString tgt_file, bck_file, src_file, blob;
+  OmXmlNode bck_node;
+
+  for(size_t i = 0, z = 0; i < this->_src_entry.size(); ++i) {
+
+    OmModEntry_t entry;
+    entry.path = this->_src_entry[i].path;
+    entry.attr = this->_src_entry[i].attr;
+    entry.cdid = -1; //< invalid zip central-directory index
+    entry.size = this->_src_entry[i].size;
+    entry.crc = this->_src_entry[i].crc;
+
+    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), entry.path);
+    Om_concatPaths(bck_file, bck_root, entry.path);
+
+    if(this->_src_isdir)
+      Om_concatPaths(src_file, this->_src_root, entry.path);
+
+    if(!Om_pathExists(tgt_file)) {
+
+      // file or directory does not exists in Target, this is a added/created file
+      // by the Mod that must be deleted at uninstall
+      entry.attr |= OM_MODENTRY_DEL;
+
+      bck_node = backup_cfg.addChild(L"del");
+      bck_node.setContent(entry.path);
+      bck_node.setAttr(L"cdi", (int)entry.cdid);
+      bck_node.setAttr(L"dir", OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR) ? 1 : 0 );
+
+      this->_bck_entry.push_back(entry);
+
+    } else if(!OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR) &&
+              !this->_ModChan->backupEntryExists(entry.path, 0) &&
+              !this->_ModChan->backupEntryExists(entry.path, OM_MODENTRY_DEL) &&
+              __entry_unchanged(this->_src_entry[i], this->_src_isdir, src_file, tgt_file)) {
+
+      // Mod would not change this file so there is nothing to backup, but
+      // files created or modified by another Mod are still backed up to
+      // keep overlaps consistent
+      bytes_skip += entry.size;
+
+    } else {
+
+      if(OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR)) {
+
+        if(this->_ModChan->backupEntryExists(entry.path, entry.attr)) {
+
+          // directory was created by another Mod, in this case we add it as to be
+          // deleted by this one too so we can delete unused shared folders if empty.
+          entry.attr |= OM_MODENTRY_DEL;
+
+          bck_node = backup_cfg.addChild(L"del");
+          bck_node.setContent(entry.path);
+          bck_node.setAttr(L"cdi", (int)entry.cdid);
+          bck_node.setAttr(L"dir", 1);
+
+          this->_bck_entry.push_back(entry);
+        }
+
+        if(isdir) {
+
+          int32_t result = __dir_cache_path(&bck_dirs, entry.path);
+          if(result != 0) {
+            this->_error(L"makeBackup", Om_errCreate(L"directory in Backup", bck_file, result));
+            has_error = true; break;
+          }
+        }
+
+      } else {
+
+        blob.clear();
+
+        if(dedup) {
+
+          // store file content once, shared with other Backups, the key is
+          // computed first as it must be journaled before file is moved
+          if(!Om_getXXH128sum(&blob, tgt_file)) {
+            this->_error(L"makeBackup", Om_errReadAccess(L"Target file", tgt_file));
+            has_error = true; break;
+          }
+
+          move_idx.push_back(this->_bck_entry.size());
+          move_key.push_back(blob);
+
+          this->_ModChan->journalEntry(bck_path, entry.path, blob);
+
+        } else if(isdir) {
+
+          // create required directory tree before moving file
+          int32_t result = __dir_cache_path(&bck_dirs, Om_getDirPart(entry.path));
+          if(result != 0) {
+            this->_error(L"makeBackup", Om_errCreate(L"tree in Backup", Om_getDirPart(bck_file), result));
+            has_error = true; break;
+          }
+
+          move_idx.push_back(this->_bck_entry.size());
+          move_key.push_back(blob);
+
+          this->_ModChan->journalEntry(bck_path, entry.path, blob);
+
+        } else {
+
+          // set zip central-directory index
+          entry.cdid = z;
+
+          // add zip entry
+          if(!backup_zip.entryAdd(tgt_file, bck_file)) {
+            this->_error(L"makeBackup", Om_errZipComp(L"Backup from Target file", tgt_file, backup_zip.lastErrorStr()));
+            backup_zip.close(); has_error = true; break;
+          }
+
+          z++; //< increment zip central-directory index
+        }
+
+        bck_node = backup_cfg.addChild(L"cpy");
+        bck_node.setContent(entry.path);
+        bck_node.setAttr(L"cdi", (int)entry.cdid);
+        bck_node.setAttr(L"dir", 0);
+        if(!blob.empty())
+          bck_node.setAttr(L"blob", blob);
+
+        this->_bck_entry.push_back(entry);
+      }
+    }
+
+    // journal is flushed once per batch, always before files are moved
+    if(!move_idx.empty() && (move_idx.size() >= OM_JOURNAL_BATCH || i + 1 == this->_src_entry.size())) {
+
+      this->_ModChan->journalSync();
+
+      for(size_t k = 0; k < move_idx.size(); ++k) {
+
+        OmModEntry_t& moved = this->_bck_entry[move_idx[k]];
+
+        Om_concatPaths(tgt_file, this->_ModChan->targetPath(), moved.path);
+
+        if(dedup) {
+
+          OmWString key = move_key[k];
+
+          int32_t result = this->_ModChan->storeBackupBlob(&key, tgt_file);
+          if(result != 0) {
+            this->_error(L"makeBackup", Om_errMove(L"Backup blob from Target file", tgt_file, result));
+            has_error = true; break;
+          }
+
+          moved.blob = key;
+
+        } else {
+
+          Om_concatPaths(bck_file, bck_root, moved.path);
+
+          // move file, hopping nothing goes wrong
+          int32_t result = Om_fileMove(tgt_file, bck_file); //< risky
+          if(result != 0) {
+            this->_error(L"makeBackup", Om_errMove(L"Backup from Target file", tgt_file, result));
+            has_error = true; break;
+          }
+        }
+      }
+
+      move_idx.clear();
+      move_key.clear();
+
+      if(has_error) break;
+    }
+
+    // call progression callback
+    if(progress_cb) {
+      progress_cur++;
+      this->_op_progress = ((double)progress_cur / progress_tot) * 100;
+      if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
+        this->_log(OM_LOG_WRN, L"makeBackup", L"process aborted by user.");
+        has_abort = true; break;
+      }
+    }
+
+    #ifdef DEBUG
+    Sleep(50); //< for debug
+    #endif
+  }
+
+  // Required data for potential undo
+  this->_bck_path = bck_path;
+
+  this->_bck_isdir = isdir;
+
+  this->_bck_root = bck_root;
+
+  // process aborted, either by user or encountered error
+  if(has_abort || has_error) {
+
+    // no Backup will be available to restore files already moved to blob
+    // store or Backup directory, so they are put back right now
+    for(size_t i = 0; i < this->_bck_entry.size(); ++i) {
+
+      if(OM_HAS_BIT(this->_bck_entry[i].attr, OM_MODENTRY_DEL))
+        continue;
+
+      Om_concatPaths(tgt_file, this->_ModChan->targetPath(), this->_bck_entry[i].path);
+
+      if(!this->_bck_entry[i].blob.empty()) {
+        this->_ModChan->fetchBackupBlob(this->_bck_entry[i].blob, tgt_file);
+        this->_bck_entry[i].blob.clear();
+      } else if(isdir && !Om_pathExists(tgt_file)) {
+        Om_concatPaths(bck_file, bck_root, this->_bck_entry[i].path);
+        if(Om_pathExists(bck_file))
+          Om_fileMove(bck_file, tgt_file);
+      }
+    }
+
+    // delete incomplete Backup
+    if(isdir) {
+      Om_dirDeleteRecursive(bck_path);
+    } else {
+      backup_zip.close();
+      Om_fileDelete(bck_path);
+    }
+
+    this->_bck_entry.clear();
+
+    this->_ModChan->journalOper(OM_JOURNAL_END, bck_path);
+
+    this->_op_backup = false;
+    return has_error ? OM_RESULT_ERROR_BACKP : OM_RESULT_ABORT;
+  }
+
+  // retrieve overlapped Mod list and add to XML config
+  OmUint64Array bck_overlap;
+
+  this->_ModChan->findOverlaps(this, &bck_overlap);
+
+  if(bck_overlap.size()) {
+
+    OmXmlNode xml_overlap = backup_cfg.addChild(L"overlap");
+
+    for(size_t i = 0; i < bck_overlap.size(); ++i)
+      xml_overlap.addChild(L"hash").setContent(Om_uint64ToStr(bck_overlap[i]));
+
+    this->_bck_overlap.assign(bck_overlap.begin(), bck_overlap.end());
+  }
+
+  if(isdir) {
+
+    OmWString cfg_path = bck_path + L"\\ModBack.xml";
+
+    if(!backup_cfg.save(cfg_path)) {
+      this->_error(L"makeBackup", Om_errSave(L"definition file", cfg_path, backup_cfg.lastErrorStr()));
+      has_error = true;
+    }
+
+  } else {
+
+    // get backup definition XML data
+    OmCString xml_data = backup_cfg.data();
+    if(!backup_zip.entryAdd(xml_data.c_str(), xml_data.size(), L"ModBack.xml")) {
+      this->_error(L"makeBackup", Om_errZipComp(L"definition file", L"ModBack.xml", backup_zip.lastErrorStr()));
+      backup_zip.close(); has_error = true;
+    }
+
+    // finalize zip archive
+    backup_zip.close();
+  }
+
+  // here is data to be restored, completed or not
+  this->_has_bck = true;
+
+  this->_ModChan->indexBackup(this);
+
+  // end backup operation
+  this->_op_backup = false;
+
+  if(has_error) {
+    return OM_RESULT_ERROR_BACKP; //< must undo
+  }
+
+  // Backup is complete, from now an interrupted install is undone by
+  // restoring it
+  this->_ModChan->journalOper(OM_JOURNAL_APPLY, bck_path);
+
+  // making report
+  wchar_t done_str[32];
+  swprintf(done_str, 32, L"done in %.2fs", (double)(clock()-time)/CLOCKS_PER_SEC);
+  this->_log(OM_LOG_OK, L"makeBackup", OmWString(done_str) + L", " + Om_formatSizeStr(bytes_skip) + L" unchanged skipped");
+
+  if(isdir)
+    this->_log(OM_LOG_OK, L"makeBackup", L"Backup tree: " + __dir_cache_report(bck_dirs));
+
+
+  return OM_RESULT_OK;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmResult OmModPack::restoreData(Om_progressCb progress_cb, void* user_ptr, bool isundo, bool isrecov)
+{
+  if(!this->_ModChan) {
+    this->_error(L"restoreData", L"no Mod Channel.");
+    this->_op_restore = false;
+    return OM_RESULT_ABORT;
+  }
+
+  if(!this->_has_bck) {
+    if(!isundo) this->_error(L"restoreData", L"Backup data missing.");
+    this->_op_restore = false;
+    return OM_RESULT_ABORT;
+  }
+
+  // start restore operation
+  this->_op_restore = true;
+
+  // initialize chrono
+  clock_t time = clock();
+
+  // initialize progression callback
+  size_t progress_tot = 0, progress_cur = 0;
+  if(progress_cb) {
+    if(isundo) {
+      progress_cur = this->_bck_entry.size();
+      progress_tot = this->_bck_entry.size() * 2; //< item we must restore
+    } else {
+      progress_cur = 0;
+      progress_tot = this->_bck_entry.size(); //< item we must restore
+    }
+    this->_op_progress =((double)progress_cur / progress_tot) * 100;
+    if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
+      this->_op_restore = false;
+      return OM_RESULT_ABORT;
+    }
+  }
+
+  OmArchive backup_zip;
+
+  // verify we have data to restore
+  if(this->_bck_isdir) {
+    if(!Om_isDir(this->_bck_root)) {
+      this->_error(L"restoreData", Om_errNotDir(L"Backup root directory", this->_bck_root));
+      this->_op_restore = false;
+      return OM_RESULT_ERROR;
+    }
+  } else {
+    if(!backup_zip.read(this->_bck_path, OM_READER_MAPPED)) {
+      this->_error(L"restoreData", Om_errLoad(L"Backup archive file", this->_bck_path, backup_zip.lastErrorStr()));
+      this->_op_restore = false;
+      return OM_RESULT_ERROR;
+    }
+  }
+
+  // an interrupted restore is completed at next Channel opening
+  this->_ModChan->journalOper(OM_JOURNAL_RESTORE, this->_bck_path);
+
+  bool has_error = false;
+  bool has_abort = false;
+
+  // restore original files from Backup to Target
+  for(size_t i = 0; i < this->_bck_entry.size(); ++i) {
+
+    if(OM_HAS_BIT(this->_bck_entry[i].attr, OM_MODENTRY_DEL))
+      continue;
+
+    OmWString tgt_file, bck_file;
+    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), this->_bck_entry[i].path);
+
+    if(!this->_bck_entry[i].blob.empty()) {
+
+      // installed file may be a hard link to Library Source, it must be
+      // replaced, not written through
+      int32_t result = __unlink_target(tgt_file, false);
+      if(result != 0) {
+        this->_error(L"restoreData", Om_errDelete(L"linked file in Target", tgt_file, result));
+        has_error = true;
+      } else {
+
+        // blob reference is released whatever the result, when recovering
+        // a missing blob was already restored by the interrupted restore
+        result = this->_ModChan->fetchBackupBlob(this->_bck_entry[i].blob, tgt_file);
+        if(isrecov && result == ERROR_FILE_NOT_FOUND && Om_pathExists(tgt_file))
+          result = 0;
+
+        if(result != 0) {
+          this->_error(L"restoreData", Om_errCopy(L"Backup blob to Target file", tgt_file, result));
+          has_error = true;
+        }
+
+        this->_bck_entry[i].blob.clear();
+      }
+
+    } else if(this->_bck_isdir) {
+
+      Om_concatPaths(bck_file, this->_bck_root, this->_bck_entry[i].path);
+
+      // move file from backup to target, overwriting existing, when
+      // recovering a missing file was already restored by the interrupted
+      // restore
+      int32_t result = 0;
+      if(!isrecov || Om_pathExists(bck_file) || !Om_pathExists(tgt_file))
+        result = Om_fileMove(bck_file, tgt_file);
+
+      if(result != 0) {
+        this->_error(L"restoreData", Om_errMove(L"Backup to Target file", tgt_file, result));
+        has_error = true;
+      }
+
+    } else {
+
+      // installed file may be a hard link to Library Source, it must be
+      // replaced, not written through, before extracting from archive
+      int32_t result = __unlink_target(tgt_file, false);
+      if(result != 0) {
+        this->_error(L"restoreData", Om_errDelete(L"linked file in Target", tgt_file, result));
+        has_error = true;
+      } else if(!backup_zip.entrySave(this->_bck_entry[i].cdid, tgt_file)) { //< TODO: des erreur d'index ici, le cdid est incohrent... data perdue ? mal pars ?
+        this->_error(L"restoreData", Om_errZipExtr(L"Backup to Target file", this->_bck_entry[i].path, backup_zip.lastErrorStr()));
+        has_error = true;
+      }
+    }
+
+    // call progression callback
+    if(progress_cb) {
+      if(isundo) progress_cur--; else progress_cur++;
+      this->_op_progress = ((double)progress_cur / progress_tot) * 100;
+      if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this)))
+        has_abort = true; //< process continue but will return with abort code
+    }
+
+    #ifdef DEBUG
+    Sleep(50); //< for debug
+    #endif
+  }
+
+  // close backup archive file
+  if(!this->_bck_isdir) backup_zip.close();
+
+  // delete added files and/or folders Mod may have created in Target
+  //
+  // the "To Delete" entries are listed according tree hierarchy in depth-first
+  // order, so we walk list in backward to have the proper deletion sequence.
 
-    for(size_t i = 0; i < xml_node_ls.size(); ++i) {
+  size_t i = this->_bck_entry.size();
+  while(i--) {
 
-      OmModEntry_t entry;
-      entry.cdid = xml_node_ls[i].attrAsInt(L"cdi");
-      entry.attr = 0;
-      if(xml_node_ls[i].attrAsInt(L"dir") > 0)
-        entry.attr |= OM_MODENTRY_DIR;
-      entry.path = xml_node_ls[i].content();
+    if(!OM_HAS_BIT(this->_bck_entry[i].attr, OM_MODENTRY_DEL))
+      continue;
 
-      this->_bck_entry.push_back(entry);
-    }
+    OmWString tgt_file;
+    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), this->_bck_entry[i].path);
 
-    backup_cfg.children(xml_node_ls, L"del");
+    // if undo the file may not be installed yet, we prevent warnings
+    if(isundo && !Om_pathExists(tgt_file))
+      continue;
 
-    for(size_t i = 0; i < xml_node_ls.size(); ++i) {
+    if(OM_HAS_BIT(this->_bck_entry[i].attr, OM_MODENTRY_DIR)) {
 
-      OmModEntry_t entry;
-      entry.cdid = -1;
-      entry.attr = OM_MODENTRY_DEL;
-      if(xml_node_ls[i].attrAsInt(L"dir") > 0)
-        entry.attr |= OM_MODENTRY_DIR;
-      // note for me in the future, this does not work properly:
-      // entry.attr = OM_MODENTRY_DEL | (xml_node_ls[i].attrAsInt(L"dir") > 0) ? OM_MODENTRY_DIR : 0;
-      entry.path = xml_node_ls[i].content();
+      // delete folder only if empty
+      if(Om_isDirEmpty(tgt_file)) {
 
-      this->_bck_entry.push_back(entry);
-    }
+        int32_t result = Om_dirDelete(tgt_file);
+        if(result != 0) {
+          // do not throw error, simple warning
+          this->_log(OM_LOG_WRN, L"restoreData", Om_errDelete(L"directory in Target", tgt_file, result));
+        }
+      }
 
-    // retrieve the backup overlap list, they are stored as a list of Hash values
-    // corresponding to package file name
-    if(backup_cfg.hasChild(L"overlap")) {
+    } else {
 
-      OmXmlNodeArray xml_hash_ls;
-      backup_cfg.child(L"overlap").children(xml_hash_ls, L"hash");
+      int32_t result = Om_fileDelete(tgt_file);
+      if(result != 0) {
+        // do not throw error, simple warning
+        this->_log(OM_LOG_WRN, L"restoreData", Om_errDelete(L"file in Target", tgt_file, result));
+      }
+    }
 
-      for(size_t i = 0; i < xml_hash_ls.size(); ++i)
-        this->_bck_overlap.push_back(Om_strToUint64(xml_hash_ls[i].content()));
+    // call progression callback
+    if(progress_cb) {
+      if(isundo) progress_cur--; else progress_cur++;
+      this->_op_progress = ((double)progress_cur / progress_tot) * 100;
+      if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this)))
+        has_abort = true; //< process continue but will return with abort code
     }
 
-  } else {
-    this->_error(L"parseBackup", L"definition not found in location \""+path+L"\"");
-    return false;
+    #ifdef DEBUG
+    Sleep(50); //< for debug
+    #endif
   }
 
-  // ultimately check against already parsed data from the Source
-  if(this->_has_src) {
-
-    if(bck_hash != this->_hash || this->_iden != bck_iden) {
+  // cleanup backup data
+  if(this->_bck_isdir) {
 
-      this->_error(L"parseBackup", L"parsed Backup mismatch already parsed Source \""+path+L"\"");
-      return false;
+    int32_t result = Om_dirDeleteRecursive(this->_bck_path);
+    if(result != 0) {
+      this->_error(L"restoreData", Om_errDelete(L"Backup directories", this->_bck_path, result));
+      has_error = true;
     }
 
   } else {
 
-    this->_hash = bck_hash;
-
-    this->_iden = bck_iden;
+    int32_t result = Om_fileDelete(this->_bck_path);
+    if(result != 0) {
+      this->_error(L"restoreData", Om_errDelete(L"Backup archive file", this->_bck_path, result));
+      has_error = true;
+    }
 
-    // parse other Mod common infos from identity
-    OmWString vers_str;
-    if(Om_parseModIdent(this->_iden, &this->_core, &vers_str, &this->_name))
-      this->_version.parse(vers_str);
   }
 
-  // All appear correct, now finalizing Mod Backup setup
-  this->_bck_path = path;
-
-  this->_bck_isdir = isdir;
+  this->_ModChan->journalOper(OM_JOURNAL_END, this->_bck_path);
 
-  //this->_bck_home = Om_getDirPart(path);
+  // revoke and clean Backup side of this instance
+  this->clearBackup();
 
-  this->_bck_root = bck_root;
+  // making report
+  wchar_t done_str[32];
+  swprintf(done_str, 32, L"done in %.2fs", (double)(clock()-time)/CLOCKS_PER_SEC);
+  this->_log(OM_LOG_OK, L"restoreData", done_str);
 
-  this->_has_bck = true;
+  // end restore operation
+  this->_op_restore = false;
+
+  if(has_abort)
+    return OM_RESULT_ABORT;
+
+  if(has_error)
+    return OM_RESULT_ERROR_RESTO;
 
-  return true;
+  return OM_RESULT_OK;
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-bool OmModPack::backupHasEntry(const OmWString& path, int32_t attr) const
+OmResult OmModPack::applySource(Om_progressCb progress_cb, void* user_ptr)
 {
-  for(size_t i = 0; i < this->_bck_entry.size(); ++i) {
-    if(this->_bck_entry[i].attr == attr)
-      if(this->_bck_entry[i].path == path)
-        return true;
-  }
+  // start at half the total, backup was the first half
+  size_t entry_cnt = this->_src_entry.size();
 
-  return false;
+  OmResult result = this->_apply_source(nullptr, entry_cnt * 2, entry_cnt, progress_cb, user_ptr);
+
+  // on failure Backup is restored, which ends the journaled operation
+  if(result == OM_RESULT_OK && this->_ModChan)
+    this->_ModChan->journalOper(OM_JOURNAL_END, this->_bck_path);
+
+  return result;
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-void OmModPack::getFootprint(OmModEntryArray* footprint) const
+OmResult OmModPack::_apply_source(const OmIndexArray* select, size_t progress_tot, size_t progress_cur, Om_progressCb progress_cb, void* user_ptr)
 {
   if(!this->_ModChan) {
-    //this->_error(L"getFootprint", L"no Mod Channel");
-    return;
+    this->_error(L"applySource", L"no Mod Channel.");
+    this->_op_apply = false;
+    return OM_RESULT_ABORT;
   }
 
-  OmModEntry_t entry;
-  entry.cdid = -1;
+  // start install operation
+  this->_op_apply = true;
 
-  OmWString tgt_file;
+  // initialize chrono
+  clock_t time = clock();
 
-  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+  // either all Source entries or only the selected ones
+  size_t entry_cnt = select ? select->size() : this->_src_entry.size();
 
-    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), this->_src_entry[i].path);
+  // initialize progression callback, remaining steps are the items we
+  // must install
+  if(progress_cb) {
+    this->_op_progress =((double)progress_cur / progress_tot) * 100;
+    if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
+      return OM_RESULT_ABORT;
+    }
+  }
 
-    entry.path = this->_src_entry[i].path;
-    entry.attr = this->_src_entry[i].attr;
+  OmArchive source_zip;
 
-    if(!Om_pathExists(tgt_file))
-      entry.attr |= OM_MODENTRY_DEL;
+  // verify we have source to install
+  if(this->_src_isdir) {
+    if(!Om_isDir(this->_src_root)) {
+      this->_error(L"applySource", Om_errNotDir(L"Source directory", this->_src_root));
+      this->_op_apply = false;
+      return OM_RESULT_ERROR;
+    }
+  } else {
+    if(!source_zip.read(this->_src_path, OM_READER_MAPPED)) {
+      this->_error(L"applySource", Om_errLoad(L"Source archive file", this->_src_path, source_zip.lastErrorStr()));
+      this->_op_apply = false;
+      return OM_RESULT_ERROR;
+    }
+  }
 
-    footprint->push_back(entry);
+  bool has_error = false;
+  bool has_abort = false;
+
+  // initialize apply workers shared context
+  apply_context_t actx;
+  actx.entries = &this->_src_entry;
+  actx.src_path = this->_src_path;
+  actx.src_root = this->_src_root;
+  actx.src_isdir = this->_src_isdir;
+  actx.tgt_root = this->_ModChan->targetPath();
+  actx.inst_mode = this->_ModChan->installMode();
+  actx.can_link = 1;
+  actx.can_clone = 1;
+  actx.bytes_skip = 0;
+  actx.bytes_done = 0;
+  actx.next = 0;
+  actx.done = 0;
+  actx.abort = 0;
+
+  // create the whole Target tree in one pass, archives may not have
+  // explicit directory entries and tree must exist before workers start
+  // since concurrent creation would fail
+  dir_cache_t tgt_dirs;
+  __dir_cache_init(&tgt_dirs, this->_ModChan->targetPath(), false);
+
+  OmWStringArray tgt_tree;
+
+  for(size_t n = 0; n < entry_cnt; ++n) {
+
+    size_t i = select ? (*select)[n] : n;
+
+    if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) {
+      tgt_tree.push_back(this->_src_entry[i].path);
+    } else {
+      OmWString parent = Om_getDirPart(this->_src_entry[i].path);
+      if(!parent.empty()) tgt_tree.push_back(parent);
+    }
   }
-}
 
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-bool OmModPack::hasOverlap(uint64_t hash) const
-{
-  // you don't like raw loops ? I LOVE row loops...
-  for(size_t i = 0; i < this->_bck_overlap.size(); ++i)
-    if(this->_bck_overlap[i] == hash)
-      return true;
+  OmWString tgt_fail;
+  int32_t result = __dir_cache_tree(&tgt_dirs, tgt_tree, &tgt_fail);
+  if(result != 0) {
+    this->_error(L"applySource", Om_errCreate(L"tree in Target", tgt_fail, result));
+    has_error = true;
+  }
 
-  return false;
-}
+  // build the files jobs queue
+  for(size_t n = 0; n < entry_cnt && !has_error; ++n) {
 
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-bool OmModPack::canOverlap(const OmModPack* other) const
-{
-  // you don't like raw loops ? I LOVE row loops...
-  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+    size_t i = select ? (*select)[n] : n;
 
-    if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) //< we don't care directories
-      continue;
+    if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) {
 
-    for(size_t j = 0; j < other->_src_entry.size(); ++j) {
+      // call progression callback
+      if(progress_cb) {
+        progress_cur++;
+        this->_op_progress = ((double)progress_cur / progress_tot) * 100;
+        if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
+          this->_log(OM_LOG_WRN, L"applySource", L"process aborted by user.");
+          has_abort = true; break;
+        }
+      }
 
-      if(OM_HAS_BIT(other->_src_entry[j].attr, OM_MODENTRY_DIR)) //< we don't care directories
-        continue;
+    } else {
 
-      // same path mean overlap
-      if(this->_src_entry[i].path == other->_src_entry[j].path)
-        return true;
+      apply_job_t job;
+      job.index = i;
+      job.size = this->_src_entry[i].size;
+
+      actx.queue.push_back(job);
     }
   }
 
-  return false;
-}
+  // close zip file, workers use their own reader
+  if(!this->_src_isdir) source_zip.close();
 
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-bool OmModPack::canOverlap(const OmModEntryArray& footprint) const
-{
-  // you don't like raw loops ? I LOVE row loops...
-  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+  if(!has_error && !has_abort && actx.queue.size()) {
 
-    if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) //< we don't care directories
-      continue;
+    // process largest files first so workers end at roughly the same time
+    std::sort(actx.queue.begin(), actx.queue.end(), __apply_job_compare);
 
-    for(size_t j = 0; j < footprint.size(); ++j) {
+    InitializeCriticalSection(&actx.lock);
 
-      if(OM_HAS_BIT(footprint[j].attr, OM_MODENTRY_DIR)) //< we don't care directories
-        continue;
+    // worker threads are taken from channel budget shared with other
+    // concurrent operations
+    size_t thread_cnt = APPLY_MAX_THREADS;
+    if(thread_cnt > actx.queue.size()) thread_cnt = actx.queue.size();
 
-      // same path mean overlap
-      if(this->_src_entry[i].path == footprint[j].path)
-        return true;
+    thread_cnt = this->_ModChan->acquireWorkers(thread_cnt);
+    if(thread_cnt > APPLY_MAX_THREADS) thread_cnt = APPLY_MAX_THREADS;
+
+    HANDLE hth[APPLY_MAX_THREADS];
+    DWORD hth_cnt = 0;
+
+    for(size_t t = 0; t < thread_cnt; ++t) {
+      hth[hth_cnt] = Om_threadCreate(__apply_run_fn, &actx);
+      if(hth[hth_cnt]) hth_cnt++;
+    }
+
+    if(hth_cnt) {
+
+      LONG reported = 0;
+
+      // wait for workers while forwarding progression, the callback is
+      // always called from this thread, as it was with serial extraction
+      bool running = true;
+      while(running) {
+
+        running = (WaitForMultipleObjects(hth_cnt, hth, true, 50) == WAIT_TIMEOUT);
+
+        while(reported < actx.done) {
+
+          reported++;
+
+          // call progression callback
+          if(progress_cb && !has_abort) {
+            progress_cur++;
+            this->_op_progress = ((double)progress_cur / progress_tot) * 100;
+            if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
+              this->_log(OM_LOG_WRN, L"applySource", L"process aborted by user.");
+              InterlockedExchange(&actx.abort, 1);
+              has_abort = true;
+            }
+          }
+        }
+      }
+
+      for(DWORD t = 0; t < hth_cnt; ++t)
+        CloseHandle(hth[t]);
+
+    } else {
+
+      // unable to create threads, process in current thread
+      __apply_run_fn(&actx);
+    }
+
+    this->_ModChan->releaseWorkers(thread_cnt);
+
+    DeleteCriticalSection(&actx.lock);
+
+    if(!actx.error.empty()) {
+      this->_error(L"applySource", actx.error);
+      has_error = true;
     }
   }
 
-  return false;
+  // end install operation
+  this->_op_apply = false;
+
+  if(has_abort || has_error) {
+    return has_error ? OM_RESULT_ERROR_APPLY : OM_RESULT_ABORT; //< must undo
+  }
+
+  // making report
+  wchar_t done_str[32];
+  swprintf(done_str, 32, L"done in %.2fs", (double)(clock()-time)/CLOCKS_PER_SEC);
+  this->_log(OM_LOG_OK, L"applySource", OmWString(done_str) + L", " + Om_formatSizeStr(actx.bytes_done) +
+                                        L" written, " + Om_formatSizeStr(actx.bytes_skip) + L" unchanged skipped");
+  this->_log(OM_LOG_OK, L"applySource", L"Target tree: " + __dir_cache_report(tgt_dirs));
+
+  return OM_RESULT_OK;
 }
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
-OmResult OmModPack::makeBackup(Om_progressCb progress_cb, void* user_ptr)
+OmResult OmModPack::upgradeFrom(OmModPack* ModPack, Om_progressCb progress_cb, void* user_ptr)
 {
-  if(this->_has_bck)
+  if(!this->_ModChan || !this->_has_src || this->_has_bck)
     return OM_RESULT_ABORT;
 
-  if(!this->_ModChan) {
-    this->_error(L"makeBackup", L"no Mod Channel");
-    this->_op_backup = false;
+  if(!ModPack || ModPack == this || !ModPack->_has_bck || !ModPack->_has_src)
+    return OM_RESULT_ABORT;
+
+  // Mods installed over the replaced one rely on its Backup, in this case
+  // a full restore is required
+  if(this->_ModChan->isOverlapped(ModPack))
     return OM_RESULT_ABORT;
+
+  bool isdir = ModPack->_bck_isdir;
+
+  OmWString bck_root;
+
+  OmWString bck_name = Om_getFilePart(this->_src_path);
+
+  OmWString bck_path = this->_ModChan->backupPath() + L"\\";
+
+  if(isdir) {
+    bck_path += bck_name;
+    bck_root = bck_path + L"\\" + BACKUP_DATA_ROOT_DIR;
+  } else {
+    bck_name += L"." OM_BCK_FILE_EXT;
+    bck_path += bck_name;
+    bck_root = BACKUP_DATA_ROOT_DIR;
   }
 
-  if(!this->_has_src) {
-    this->_error(L"makeBackup", L"Source data missing");
-    this->_op_backup = false;
+  // both Backups cannot share the same location
+  if(Om_namesMatches(bck_path, ModPack->_bck_path) || Om_pathExists(bck_path))
     return OM_RESULT_ABORT;
-  }
+
+  OmWString old_root;
+  if(isdir) Om_concatPaths(old_root, ModPack->_bck_path, BACKUP_DATA_ROOT_DIR);
 
   // start backup operation
   this->_op_backup = true;
@@ -1038,55 +2606,70 @@ OmResult OmModPack::makeBackup(Om_progressCb progress_cb, void* user_ptr)
   // initialize chrono
   clock_t time = clock();
 
-  // initialize progression callback
+  // initialize progression callback, first half is the Backup transfer,
+  // second half covers replaced files restore then install, total is kept
+  // so progression never goes back between phases
   size_t progress_tot = 0, progress_cur = 0;
   if(progress_cb) {
-    progress_tot = this->_src_entry.size() * 2;   //< backup + install
-    progress_cur = 0;
-    this->_op_progress =((double)progress_cur / progress_tot) * 100;
+    progress_tot = (ModPack->_bck_entry.size() + this->_src_entry.size()) * 2;
+    this->_op_progress = 0;
     if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
+      this->_op_backup = false;
       return OM_RESULT_ABORT;
     }
   }
 
-  OmArchive backup_zip;
-
-  bool isdir = (this->_ModChan->backupCompMethod() < 0);
-
-  OmWString bck_root;
-
-  OmWString bck_name = Om_getFilePart(this->_src_path);
-
-  OmWString bck_path = this->_ModChan->backupPath() + L"\\";
+  OmArchive backup_zip, old_zip;
 
   if(isdir) {
 
-    bck_path += bck_name;
-
-    bck_root = bck_path + L"\\" + BACKUP_DATA_ROOT_DIR;
-
     int32_t result = Om_dirCreateRecursive(bck_root);
     if(result != 0) {
-      this->_error(L"makeBackup", Om_errCreate(L"initial Backup directories", bck_root, result));
+      this->_error(L"upgradeFrom", Om_errCreate(L"initial Backup directories", bck_root, result));
       this->_op_backup = false;
       return OM_RESULT_ERROR;
     }
 
   } else {
 
-    bck_name += L"." OM_BCK_FILE_EXT;
-    bck_path += bck_name;
-
-    bck_root = BACKUP_DATA_ROOT_DIR;
+    if(!old_zip.read(ModPack->_bck_path, OM_READER_MAPPED)) {
+      this->_error(L"upgradeFrom", Om_errLoad(L"Backup archive file", ModPack->_bck_path, old_zip.lastErrorStr()));
+      this->_op_backup = false;
+      return OM_RESULT_ERROR;
+    }
 
-    // initialize zip archive
     if(!backup_zip.write(bck_path, this->_ModChan->backupCompMethod(), this->_ModChan->backupCompLevel())) {
-      this->_error(L"makeBackup", Om_errInit(L"Backup archive file", bck_path, backup_zip.lastErrorStr()));
+      this->_error(L"upgradeFrom", Om_errInit(L"Backup archive file", bck_path, backup_zip.lastErrorStr()));
+      old_zip.close();
       this->_op_backup = false;
       return OM_RESULT_ERROR;
     }
   }
 
+  // Target files moved to new Backup are journaled so they can be put back
+  // if process ends unexpectedly
+  this->_ModChan->journalOper(OM_JOURNAL_BACKUP, bck_path, isdir ? bck_root : OmWString());
+
+  // index entries by path, new Source paths include their parent
+  // directories so Backup directories still in use are kept
+  std::unordered_map<uint64_t, size_t> old_src, old_bck;
+  std::unordered_set<uint64_t> new_src;
+
+  for(size_t i = 0; i < ModPack->_src_entry.size(); ++i)
+    old_src[Om_getPathHash(ModPack->_src_entry[i].path)] = i;
+
+  for(size_t i = 0; i < ModPack->_bck_entry.size(); ++i)
+    old_bck[Om_getPathHash(ModPack->_bck_entry[i].path)] = i;
+
+  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+    OmWString path = this->_src_entry[i].path;
+    while(!path.empty() && new_src.insert(Om_getPathHash(path)).second)
+      path = Om_getDirPart(path);
+  }
+
+  // compare entries CRC-32, only possible for archive Sources
+  bool has_crc = !this->_src_isdir && !ModPack->_src_isdir;
+
   // initialize backup XML config
   OmXmlConf backup_cfg(OM_XMAGIC_BCK);
 
@@ -1097,505 +2680,483 @@ OmResult OmModPack::makeBackup(Om_progressCb progress_cb, void* user_ptr)
   bool has_error = false;
   bool has_abort = false;
 
-  OmWString tgt_file, bck_file;
-  OmXmlNode bck_node;
-
-  for(size_t i = 0, z = 0; i < this->_src_entry.size(); ++i) {
+  bool dedup = this->_ModChan->backupDedup();
 
-    OmModEntry_t entry;
-    entry.path = this->_src_entry[i].path;
-    entry.attr = this->_src_entry[i].attr;
-    entry.cdid = -1; //< invalid zip central-directory index
+  uint64_t bytes_skip = 0;
 
-    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), entry.path);
-    Om_concatPaths(bck_file, bck_root, entry.path);
+  // directory Backup tree is created as entries come
+  dir_cache_t bck_dirs;
+  __dir_cache_init(&bck_dirs, bck_root, true);
 
-    if(!Om_pathExists(tgt_file)) {
+  OmIndexArray applies;   //< new Source entries to be written
+  OmIndexArray removes;   //< replaced Backup entries to be restored
 
-      // file or directory does not exists in Target, this is a added/created file
-      // by the Mod that must be deleted at uninstall
-      entry.attr |= OM_MODENTRY_DEL;
+  OmWString tgt_file, bck_file, old_file, src_file;
+  OmXmlNode bck_node;
 
-      bck_node = backup_cfg.addChild(L"del");
-      bck_node.setContent(entry.path);
-      bck_node.setAttr(L"cdi", (int)entry.cdid);
-      bck_node.setAttr(L"dir", OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR) ? 1 : 0 );
+  size_t z = 0; //< zip central-directory index
 
-      this->_bck_entry.push_back(entry);
+  // 1. Backup entries of replaced Mod are transferred to new Backup if still
+  //    used by new Source, otherwise they are restored later. Replaced Backup
+  //    is left untouched until new one is saved
 
-    } else {
+  for(size_t i = 0; i < ModPack->_bck_entry.size(); ++i) {
 
-      if(OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR)) {
+    const OmModEntry_t& old_entry = ModPack->_bck_entry[i];
 
-        if(this->_ModChan->backupEntryExists(entry.path, entry.attr)) {
+    if(!new_src.count(Om_getPathHash(old_entry.path))) {
+      removes.push_back(i);
+      continue;
+    }
 
-          // directory was created by another Mod, in this case we add it as to be
-          // deleted by this one too so we can delete unused shared folders if empty.
-          entry.attr |= OM_MODENTRY_DEL;
+    OmModEntry_t entry = old_entry;
 
-          bck_node = backup_cfg.addChild(L"del");
-          bck_node.setContent(entry.path);
-          bck_node.setAttr(L"cdi", (int)entry.cdid);
-          bck_node.setAttr(L"dir", 1);
+    if(OM_HAS_BIT(entry.attr, OM_MODENTRY_DEL)) {
 
-          this->_bck_entry.push_back(entry);
-        }
+      bck_node = backup_cfg.addChild(L"del");
 
-        if(isdir) {
+    } else {
 
-          int32_t result = Om_dirCreate(bck_file);
-          if(result != 0) {
-            this->_error(L"makeBackup", Om_errCreate(L"directory in Backup", bck_file, result));
-            has_error = true; break;
-          }
-        }
+      if(!entry.blob.empty()) {
 
-      } else {
+        // blob is now referenced by both until old Backup is cleared
+        this->_ModChan->acquireBackupBlob(entry.blob);
 
-        if(isdir) {
+      } else if(isdir) {
 
-          // create required directory tree before moving file
-          OmWString bck_tree = Om_getDirPart(bck_file);
+        Om_concatPaths(old_file, old_root, entry.path);
+        Om_concatPaths(bck_file, bck_root, entry.path);
 
-          if(!Om_isDir(bck_tree)) {
-            int32_t result = Om_dirCreateRecursive(bck_tree);
-            if(result != 0) {
-              this->_error(L"makeBackup", Om_errCreate(L"tree in Backup", bck_tree, result));
-              has_error = true; break;
-            }
-          }
+        int32_t result = __dir_cache_path(&bck_dirs, Om_getDirPart(entry.path));
 
-          // move file, hopping nothing goes wrong
-          int32_t result = Om_fileMove(tgt_file, bck_file); //< risky
-          if(result != 0) {
-            this->_error(L"makeBackup", Om_errMove(L"Backup from Target file", tgt_file, result));
-            has_error = true; break;
-          }
+        // both Backups share the same volume, file is linked rather than
+        // copied when possible
+        if(result == 0 && Om_fileLink(old_file, bck_file) != 0)
+          result = Om_fileCopy(old_file, bck_file, false);
 
-        } else {
+        if(result != 0) {
+          this->_error(L"upgradeFrom", Om_errCopy(L"Backup file", old_file, result));
+          has_error = true; break;
+        }
 
-          // set zip central-directory index
-          entry.cdid = z;
+      } else {
 
-          // add zip entry
-          if(!backup_zip.entryAdd(tgt_file, bck_file)) {
-            this->_error(L"makeBackup", Om_errZipComp(L"Backup from Target file", tgt_file, backup_zip.lastErrorStr()));
-            backup_zip.close(); has_error = true; break;
-          }
+        Om_concatPaths(bck_file, bck_root, entry.path);
 
-          z++; //< increment zip central-directory index
+        if(!backup_zip.entryCopy(old_zip, old_entry.cdid, bck_file)) {
+          this->_error(L"upgradeFrom", Om_errZipComp(L"Backup file", old_entry.path, backup_zip.lastErrorStr()));
+          has_error = true; break;
         }
 
-        bck_node = backup_cfg.addChild(L"cpy");
-        bck_node.setContent(entry.path);
-        bck_node.setAttr(L"cdi", (int)entry.cdid);
-        bck_node.setAttr(L"dir", 0);
-
-        this->_bck_entry.push_back(entry);
+        entry.cdid = z++;
       }
+
+      bck_node = backup_cfg.addChild(L"cpy");
     }
 
+    bck_node.setContent(entry.path);
+    bck_node.setAttr(L"cdi", (int)entry.cdid);
+    bck_node.setAttr(L"dir", OM_HAS_BIT(entry.attr, OM_MODENTRY_DIR) ? 1 : 0);
+    if(!entry.blob.empty())
+      bck_node.setAttr(L"blob", entry.blob);
+
+    this->_bck_entry.push_back(entry);
+
     // call progression callback
     if(progress_cb) {
       progress_cur++;
       this->_op_progress = ((double)progress_cur / progress_tot) * 100;
       if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
-        this->_log(OM_LOG_WRN, L"makeBackup", L"process aborted by user.");
+        this->_log(OM_LOG_WRN, L"upgradeFrom", L"process aborted by user.");
         has_abort = true; break;
       }
     }
-
-    #ifdef DEBUG
-    Sleep(50); //< for debug
-    #endif
   }
 
-  // Required data for potential undo
-  this->_bck_path = bck_path;
-
-  this->_bck_isdir = isdir;
-
-  this->_bck_root = bck_root;
-
-  // process aborted, either by user or encountered error
-  if(has_abort || has_error) {
-    this->_op_backup = false;
-    return has_error ? OM_RESULT_ERROR_BACKP : OM_RESULT_ABORT;
-  }
+  // 2. new Source entries either already backed up, identical to replaced
+  //    version, or added and backed up as makeBackup does
 
-  // retrieve overlapped Mod list and add to XML config
-  OmUint64Array bck_overlap;
+  for(size_t i = 0; i < this->_src_entry.size() && !has_error && !has_abort; ++i) {
 
-  this->_ModChan->findOverlaps(this, &bck_overlap);
+    const OmModEntry_t& src_entry = this->_src_entry[i];
 
-  if(bck_overlap.size()) {
+    uint64_t hash = Om_getPathHash(src_entry.path);
 
-    OmXmlNode xml_overlap = backup_cfg.addChild(L"overlap");
+    bool is_dir = OM_HAS_BIT(src_entry.attr, OM_MODENTRY_DIR);
 
-    for(size_t i = 0; i < bck_overlap.size(); ++i)
-      xml_overlap.addChild(L"hash").setContent(Om_uint64ToStr(bck_overlap[i]));
+    // same content in both versions, Target is left as is
+    bool is_same = false;
+    if(has_crc && !is_dir) {
+      std::unordered_map<uint64_t, size_t>::const_iterator it = old_src.find(hash);
+      if(it != old_src.end()) {
+        const OmModEntry_t& old_entry = ModPack->_src_entry[it->second];
+        is_same = (old_entry.size == src_entry.size && old_entry.crc == src_entry.crc);
+      }
+    }
 
-    this->_bck_overlap.assign(bck_overlap.begin(), bck_overlap.end());
-  }
+    if(old_bck.count(hash)) {
 
-  if(isdir) {
+      // original data already in Backup, only write what changed
+      if(is_same) {
+        bytes_skip += src_entry.size;
+      } else if(!is_dir) {
+        applies.push_back(i);
+      }
 
-    OmWString cfg_path = bck_path + L"\\ModBack.xml";
+    } else if(is_same) {
 
-    if(!backup_cfg.save(cfg_path)) {
-      this->_error(L"makeBackup", Om_errSave(L"definition file", cfg_path, backup_cfg.lastErrorStr()));
-      has_error = true;
-    }
+      // replaced version did not change this file, new one does not either
+      bytes_skip += src_entry.size;
 
-  } else {
+    } else {
 
-    // get backup definition XML data
-    OmCString xml_data = backup_cfg.data();
-    if(!backup_zip.entryAdd(xml_data.c_str(), xml_data.size(), L"ModBack.xml")) {
-      this->_error(L"makeBackup", Om_errZipComp(L"definition file", L"ModBack.xml", backup_zip.lastErrorStr()));
-      backup_zip.close(); has_error = true;
-    }
+      OmModEntry_t entry;
+      entry.path = src_entry.path;
+      entry.attr = src_entry.attr;
+      entry.cdid = -1;
+      entry.size = src_entry.size;
+      entry.crc = src_entry.crc;
 
-    // finalize zip archive
-    backup_zip.close();
-  }
+      Om_concatPaths(tgt_file, this->_ModChan->targetPath(), entry.path);
+      Om_concatPaths(bck_file, bck_root, entry.path);
 
-  // here is data to be restored, completed or not
-  this->_has_bck = true;
+      if(this->_src_isdir)
+        Om_concatPaths(src_file, this->_src_root, entry.path);
 
-  // end backup operation
-  this->_op_backup = false;
+      bool has_node = true;
 
-  if(has_error) {
-    return OM_RESULT_ERROR_BACKP; //< must undo
-  }
+      if(!Om_pathExists(tgt_file)) {
 
-  // making report
-  wchar_t done_str[32];
-  swprintf(done_str, 32, L"done in %.2fs", (double)(clock()-time)/CLOCKS_PER_SEC);
-  this->_log(OM_LOG_OK, L"makeBackup", done_str);
+        // added by the Mod, must be deleted at uninstall
+        entry.attr |= OM_MODENTRY_DEL;
+        bck_node = backup_cfg.addChild(L"del");
+        applies.push_back(i);
 
+      } else if(is_dir) {
 
-  return OM_RESULT_OK;
-}
+        // directory created by another Mod, deleted by this one too if empty
+        if(this->_ModChan->backupEntryExists(entry.path, entry.attr)) {
+          entry.attr |= OM_MODENTRY_DEL;
+          bck_node = backup_cfg.addChild(L"del");
+        } else {
+          has_node = false;
+        }
 
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-OmResult OmModPack::restoreData(Om_progressCb progress_cb, void* user_ptr, bool isundo)
-{
-  if(!this->_ModChan) {
-    this->_error(L"restoreData", L"no Mod Channel.");
-    this->_op_restore = false;
-    return OM_RESULT_ABORT;
-  }
+      } else if(!this->_ModChan->backupEntryExists(entry.path, 0) &&
+                !this->_ModChan->backupEntryExists(entry.path, OM_MODENTRY_DEL) &&
+                __entry_unchanged(src_entry, this->_src_isdir, src_file, tgt_file)) {
 
-  if(!this->_has_bck) {
-    if(!isundo) this->_error(L"restoreData", L"Backup data missing.");
-    this->_op_restore = false;
-    return OM_RESULT_ABORT;
-  }
+        bytes_skip += entry.size;
+        has_node = false;
 
-  // start restore operation
-  this->_op_restore = true;
+      } else {
 
-  // initialize chrono
-  clock_t time = clock();
+        if(dedup) {
 
-  // initialize progression callback
-  size_t progress_tot = 0, progress_cur = 0;
-  if(progress_cb) {
-    if(isundo) {
-      progress_cur = this->_bck_entry.size();
-      progress_tot = this->_bck_entry.size() * 2; //< item we must restore
-    } else {
-      progress_cur = 0;
-      progress_tot = this->_bck_entry.size(); //< item we must restore
-    }
-    this->_op_progress =((double)progress_cur / progress_tot) * 100;
-    if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
-      this->_op_restore = false;
-      return OM_RESULT_ABORT;
-    }
-  }
+          // the key is computed first as it must be journaled before file
+          // is moved
+          if(!Om_getXXH128sum(&entry.blob, tgt_file)) {
+            this->_error(L"upgradeFrom", Om_errReadAccess(L"Target file", tgt_file));
+            has_error = true; break;
+          }
 
-  OmArchive backup_zip;
+          this->_ModChan->journalEntry(bck_path, entry.path, entry.blob);
+          this->_ModChan->journalSync();
 
-  // verify we have data to restore
-  if(this->_bck_isdir) {
-    if(!Om_isDir(this->_bck_root)) {
-      this->_error(L"restoreData", Om_errNotDir(L"Backup root directory", this->_bck_root));
-      this->_op_restore = false;
-      return OM_RESULT_ERROR;
-    }
-  } else {
-    if(!backup_zip.read(this->_bck_path)) {
-      this->_error(L"restoreData", Om_errLoad(L"Backup archive file", this->_bck_path, backup_zip.lastErrorStr()));
-      this->_op_restore = false;
-      return OM_RESULT_ERROR;
-    }
-  }
+          int32_t result = this->_ModChan->storeBackupBlob(&entry.blob, tgt_file);
+          if(result != 0) {
+            this->_error(L"upgradeFrom", Om_errMove(L"Backup blob from Target file", tgt_file, result));
+            has_error = true; break;
+          }
 
-  bool has_error = false;
-  bool has_abort = false;
+        } else if(isdir) {
 
-  // restore original files from Backup to Target
-  for(size_t i = 0; i < this->_bck_entry.size(); ++i) {
+          int32_t result = __dir_cache_path(&bck_dirs, Om_getDirPart(entry.path));
 
-    if(OM_HAS_BIT(this->_bck_entry[i].attr, OM_MODENTRY_DEL))
-      continue;
+          // few files are moved here, journal is flushed for each
+          if(result == 0) {
+            this->_ModChan->journalEntry(bck_path, entry.path, OmWString());
+            this->_ModChan->journalSync();
+            result = Om_fileMove(tgt_file, bck_file);
+          }
 
-    OmWString tgt_file, bck_file;
-    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), this->_bck_entry[i].path);
+          if(result != 0) {
+            this->_error(L"upgradeFrom", Om_errMove(L"Backup from Target file", tgt_file, result));
+            has_error = true; break;
+          }
 
-    if(this->_bck_isdir) {
+        } else {
 
-      Om_concatPaths(bck_file, this->_bck_root, this->_bck_entry[i].path);
+          if(!backup_zip.entryAdd(tgt_file, bck_file)) {
+            this->_error(L"upgradeFrom", Om_errZipComp(L"Backup from Target file", tgt_file, backup_zip.lastErrorStr()));
+            has_error = true; break;
+          }
 
-      // move file from backup to target, overwriting existing
-      int32_t result = Om_fileMove(bck_file, tgt_file);
-      if(result != 0) {
-        this->_error(L"restoreData", Om_errMove(L"Backup to Target file", tgt_file, result));
-        has_error = true;
+          entry.cdid = z++;
+        }
+
+        bck_node = backup_cfg.addChild(L"cpy");
+        applies.push_back(i);
       }
 
-    } else {
+      if(has_node) {
 
-      // extract from backup archive to target, overwriting existing
-      if(!backup_zip.entrySave(this->_bck_entry[i].cdid, tgt_file)) { //< TODO: des erreur d'index ici, le cdid est incohrent... data perdue ? mal pars ?
-        this->_error(L"restoreData", Om_errZipExtr(L"Backup to Target file", this->_bck_entry[i].path, backup_zip.lastErrorStr()));
-        has_error = true;
+        bck_node.setContent(entry.path);
+        bck_node.setAttr(L"cdi", (int)entry.cdid);
+        bck_node.setAttr(L"dir", is_dir ? 1 : 0);
+        if(!entry.blob.empty())
+          bck_node.setAttr(L"blob", entry.blob);
+
+        this->_bck_entry.push_back(entry);
       }
     }
 
     // call progression callback
     if(progress_cb) {
-      if(isundo) progress_cur--; else progress_cur++;
+      progress_cur++;
       this->_op_progress = ((double)progress_cur / progress_tot) * 100;
-      if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this)))
-        has_abort = true; //< process continue but will return with abort code
+      if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
+        this->_log(OM_LOG_WRN, L"upgradeFrom", L"process aborted by user.");
+        has_abort = true; break;
+      }
     }
-
-    #ifdef DEBUG
-    Sleep(50); //< for debug
-    #endif
   }
 
-  // close backup archive file
-  if(!this->_bck_isdir) backup_zip.close();
+  // 3. new Backup definition is saved before anything is removed from the
+  //    replaced one, so at any point one of them holds original data
 
-  // delete added files and/or folders Mod may have created in Target
-  //
-  // the "To Delete" entries are listed according tree hierarchy in depth-first
-  // order, so we walk list in backward to have the proper deletion sequence.
+  if(!has_error && !has_abort) {
 
-  size_t i = this->_bck_entry.size();
-  while(i--) {
+    // retrieve overlapped Mod list and add to XML config, replaced Mod is
+    // still indexed and must be ignored
+    OmPModPackArray overlaps;
 
-    if(!OM_HAS_BIT(this->_bck_entry[i].attr, OM_MODENTRY_DEL))
-      continue;
+    this->_ModChan->findOverlaps(this, &overlaps);
 
-    OmWString tgt_file;
-    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), this->_bck_entry[i].path);
+    OmUint64Array bck_overlap;
 
-    // if undo the file may not be installed yet, we prevent warnings
-    if(isundo && !Om_pathExists(tgt_file))
-      continue;
+    for(size_t i = 0; i < overlaps.size(); ++i)
+      if(overlaps[i] != ModPack)
+        bck_overlap.push_back(overlaps[i]->hash());
 
-    if(OM_HAS_BIT(this->_bck_entry[i].attr, OM_MODENTRY_DIR)) {
+    if(bck_overlap.size()) {
 
-      // delete folder only if empty
-      if(Om_isDirEmpty(tgt_file)) {
+      OmXmlNode xml_overlap = backup_cfg.addChild(L"overlap");
 
-        int32_t result = Om_dirDelete(tgt_file);
-        if(result != 0) {
-          // do not throw error, simple warning
-          this->_log(OM_LOG_WRN, L"restoreData", Om_errDelete(L"directory in Target", tgt_file, result));
-        }
+      for(size_t i = 0; i < bck_overlap.size(); ++i)
+        xml_overlap.addChild(L"hash").setContent(Om_uint64ToStr(bck_overlap[i]));
+    }
+
+    if(isdir) {
+
+      OmWString cfg_path = bck_path + L"\\ModBack.xml";
+
+      if(!backup_cfg.save(cfg_path)) {
+        this->_error(L"upgradeFrom", Om_errSave(L"definition file", cfg_path, backup_cfg.lastErrorStr()));
+        has_error = true;
       }
 
     } else {
 
-      int32_t result = Om_fileDelete(tgt_file);
-      if(result != 0) {
-        // do not throw error, simple warning
-        this->_log(OM_LOG_WRN, L"restoreData", Om_errDelete(L"file in Target", tgt_file, result));
+      OmCString xml_data = backup_cfg.data();
+      if(!backup_zip.entryAdd(xml_data.c_str(), xml_data.size(), L"ModBack.xml")) {
+        this->_error(L"upgradeFrom", Om_errZipComp(L"definition file", L"ModBack.xml", backup_zip.lastErrorStr()));
+        has_error = true;
       }
-    }
 
-    // call progression callback
-    if(progress_cb) {
-      if(isundo) progress_cur--; else progress_cur++;
-      this->_op_progress = ((double)progress_cur / progress_tot) * 100;
-      if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this)))
-        has_abort = true; //< process continue but will return with abort code
+      // finalize zip archive, central directory is written here
+      if(!backup_zip.close() && !has_error) {
+        this->_error(L"upgradeFrom", Om_errSave(L"Backup archive file", bck_path, backup_zip.lastErrorStr()));
+        has_error = true;
+      }
     }
 
-    #ifdef DEBUG
-    Sleep(50); //< for debug
-    #endif
+    if(!has_error)
+      this->_bck_overlap.assign(bck_overlap.begin(), bck_overlap.end());
   }
 
-  // cleanup backup data
-  if(this->_bck_isdir) {
+  if(has_error || has_abort) {
 
-    int32_t result = Om_dirDeleteRecursive(this->_bck_path);
-    if(result != 0) {
-      this->_error(L"restoreData", Om_errDelete(L"Backup directories", this->_bck_path, result));
-      has_error = true;
-    }
+    // nothing was written to Target yet, put everything back in place so
+    // replaced Mod stays installed as it was, transferred files are linked
+    // or copied so replaced Backup is still complete
+    for(size_t i = 0; i < this->_bck_entry.size(); ++i) {
 
-  } else {
+      const OmModEntry_t& entry = this->_bck_entry[i];
 
-    int32_t result = Om_fileDelete(this->_bck_path);
-    if(result != 0) {
-      this->_error(L"restoreData", Om_errDelete(L"Backup archive file", this->_bck_path, result));
-      has_error = true;
+      if(OM_HAS_BIT(entry.attr, OM_MODENTRY_DEL) || old_bck.count(Om_getPathHash(entry.path)))
+        continue;
+
+      Om_concatPaths(tgt_file, this->_ModChan->targetPath(), entry.path);
+
+      if(!entry.blob.empty()) {
+        this->_ModChan->fetchBackupBlob(entry.blob, tgt_file);
+        this->_bck_entry[i].blob.clear();
+      } else if(isdir) {
+        Om_concatPaths(bck_file, bck_root, entry.path);
+        Om_fileMove(bck_file, tgt_file);
+      }
     }
 
-  }
+    // blobs still referenced are transferred ones
+    for(size_t i = 0; i < this->_bck_entry.size(); ++i)
+      if(!this->_bck_entry[i].blob.empty())
+        this->_ModChan->releaseBackupBlob(this->_bck_entry[i].blob, false);
 
-  // revoke and clean Backup side of this instance
-  this->clearBackup();
+    this->_bck_entry.clear();
+    this->_bck_overlap.clear();
 
-  // making report
-  wchar_t done_str[32];
-  swprintf(done_str, 32, L"done in %.2fs", (double)(clock()-time)/CLOCKS_PER_SEC);
-  this->_log(OM_LOG_OK, L"restoreData", done_str);
+    if(isdir) {
+      Om_dirDeleteRecursive(bck_path);
+    } else {
+      backup_zip.close();
+      old_zip.close();
+      Om_fileDelete(bck_path);
+    }
 
-  // end restore operation
-  this->_op_restore = false;
-
-  if(has_abort)
-    return OM_RESULT_ABORT;
-
-  if(has_error)
-    return OM_RESULT_ERROR_RESTO;
+    this->_ModChan->journalOper(OM_JOURNAL_END, bck_path);
 
-  return OM_RESULT_OK;
-}
+    this->_op_backup = false;
 
-///
-///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
-///
-OmResult OmModPack::applySource(Om_progressCb progress_cb, void* user_ptr)
-{
-  if(!this->_ModChan) {
-    this->_error(L"applySource", L"no Mod Channel.");
-    this->_op_apply = false;
-    return OM_RESULT_ABORT;
+    return has_error ? OM_RESULT_ERROR_BACKP : OM_RESULT_ABORT;
   }
 
-  // start install operation
-  this->_op_apply = true;
+  this->_bck_path = bck_path;
 
-  // initialize chrono
-  clock_t time = clock();
+  this->_bck_isdir = isdir;
 
-  // initialize progression callback
-  size_t progress_tot = 0, progress_cur = 0;
-  if(progress_cb) {
-    progress_tot = this->_src_entry.size() * 2;   //< item we must install
-    progress_cur = this->_src_entry.size();       //< start at half the total, backup was the first half
-    this->_op_progress =((double)progress_cur / progress_tot) * 100;
-    if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
-      return OM_RESULT_ABORT;
-    }
-  }
+  this->_bck_root = bck_root;
 
-  OmArchive source_zip;
+  this->_has_bck = true;
 
-  // verify we have source to install
-  if(this->_src_isdir) {
-    if(!Om_isDir(this->_src_root)) {
-      this->_error(L"applySource", Om_errNotDir(L"Source directory", this->_src_root));
-      this->_op_apply = false;
-      return OM_RESULT_ERROR;
-    }
-  } else {
-    if(!source_zip.read(this->_src_path)) {
-      this->_error(L"applySource", Om_errLoad(L"Source archive file", this->_src_path, source_zip.lastErrorStr()));
-      this->_op_apply = false;
-      return OM_RESULT_ERROR;
-    }
-  }
+  this->_ModChan->indexBackup(this);
 
-  bool has_error = false;
-  bool has_abort = false;
+  // new Backup is complete, from now an interrupted upgrade is undone by
+  // restoring both Backups, the replaced one being journaled as restoring
+  OmWString old_path = ModPack->_bck_path;
 
-  OmWString tgt_file, src_file;
+  this->_ModChan->journalOper(OM_JOURNAL_APPLY, bck_path);
+  this->_ModChan->journalOper(OM_JOURNAL_RESTORE, old_path);
 
-  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+  // end backup operation
+  this->_op_backup = false;
 
-    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), this->_src_entry[i].path);
+  // 4. restore replaced Mod files which are not part of new version, files
+  //    first then added files and directories in backward order
 
-    if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) {
+  for(size_t n = 0; n < removes.size(); ++n) {
 
-      // if directory does not exists in Target, create it
-      if(!Om_isDir(tgt_file)) {
-        int32_t result = Om_dirCreate(tgt_file);
-        if(result != 0) {
-          this->_error(L"applySource", Om_errCreate(L"directory in Target", tgt_file, result));
-          has_error = true; break;
-        }
+    OmModEntry_t& old_entry = ModPack->_bck_entry[removes[n]];
+
+    if(OM_HAS_BIT(old_entry.attr, OM_MODENTRY_DEL))
+      continue;
+
+    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), old_entry.path);
+
+    int32_t result = __unlink_target(tgt_file, false);
+
+    if(result == 0) {
+      if(!old_entry.blob.empty()) {
+        result = this->_ModChan->fetchBackupBlob(old_entry.blob, tgt_file);
+        old_entry.blob.clear();
+      } else if(isdir) {
+        Om_concatPaths(old_file, old_root, old_entry.path);
+        result = Om_fileMove(old_file, tgt_file);
+      } else if(!old_zip.entrySave(old_entry.cdid, tgt_file)) {
+        result = -1;
       }
+    }
 
-    } else {
+    if(result != 0) {
+      this->_error(L"upgradeFrom", Om_errCopy(L"Backup to Target file", tgt_file, result));
+      has_error = true;
+    }
 
-      if(this->_src_isdir) {
+    // call progression callback, process cannot be aborted from here
+    if(progress_cb) {
+      progress_cur++;
+      this->_op_progress = ((double)progress_cur / progress_tot) * 100;
+      progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this));
+    }
+  }
 
-        Om_concatPaths(src_file, this->_src_root, this->_src_entry[i].path);
+  size_t n = removes.size();
+  while(n--) {
 
-        // Copy and overwrite
-        int32_t result = Om_fileCopy(src_file, tgt_file, true);
-        if(result != 0) {
-          this->_error(L"applySource", Om_errCopy(L"Source file to Target", tgt_file, result));
-          has_error = true; break;
-        }
+    const OmModEntry_t& old_entry = ModPack->_bck_entry[removes[n]];
 
-      } else {
+    if(!OM_HAS_BIT(old_entry.attr, OM_MODENTRY_DEL))
+      continue;
 
-        // extract to destination
-        if(!source_zip.entrySave(this->_src_entry[i].cdid, tgt_file)) {
-          this->_error(L"applySource", Om_errZipExtr(L"Source file to Target", tgt_file, source_zip.lastErrorStr()));
-          has_error = true; break;
-        }
+    Om_concatPaths(tgt_file, this->_ModChan->targetPath(), old_entry.path);
 
+    if(OM_HAS_BIT(old_entry.attr, OM_MODENTRY_DIR)) {
+      if(Om_isDirEmpty(tgt_file)) {
+        int32_t result = Om_dirDelete(tgt_file);
+        if(result != 0)
+          this->_log(OM_LOG_WRN, L"upgradeFrom", Om_errDelete(L"directory in Target", tgt_file, result));
       }
-
+    } else if(Om_pathExists(tgt_file)) {
+      int32_t result = Om_fileDelete(tgt_file);
+      if(result != 0)
+        this->_log(OM_LOG_WRN, L"upgradeFrom", Om_errDelete(L"file in Target", tgt_file, result));
     }
 
-    // call progression callback
+    // call progression callback, process cannot be aborted from here
     if(progress_cb) {
       progress_cur++;
       this->_op_progress = ((double)progress_cur / progress_tot) * 100;
-      if(!progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this))) {
-        this->_log(OM_LOG_WRN, L"applySource", L"process aborted by user.");
-        has_abort = true; break;
-      }
+      progress_cb(user_ptr, progress_tot, progress_cur, reinterpret_cast<uint64_t>(this));
     }
+  }
 
-    #ifdef DEBUG
-    Sleep(50); //< for debug
-    #endif
+  // 5. replaced Mod Backup is no longer needed
+
+  if(!isdir) old_zip.close();
+
+  int32_t result = isdir ? Om_dirDeleteRecursive(old_path) : Om_fileDelete(old_path);
+  if(result != 0) {
+    this->_log(OM_LOG_WRN, L"upgradeFrom", Om_errDelete(L"replaced Backup", old_path, result));
   }
 
-  // close zip file
-  if(!this->_src_isdir) source_zip.close();
+  // unindex and release transferred blobs, still referenced by this one
+  ModPack->clearBackup();
 
-  // end install operation
-  this->_op_apply = false;
+  this->_ModChan->journalOper(OM_JOURNAL_END, old_path);
 
-  if(has_abort || has_error) {
-    return has_error ? OM_RESULT_ERROR_APPLY : OM_RESULT_ABORT; //< must undo
+  // 6. write only new and changed files, progression ends with them
+
+  OmResult apply_result = OM_RESULT_OK;
+
+  if(applies.size()) {
+
+    // skip to the remaining steps so progression never goes back
+    if(progress_cb && progress_cur < progress_tot - applies.size())
+      progress_cur = progress_tot - applies.size();
+
+    apply_result = this->_apply_source(&applies, progress_tot, progress_cur, progress_cb, user_ptr);
+  }
+
+  if(apply_result == OM_RESULT_OK) {
+
+    this->_ModChan->journalOper(OM_JOURNAL_END, bck_path);
+
+  } else {
+
+    // restore stored Backup data, as for a failed install, which also ends
+    // the journaled operation
+    this->restoreData(progress_cb, user_ptr, true);
   }
 
   // making report
   wchar_t done_str[32];
   swprintf(done_str, 32, L"done in %.2fs", (double)(clock()-time)/CLOCKS_PER_SEC);
-  this->_log(OM_LOG_OK, L"applySource", done_str);
+  this->_log(OM_LOG_OK, L"upgradeFrom", OmWString(done_str) + L", " + Om_formatSizeStr(bytes_skip) + L" unchanged skipped");
 
-  return OM_RESULT_OK;
+  if(has_error && apply_result == OM_RESULT_OK)
+    return OM_RESULT_ERROR;
+
+  return apply_result;
 }
 
 ///
@@ -1609,6 +3170,14 @@ OmResult OmModPack::discardBackup()
 
   bool has_error = false;
 
+  // release stored blobs, deleting those no longer referenced
+  for(size_t i = 0; i < this->_bck_entry.size(); ++i) {
+    if(!this->_bck_entry[i].blob.empty() && this->_ModChan) {
+      this->_ModChan->releaseBackupBlob(this->_bck_entry[i].blob, true);
+      this->_bck_entry[i].blob.clear();
+    }
+  }
+
   // cleanup backup data either zip file or sub-directory...
   if(this->_bck_isdir) {
 
@@ -1661,7 +3230,7 @@ OmResult OmModPack::saveAs(const OmWString& path, int32_t method, int32_t level,
       return OM_RESULT_ERROR;
     }
   } else {
-    if(!source_zip.read(this->_src_path)) {
+    if(!source_zip.read(this->_src_path, OM_READER_MAPPED)) {
       this->_error(L"saveAs", Om_errLoad(L"Source archive file", this->_src_path, source_zip.lastErrorStr()));
       return OM_RESULT_ERROR;
     }
@@ -1693,70 +3262,83 @@ OmResult OmModPack::saveAs(const OmWString& path, int32_t method, int32_t level,
 
   OmWString out_file;
 
-  // transfer data from source to output zip
-  for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+  if(this->_src_isdir) {
 
-    // output file path (in zip)
-    Om_concatPaths(out_file, out_root, this->_src_entry[i].path);
+    // source files are compressed in parallel, by convention
+    // empty source path mean directory entry
+    OmWStringArray src_files, out_files;
+    OmWString src_file;
 
-    if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) {
+    for(size_t i = 0; i < this->_src_entry.size(); ++i) {
+
+      Om_concatPaths(out_file, out_root, this->_src_entry[i].path);
+      out_files.push_back(out_file);
+
+      if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) {
+        src_files.push_back(OmWString());
+      } else {
+        Om_concatPaths(src_file, this->_src_root, this->_src_entry[i].path);
+        src_files.push_back(src_file);
+      }
+    }
 
-      // add folder to destination archive
-      if(!output_zip.entryAdd(nullptr, 0, out_file)) {
-        this->_error(L"saveAs", Om_errZipComp(L"Source directory to destination", out_file, output_zip.lastErrorStr()));
-        has_error = true; break;
+    saveas_context_t sctx;
+    sctx.ModPack = this;
+    sctx.progress_cb = progress_cb;
+    sctx.compress_cb = compress_cb;
+    sctx.user_ptr = user_ptr;
+    sctx.done = 0;
+    sctx.abort = false;
+
+    if(!output_zip.entryAddBatch(src_files, out_files, 0, __saveas_batch_fn, __saveas_compress_fn, &sctx)) {
+      if(sctx.abort) {
+        has_abort = true;
+      } else {
+        // entries are added in order, failed one is the next to be done
+        const OmWString& err_file = src_files[sctx.done].empty() ? out_files[sctx.done] : src_files[sctx.done];
+        this->_error(L"saveAs", Om_errZipComp(L"Source file to destination", err_file, output_zip.lastErrorStr()));
+        has_error = true;
       }
+    }
 
-    } else {
+  } else {
+
+    // transfer data from source to output zip
+    for(size_t i = 0; i < this->_src_entry.size(); ++i) {
 
-      if(this->_src_isdir) {
+      // output file path (in zip)
+      Om_concatPaths(out_file, out_root, this->_src_entry[i].path);
 
-        // source file path
-        OmWString src_file;
-        Om_concatPaths(src_file, this->_src_root, this->_src_entry[i].path);
+      if(OM_HAS_BIT(this->_src_entry[i].attr, OM_MODENTRY_DIR)) {
 
-        if(!output_zip.entryAdd(src_file, out_file, compress_cb, user_ptr)) {
-          this->_error(L"saveAs", Om_errZipComp(L"Source file to destination", src_file, output_zip.lastErrorStr()));
+        // add folder to destination archive
+        if(!output_zip.entryAdd(nullptr, 0, out_file)) {
+          this->_error(L"saveAs", Om_errZipComp(L"Source directory to destination", out_file, output_zip.lastErrorStr()));
           has_error = true; break;
         }
 
       } else {
 
-        //transfers data from source to destination via memory buffer
-        uint64_t data_len = source_zip.entrySize(this->_src_entry[i].cdid);
-        uint8_t* data_buf = new(std::nothrow) uint8_t[data_len];
-
-        if(!data_buf) {
-          this->_error(L"saveAs", Om_errBadAlloc(L"Source file extraction", this->_src_entry[i].path));
+        // transfers data from source to destination, compressed data is
+        // copied as is when methods match, recompressed otherwise
+        if(!output_zip.entryCopy(source_zip, this->_src_entry[i].cdid, out_file, compress_cb, user_ptr)) {
+          this->_error(L"saveAs", Om_errZipComp(L"Source file to destination", this->_src_entry[i].path, output_zip.lastErrorStr()));
           has_error = true; break;
         }
+      }
 
-        if(!source_zip.entrySave(this->_src_entry[i].cdid, data_buf, compress_cb, user_ptr)) {
-          this->_error(L"saveAs", Om_errZipExtr(L"Source file", this->_src_entry[i].path, source_zip.lastErrorStr()));
-          delete [] data_buf; has_error = true; break;
-        }
-
-        if(!output_zip.entryAdd(data_buf, data_len, out_file, compress_cb, user_ptr)) {
-          this->_error(L"saveAs", Om_errZipComp(L"Destination file", out_file, output_zip.lastErrorStr()));
-          delete [] data_buf; has_error = true; break;
+      // call progression callback
+      if(progress_cb) {
+        entry_cur++;
+        if(!progress_cb(user_ptr, entry_tot, entry_cur, reinterpret_cast<uint64_t>(this))) {
+          has_abort = true; break;
         }
-
-        delete [] data_buf;
       }
 
+      #ifdef DEBUG
+      Sleep(50); //< for debug
+      #endif
     }
-
-    // call progression callback
-    if(progress_cb) {
-      entry_cur++;
-      if(!progress_cb(user_ptr, entry_tot, entry_cur, reinterpret_cast<uint64_t>(this))) {
-        has_abort = true; break;
-      }
-    }
-
-    #ifdef DEBUG
-    Sleep(50); //< for debug
-    #endif
   }
 
   // we do not need source archive anymore
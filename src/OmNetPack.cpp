@@ -34,6 +34,13 @@
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 #include "OmNetPack.h"
 
+/// \brief Checksum checkpoint interval
+///
+/// Amount of downloaded bytes after which the download checksum state is
+/// saved next to the partial download file.
+///
+#define OM_NETPACK_HASH_CHECKPOINT    67108864
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -41,6 +48,7 @@ OmNetPack::OmNetPack() :
   _ModChan(nullptr),
   _NetRepo(nullptr),
   _hash(0),
+  _ref_hash(0),
   _size(0),
   _csum_is_md5(false),
   _has_part(false),
@@ -55,7 +63,10 @@ OmNetPack::OmNetPack() :
   _dnl_result(OM_RESULT_UNKNOW),
   _dnl_remain(0),
   _dnl_percent(0),
-  _upg_percent(0)
+  _dnl_hash(nullptr),
+  _dnl_hash_save(0),
+  _upg_percent(0),
+  _upg_abort(false)
 {
 
 }
@@ -66,6 +77,7 @@ OmNetPack::OmNetPack(OmModChan* ModChan) :
   _ModChan(ModChan),
   _NetRepo(nullptr),
   _hash(0),
+  _ref_hash(0),
   _size(0),
   _csum_is_md5(false),
   _has_part(false),
@@ -80,7 +92,10 @@ OmNetPack::OmNetPack(OmModChan* ModChan) :
   _dnl_result(OM_RESULT_UNKNOW),
   _dnl_remain(0),
   _dnl_percent(0),
-  _upg_percent(0)
+  _dnl_hash(nullptr),
+  _dnl_hash_save(0),
+  _upg_percent(0),
+  _upg_abort(false)
 {
 
 }
@@ -90,7 +105,17 @@ OmNetPack::OmNetPack(OmModChan* ModChan) :
 ///
 OmNetPack::~OmNetPack()
 {
-  this->stopDownload();
+  // wait for transfer engine to release download
+  this->_connect.cancelRequest();
+
+  if(this->_dnl_hash) {
+
+    // keep checksum progress of interrupted download
+    if(this->_dnl_result == OM_RESULT_PENDING && Om_isFile(this->_dnl_temp))
+      Om_hashStateSave(this->_dnl_hash, this->_dnl_hsum);
+
+    Om_hashStateDelete(this->_dnl_hash);
+  }
 }
 
 ///
@@ -114,6 +139,8 @@ bool OmNetPack::parseReference(OmNetRepo* NetRepo, size_t i)
 
   this->_NetRepo = NetRepo;
 
+  this->_ref_hash = OmNetPack::getReferenceHash(NetRepo, ref_node);
+
   this->_file.assign(ref_node.attrAsString(L"file"));
   this->_size = ref_node.attrAsUint64(L"bytes");
   // create formated string
@@ -240,6 +267,56 @@ bool OmNetPack::parseReference(OmNetRepo* NetRepo, size_t i)
   return true;
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+static inline uint64_t __ref_hash_str(const wchar_t* str)
+{
+  return Om_getXXHash3(str, wcslen(str) * sizeof(wchar_t));
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+uint64_t OmNetPack::getReferenceHash(const OmNetRepo* NetRepo, const OmXmlNode& ref_node)
+{
+  // digests of each reference parts this object is built from, including
+  // Repository locations download URL is made of
+  uint64_t digest[13] = {};
+
+  digest[0] = __ref_hash_str(ref_node.attrAsString(L"file"));
+  digest[1] = __ref_hash_str(ref_node.attrAsString(L"bytes"));
+  digest[2] = __ref_hash_str(ref_node.attrAsString(L"ident"));
+  digest[3] = __ref_hash_str(ref_node.attrAsString(L"xxhsum"));
+  digest[4] = __ref_hash_str(ref_node.attrAsString(L"md5sum"));
+  digest[5] = __ref_hash_str(ref_node.attrAsString(L"category"));
+
+  if(ref_node.hasChild(L"url"))
+    digest[6] = __ref_hash_str(ref_node.child(L"url").content());
+
+  if(ref_node.hasChild(L"dependencies")) {
+
+    OmXmlNodeArray ident_nodes;
+    ref_node.child(L"dependencies").children(ident_nodes, L"ident");
+
+    for(size_t i = 0; i < ident_nodes.size(); ++i)
+      digest[7] ^= __ref_hash_str(ident_nodes[i].content()) + i;
+  }
+
+  if(ref_node.hasChild(L"picture"))
+    digest[8] = __ref_hash_str(ref_node.child(L"picture").content());
+
+  if(ref_node.hasChild(L"description")) {
+    digest[9] = __ref_hash_str(ref_node.child(L"description").content());
+    digest[10] = __ref_hash_str(ref_node.child(L"description").attrAsString(L"bytes"));
+  }
+
+  digest[11] = __ref_hash_str(NetRepo->base().c_str());
+  digest[12] = __ref_hash_str(NetRepo->downpath().c_str());
+
+  return Om_getXXHash3(digest, sizeof(digest));
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -336,6 +413,7 @@ void OmNetPack::revokeDownload()
     return;
 
   Om_fileDelete(Om_concatPathsExt(this->_ModChan->libraryPath(), this->_file, L"dl_part"));
+  Om_fileDelete(Om_concatPathsExt(this->_ModChan->libraryPath(), this->_file, L"dl_hash"));
 
   this->refreshAnalytics();
 }
@@ -385,6 +463,9 @@ bool OmNetPack::startDownload(Om_downloadCb download_cb, Om_resultCb result_cb,
 
   this->_dnl_percent = 0.0;
 
+  // prepare checksum computed while receiving data
+  this->_dnl_hash_init();
+
   // check for exception when download part is actually the completed download, in this case
   // we call result callback directly to prevent HTTP error 416
   if(Om_isFile(this->_dnl_temp)) {
@@ -395,6 +476,8 @@ bool OmNetPack::startDownload(Om_downloadCb download_cb, Om_resultCb result_cb,
      }
   }
 
+  this->_connect.setPriority(OM_CONNECT_PRIO_DOWNLOAD);
+
   if(!this->_connect.requestHttpGet(this->_down_url, this->_dnl_temp, true, OmNetPack::_dnl_result_fn, OmNetPack::_dnl_download_fn, this, rate)) {
     this->_error(L"startDownload", this->_connect.lastError());
     this->_has_error = true;
@@ -483,15 +566,28 @@ bool OmNetPack::finalizeDownload()
     return false;
   }
 
-  // compare checksum
+  // compare checksum, computed while receiving data unless incremental
+  // state is unavailable, in which case we read the file again
   bool checksum_ok = false;
 
-  if(this->_csum_is_md5) {
+  if(this->_dnl_hash && Om_hashStateSize(this->_dnl_hash) == this->_size) {
+    checksum_ok = Om_hashStateCompare(this->_dnl_hash, this->_csum);
+  } else if(this->_csum_is_md5) {
     checksum_ok = Om_cmpMD5sum(hFile, this->_csum);
   } else {
     checksum_ok = Om_cmpXXHsum(hFile, this->_csum);
   }
 
+  // checksum state is no longer needed
+  if(this->_dnl_hash) {
+    this->_connect.setDigest(nullptr);
+    Om_hashStateDelete(this->_dnl_hash);
+    this->_dnl_hash = nullptr;
+  }
+
+  if(Om_isFile(this->_dnl_hsum))
+    Om_fileDelete(this->_dnl_hsum);
+
   if(checksum_ok) {
 
     int32_t result = Om_fileRename(hFile, this->_dnl_path, true);
@@ -514,6 +610,51 @@ bool OmNetPack::finalizeDownload()
   return !this->_has_error;
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmNetPack::_dnl_hash_init()
+{
+  if(this->_dnl_hash)
+    Om_hashStateDelete(this->_dnl_hash);
+
+  this->_dnl_hash = Om_hashStateCreate(this->_csum_is_md5);
+
+  this->_dnl_hsum = this->_dnl_path;
+  this->_dnl_hsum += L".dl_hash";
+
+  if(this->_dnl_hash) {
+
+    if(Om_isFile(this->_dnl_temp)) {
+
+      // resume from last checkpoint, unless it does not match received data
+      if(Om_hashStateLoad(this->_dnl_hash, this->_dnl_hsum)) {
+        if(Om_hashStateSize(this->_dnl_hash) > Om_itemSize(this->_dnl_temp)) {
+          Om_hashStateDelete(this->_dnl_hash);
+          this->_dnl_hash = Om_hashStateCreate(this->_csum_is_md5);
+        }
+      }
+
+      // seed with data received after checkpoint
+      if(this->_dnl_hash && !Om_hashStateUpdate(this->_dnl_hash, this->_dnl_temp)) {
+        Om_hashStateDelete(this->_dnl_hash);
+        this->_dnl_hash = nullptr;
+      }
+
+    } else {
+
+      // stale checkpoint of a revoked download
+      if(Om_isFile(this->_dnl_hsum))
+        Om_fileDelete(this->_dnl_hsum);
+    }
+  }
+
+  this->_dnl_hash_save = this->_dnl_hash ? Om_hashStateSize(this->_dnl_hash) : 0;
+
+  // without checksum state, file is read again at finalization
+  this->_connect.setDigest(this->_dnl_hash);
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -526,6 +667,15 @@ bool OmNetPack::_dnl_download_fn(void* ptr, int64_t tot, int64_t cur, int64_t ra
   self->_dnl_percent = ((double)cur / tot) * 100;
   self->_dnl_remain = (double)(tot - cur) / rate;
 
+  // save checksum progress from time to time so resume does not rehash
+  // all received data
+  if(self->_dnl_hash) {
+    if(Om_hashStateSize(self->_dnl_hash) - self->_dnl_hash_save >= OM_NETPACK_HASH_CHECKPOINT) {
+      Om_hashStateSave(self->_dnl_hash, self->_dnl_hsum);
+      self->_dnl_hash_save = Om_hashStateSize(self->_dnl_hash);
+    }
+  }
+
   if(self->_cli_download_cb) {
     return self->_cli_download_cb(self->_cli_ptr, tot, cur, rate, reinterpret_cast<uint64_t>(self));
   }
@@ -552,6 +702,16 @@ void OmNetPack::_dnl_result_fn(void* ptr, OmResult result, uint64_t param)
 
     self->_error(L"_dnl_result_fn", self->_connect.lastError());
     self->_has_error = true;
+  }
+
+  // save checksum progress to resume download later
+  if(self->_dnl_hash && result != OM_RESULT_OK) {
+    if(Om_isFile(self->_dnl_temp)) {
+      Om_hashStateSave(self->_dnl_hash, self->_dnl_hsum);
+      self->_dnl_hash_save = Om_hashStateSize(self->_dnl_hash);
+    } else if(Om_isFile(self->_dnl_hsum)) {
+      Om_fileDelete(self->_dnl_hsum);
+    }
   }
 
   if(self->_cli_result_cb)
@@ -580,6 +740,7 @@ OmResult OmNetPack::upgradeReplace(Om_progressCb progress_cb, void* user_ptr)
   }
 
   this->_upg_percent = 0;
+  this->_upg_abort = false;
 
   this->_is_upgrading = true;
 
@@ -622,7 +783,45 @@ OmResult OmNetPack::upgradeReplace(Om_progressCb progress_cb, void* user_ptr)
   // to keep track of all uninstalled Mods to be re-installed
   OmUint64Array unins_hash;
 
-  // 1. uninstall all replaced Mods before renaming/trashing them
+  // 1. if possible, upgrade installed Mod in place writing only what
+  //    changed, otherwise uninstall all replaced Mods before renaming/trashing
+  //    them
+
+  if(!this_ModPack->hasBackup() && !this->_ModChan->hasMissingDepend(this_ModPack)) {
+
+    for(size_t i = 0; i < this->_upgrade.size(); ++i) {
+
+      OmModPack* ModPack = this->_upgrade[i];
+
+      if(!ModPack->hasBackup() || this->_ModChan->isOverlapped(ModPack))
+        continue;
+
+      // on install failure upgraded Mod Backup is restored, replaced Mod is
+      // then no longer installed
+      OmResult result = this_ModPack->upgradeFrom(ModPack, OmNetPack::_upg_progress_fn, this);
+      if(result == OM_RESULT_ERROR || result == OM_RESULT_ERROR_BACKP || result == OM_RESULT_ERROR_APPLY) {
+        this->_error(L"upgradeReplace", this_ModPack->lastError());
+        has_error = true;
+      }
+
+      // aborted by user, replaced Mod is left installed as it was and
+      // nothing is to be uninstalled or trashed
+      if(result == OM_RESULT_ABORT && this->_upg_abort) {
+
+        this->_upg_percent = 0;
+
+        // reset client parameters
+        this->_cli_ptr = nullptr;
+        this->_cli_progress_cb = nullptr;
+
+        this->_is_upgrading = false;
+
+        return OM_RESULT_ABORT;
+      }
+
+      break;
+    }
+  }
 
   for(size_t i = 0; i < this->_upgrade.size(); ++i) {
     if(this->_upgrade[i]->hasBackup())
@@ -638,7 +837,7 @@ OmResult OmNetPack::upgradeReplace(Om_progressCb progress_cb, void* user_ptr)
     // keep hash of uinstalled package to be re-installed later
     unins_hash.push_back(restores[i]->hash());
 
-    if(!restores[i]->restoreData(OmNetPack::_upg_progress_fn, this)) {
+    if(restores[i]->restoreData(OmNetPack::_upg_progress_fn, this) != OM_RESULT_OK) {
       this->_error(L"upgradeReplace", restores[i]->lastError());
       has_error = true;
     }
@@ -773,7 +972,9 @@ bool OmNetPack::_upg_progress_fn(void* ptr, size_t tot, size_t cur, uint64_t par
   self->_upg_percent = ((double)cur / tot) * 100;
 
   if(self->_cli_progress_cb) {
-    return self->_cli_progress_cb(self->_cli_ptr, tot, cur, reinterpret_cast<uint64_t>(self));
+    if(!self->_cli_progress_cb(self->_cli_ptr, tot, cur, reinterpret_cast<uint64_t>(self))) {
+      self->_upg_abort = true; return false;
+    }
   }
 
   return true;
@@ -16,6 +16,7 @@
 */
 #include "OmBaseApp.h"
 #include "OmUtilStr.h"
+#include "OmUtilFs.h"
 #include "OmUtilErr.h"
 #include "OmUtilHsh.h"
 #include "OmUtilZip.h"
@@ -35,7 +36,8 @@
 OmNetRepo::OmNetRepo(OmModChan* ModChan) :
   _ModChan(ModChan),
   _query_result(OM_RESULT_UNKNOW),
-  _query_respcode(0)
+  _query_respcode(0),
+  _query_cached(false)
 {
 
 }
@@ -65,6 +67,9 @@ void OmNetRepo::clear()
   this->_query_result = OM_RESULT_UNKNOW;
   this->_query_respcode = 0;
   this->_query_respdata.clear();
+  this->_query_cached = false;
+  this->_cache_etag.clear();
+  this->_cache_modified.clear();
 }
 
 ///
@@ -240,6 +245,30 @@ OmResult OmNetRepo::query()
     urls.push_back(Om_concatURLs(this->_base, this->_name) + L".xml");
   }
 
+  // response of previous query, if any
+  OmWString cache_path = this->_cache_path();
+
+  OmXmlConf cache_cfg;
+  OmWString cache_url;
+  bool has_cache = false;
+
+  if(!cache_path.empty() && Om_isFile(cache_path)) {
+
+    if(cache_cfg.load(cache_path, OM_XMAGIC_RCH) && cache_cfg.hasChild(L"url") && cache_cfg.hasChild(L"data")) {
+
+      cache_url = cache_cfg.child(L"url").content();
+      has_cache = true;
+
+      // try first the URL which previously succeed
+      for(size_t i = 1; i < urls.size(); ++i) {
+        if(urls[i] == cache_url) {
+          urls[i] = urls[0]; urls[0] = cache_url;
+          break;
+        }
+      }
+    }
+  }
+
   // send synchronous request
   OmXmlDoc parsexml;
   OmCString respdata;
@@ -250,6 +279,7 @@ OmResult OmNetRepo::query()
   this->_query_respdata.clear();
   this->_query_respcode = 0;
   this->_query_lasterr.clear();
+  this->_query_cached = false;
 
   // the general query result
   this->_query_result = OM_RESULT_PENDING;
@@ -260,14 +290,45 @@ OmResult OmNetRepo::query()
     std::wcout << L"DEBUG => OmNetRepo::query : try url=" << urls[i] << L"\n";
     #endif // DEBUG
 
+    OmWString cache_etag, cache_modified;
+
+    // conditional request, server does not send unchanged data
+    if(has_cache && urls[i] == cache_url) {
+      if(cache_cfg.hasChild(L"etag")) cache_etag = cache_cfg.child(L"etag").content();
+      if(cache_cfg.hasChild(L"modified")) cache_modified = cache_cfg.child(L"modified").content();
+    }
+
+    this->_query_connect.setValidators(cache_etag, cache_modified);
+
+    // queries are short, they must not wait behind pending downloads
+    this->_query_connect.setPriority(OM_CONNECT_PRIO_QUERY);
+
     OmResult result = this->_query_connect.requestHttpGet(urls[i], &respdata);
 
     if(result == OM_RESULT_OK) {
 
       // store HTTP response code
-      this->_query_respdata = Om_toUTF16(respdata);
       this->_query_respcode = this->_query_connect.httpGetResponse();
 
+      if(this->_query_respcode == 304) {
+
+        this->_query_cached = true;
+
+        // unchanged definition, we take data from cache
+        this->_query_respdata = cache_cfg.child(L"data").content();
+
+        // parsed data is already up to date, only skip parse
+        if(this->_xml.valid() && this->_path == urls[i] &&
+           this->_cache_etag == cache_etag && this->_cache_modified == cache_modified) {
+          this->_query_result = OM_RESULT_OK;
+          return this->_query_result;
+        }
+
+      } else {
+
+        this->_query_respdata = Om_toUTF16(respdata);
+      }
+
       // we verify we received valid XML data
       if(!parsexml.parse(this->_query_respdata)) {
         this->_query_result = OM_RESULT_ERROR_PARSE;
@@ -283,6 +344,27 @@ OmResult OmNetRepo::query()
       }
 
       this->_path = urls[i]; //< save the working URL in path
+
+      if(this->_query_cached) {
+
+        this->_cache_etag = cache_etag;
+        this->_cache_modified = cache_modified;
+
+      } else {
+
+        this->_cache_etag = this->_query_connect.httpGetEtag();
+        this->_cache_modified = this->_query_connect.httpGetModified();
+
+        // store response for next query, if server allows it
+        if(!cache_path.empty()) {
+          if(!this->_cache_etag.empty() || !this->_cache_modified.empty()) {
+            this->_cache_save(cache_path, urls[i]);
+          } else if(has_cache) {
+            Om_fileDelete(cache_path);
+          }
+        }
+      }
+
       this->_query_result = OM_RESULT_OK;
       return this->_query_result;
 
@@ -323,6 +405,69 @@ OmResult OmNetRepo::query()
   this->_query_result = OM_RESULT_ERROR;
 
   return this->_query_result;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmNetRepo::deleteQueryCache()
+{
+  OmWString cache_path = this->_cache_path();
+
+  if(!cache_path.empty() && Om_isFile(cache_path))
+    Om_fileDelete(cache_path);
+
+  this->_cache_etag.clear();
+  this->_cache_modified.clear();
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+OmWString OmNetRepo::_cache_path() const
+{
+  OmWString path;
+
+  if(!this->_ModChan || (this->_base.empty() && this->_name.empty()))
+    return path;
+
+  // cache entry named after repository coordinates
+  OmWString cache_dir;
+  Om_concatPaths(cache_dir, this->_ModChan->home(), OM_MODCHN_REPCACHE);
+
+  OmWString cache_name = Om_uint64ToStr(Om_getXXHash3(Om_concatURLs(this->_base, this->_name)));
+  cache_name += L"." OM_XML_DEF_EXT;
+
+  Om_concatPaths(path, cache_dir, cache_name);
+
+  return path;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmNetRepo::_cache_save(const OmWString& path, const OmWString& url)
+{
+  OmWString cache_dir = Om_getDirPart(path);
+
+  if(!Om_isDir(cache_dir)) {
+    int32_t result = Om_dirCreate(cache_dir);
+    if(result != 0) {
+      this->_log(OM_LOG_WRN, L"_cache_save", Om_errCreate(L"repository cache directory", cache_dir, result));
+      return;
+    }
+  }
+
+  OmXmlConf cache_cfg;
+  cache_cfg.init(path, OM_XMAGIC_RCH);
+
+  cache_cfg.addChild(L"url").setContent(url);
+  cache_cfg.addChild(L"etag").setContent(this->_cache_etag);
+  cache_cfg.addChild(L"modified").setContent(this->_cache_modified);
+  cache_cfg.addChild(L"data").setContent(this->_query_respdata);
+
+  if(!cache_cfg.save())
+    this->_log(OM_LOG_WRN, L"_cache_save", Om_errSave(L"repository cache", path, cache_cfg.lastErrorStr()));
 }
 
 ///
@@ -178,6 +178,8 @@ void OmUiAddRep::_onBcChk()
 
   this->_qry_result = OM_RESULT_PENDING;
 
+  this->_connect.setPriority(OM_CONNECT_PRIO_QUERY);
+
   this->_connect.requestHttpGet(url_full, OmUiAddRep::_qry_reponse_fn, this);
 }
 
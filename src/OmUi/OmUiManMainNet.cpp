@@ -540,6 +540,11 @@ void OmUiManMainNet::_query_result_fn(void* ptr, OmResult result, uint64_t param
   lvI.pszText = const_cast<LPWSTR>(NetRepo->title().c_str());
   self->msgItem(IDC_LV_REP, LVM_SETITEMW, 0, reinterpret_cast<LPARAM>(&lvI));
 
+  // Net Packs list items were already updated through Network Library
+  // notifications, only selection dependent controls may need update
+  if(ModChan->queryAddedCount() || ModChan->queryChangedCount() || ModChan->queryRemovedCount())
+    self->_lv_net_on_selchg();
+
   // update progression bar
   self->msgItem(IDC_PB_MOD, PBM_SETRANGE, 0, MAKELPARAM(0, 100));
   self->msgItem(IDC_PB_MOD, PBM_SETPOS, ModChan->queriesProgress());
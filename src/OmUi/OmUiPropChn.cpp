@@ -670,6 +670,22 @@ bool OmUiPropChn::applyChanges()
     UiPropChnDnl->paramReset(CHN_PROP_DNL_LIMITS);
   }
 
+  if(UiPropChnDnl->paramChanged(CHN_PROP_DNL_QRYLIMITS)) {
+
+    uint32_t max_thread = 0;
+
+    if(UiPropChnDnl->msgItem(IDC_BC_CKBX6, BM_GETCHECK)) {
+      OmWString ec_entry;
+      UiPropChnDnl->getItemText(IDC_EC_NUM03, ec_entry);
+      max_thread = std::stoi(ec_entry);
+    }
+
+    this->_ModChan->setQueryLimits(max_thread);
+
+    // Reset parameter as unmodified
+    UiPropChnDnl->paramReset(CHN_PROP_DNL_QRYLIMITS);
+  }
+
   // disable Apply button
   this->enableItem(IDC_BC_APPLY, false);
 
@@ -87,6 +87,21 @@ void OmUiPropChnDnl::_limit_thread_toggle()
   this->paramCheck(CHN_PROP_DNL_LIMITS);
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void OmUiPropChnDnl::_limit_query_toggle()
+{
+  bool enabled = this->msgItem(IDC_BC_CKBX6, BM_GETCHECK);
+
+  this->enableItem(IDC_EC_NUM03, enabled);
+  this->enableItem(IDC_UD_SPIN3, enabled);
+  this->redrawItem(IDC_UD_SPIN3, nullptr, RDW_INVALIDATE);
+
+  // notify parameters changes
+  this->paramCheck(CHN_PROP_DNL_QRYLIMITS);
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -106,6 +121,12 @@ void OmUiPropChnDnl::_onTbInit()
   this->msgItem(IDC_UD_SPIN2, UDM_SETBUDDY, reinterpret_cast<WPARAM>(this->getItem(IDC_EC_NUM02)));
   this->msgItem(IDC_UD_SPIN2, UDM_SETRANGE32, 1, 64);
 
+  CreateWindowEx(WS_EX_LEFT|WS_EX_LTRREADING, UPDOWN_CLASS, nullptr, ud_style, 0, 0, 0, 0,
+                 this->_hwnd, reinterpret_cast<HMENU>(IDC_UD_SPIN3), this->_hins, nullptr);
+
+  this->msgItem(IDC_UD_SPIN3, UDM_SETBUDDY, reinterpret_cast<WPARAM>(this->getItem(IDC_EC_NUM03)));
+  this->msgItem(IDC_UD_SPIN3, UDM_SETRANGE32, 1, 32);
+
   this->_createTooltip(IDC_BC_CKBX1,  L"Warn if Mods download requires additional dependencies to be downloaded");
   this->_createTooltip(IDC_BC_CKBX2,  L"Warn if Mods to download have missing dependencies");
   this->_createTooltip(IDC_BC_CKBX3,  L"Warn if upgrading Mods will delete older versions required by other");
@@ -117,6 +138,8 @@ void OmUiPropChnDnl::_onTbInit()
   this->_createTooltip(IDC_EC_NUM01,  L"Maximum download rate in Kilobytes per seconds");
   this->_createTooltip(IDC_BC_CKBX5,  L"Limit count of concurrent download thread");
   this->_createTooltip(IDC_EC_NUM02,  L"Maximum count of concurrent download");
+  this->_createTooltip(IDC_BC_CKBX6,  L"Limit count of concurrent Repository queries");
+  this->_createTooltip(IDC_EC_NUM03,  L"Maximum count of concurrent Repository queries");
 
   // Update values
   this->_onTbRefresh();
@@ -156,6 +179,11 @@ void OmUiPropChnDnl::_onTbResize()
   this->_setItemPos(IDC_BC_CKBX5, 75, y_base+210, 135, 16, true);
   this->_setItemPos(IDC_EC_NUM02, 220, y_base+208, 60, 19, true);
   this->_setItemPos(IDC_UD_SPIN2, 280, y_base+207, 15, 21, true);
+
+  // Max query thread CheckBox & entry
+  this->_setItemPos(IDC_BC_CKBX6, 75, y_base+230, 135, 16, true);
+  this->_setItemPos(IDC_EC_NUM03, 220, y_base+228, 60, 19, true);
+  this->_setItemPos(IDC_UD_SPIN3, 280, y_base+227, 15, 21, true);
 }
 
 ///
@@ -190,6 +218,14 @@ void OmUiPropChnDnl::_onTbRefresh()
   this->enableItem(IDC_UD_SPIN2, limit_thread);
   this->msgItem(IDC_UD_SPIN2, UDM_SETPOS32, 0, limit_thread ? ModChan->downMaxThread() : 5);
   this->redrawItem(IDC_UD_SPIN2, nullptr, RDW_INVALIDATE);
+
+  // set query thread limit
+  bool limit_query = (ModChan->queryMaxThread() > 0);
+  this->msgItem(IDC_BC_CKBX6, BM_SETCHECK, limit_query);
+  this->enableItem(IDC_EC_NUM03, limit_query);
+  this->enableItem(IDC_UD_SPIN3, limit_query);
+  this->msgItem(IDC_UD_SPIN3, UDM_SETPOS32, 0, limit_query ? ModChan->queryMaxThread() : 8);
+  this->redrawItem(IDC_UD_SPIN3, nullptr, RDW_INVALIDATE);
 }
 
 ///
@@ -228,12 +264,23 @@ INT_PTR OmUiPropChnDnl::_onTbMsg(UINT uMsg, WPARAM wParam, LPARAM lParam)
         this->_limit_thread_toggle();
       break;
 
+    case IDC_BC_CKBX6: //< CheckBox: Limit query thread
+      if(HIWORD(wParam) == BN_CLICKED)
+        this->_limit_query_toggle();
+      break;
+
     case IDC_EC_NUM01: //< Entry: download rate KB/s
     case IDC_EC_NUM02: //< Entry: download thread
       if(HIWORD(wParam) == EN_CHANGE)
         // notify parameters changes
         this->paramCheck(CHN_PROP_DNL_LIMITS);
       break;
+
+    case IDC_EC_NUM03: //< Entry: query thread
+      if(HIWORD(wParam) == EN_CHANGE)
+        // notify parameters changes
+        this->paramCheck(CHN_PROP_DNL_QRYLIMITS);
+      break;
     }
   }
 
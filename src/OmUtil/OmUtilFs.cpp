@@ -21,6 +21,11 @@
 #include <ShlObj.h>           //< SHCreateDirectoryExW
 
 #define READ_BUF_SIZE 524288
+
+// not defined in older SDK
+#ifndef COPY_FILE_CLONE_FORCE
+  #define COPY_FILE_CLONE_FORCE 0x00800000
+#endif
 
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
@@ -97,6 +102,53 @@ int Om_fileDelete(const OmWString& path)
   return 0;
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+int Om_fileLink(const OmWString& src, const OmWString& dst)
+{
+  if(!CreateHardLinkW(dst.c_str(), src.c_str(), nullptr)) {
+    return GetLastError();
+  }
+  return 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+int Om_fileClone(const OmWString& src, const OmWString& dst)
+{
+  // fails with ERROR_NOT_SUPPORTED or ERROR_INVALID_PARAMETER where block
+  // cloning is not available, it never falls back to a regular copy
+  if(!CopyFileExW(src.c_str(), dst.c_str(), nullptr, nullptr, nullptr, COPY_FILE_CLONE_FORCE)) {
+    return GetLastError();
+  }
+  return 0;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+uint32_t Om_fileLinkCount(const OmWString& path)
+{
+  HANDLE hFile = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE,
+                             nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if(hFile == INVALID_HANDLE_VALUE)
+    return 0;
+
+  BY_HANDLE_FILE_INFORMATION FileInfo;
+
+  uint32_t count = 0;
+
+  if(GetFileInformationByHandle(hFile, &FileInfo))
+    count = FileInfo.nNumberOfLinks;
+
+  CloseHandle(hFile);
+
+  return count;
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -22,6 +22,8 @@
 
 #include "xxhash/xxh3.h"
 #include "md5/md5.h"
+#include "minizip-ng/mz.h"
+#include "minizip-ng/mz_crypt.h"
 
 static std::mt19937                             __rnd_generator(time(0));
 static std::uniform_int_distribution<uint8_t>   __rnd_uint8dist(0, 255);
@@ -351,6 +353,44 @@ static uint64_t __CRC64(uint64_t crc, const unsigned char *s, uint64_t l)
   return crc;
 }
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool Om_getCRC32digest(uint32_t* crc, const OmWString& path)
+{
+  HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if(hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  uint8_t* read_buf = static_cast<uint8_t*>(Om_alloc(READ_BUF_SIZE));
+  if(!read_buf) {
+    CloseHandle(hFile);
+    return false;
+  }
+
+  DWORD rb;
+
+  uint32_t value = 0;
+
+  while(ReadFile(hFile, read_buf, READ_BUF_SIZE, &rb, nullptr)) {
+
+    if(rb == 0)
+      break;
+
+    value = mz_crypt_crc32_update(value, read_buf, rb);
+  }
+
+  Om_free(read_buf);
+
+  CloseHandle(hFile);
+
+  *crc = value;
+
+  return true;
+}
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -460,6 +500,23 @@ uint64_t Om_getXXHash3(const OmWString& str)
 }
 
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+uint64_t Om_getPathHash(const OmWString& path)
+{
+  OmWString norm = path;
+
+  for(size_t i = 0; i < norm.size(); ++i)
+    if(norm[i] == L'/') norm[i] = L'\\';
+
+  if(norm.size())
+    CharLowerBuffW(&norm[0], norm.size());
+
+  return XXH3_64bits(norm.data(), norm.size() * sizeof(wchar_t));
+}
+
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -502,6 +559,65 @@ bool Om_getXXHsum(OmWString* pstr, const OmWString& path)
 }
 
 
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool Om_getXXH128sum(OmWString* pstr, const OmWString& path)
+{
+  HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if(hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  DWORD rb;
+
+  XXH3_state_t xxhst;
+  XXH3_128bits_reset(&xxhst);
+
+  uint8_t* read_buf = static_cast<uint8_t*>(Om_alloc(READ_BUF_SIZE));
+  if(!read_buf) {
+    CloseHandle(hFile);
+    return false;
+  }
+
+  // read error must not be taken as end of file
+  DWORD read_err = 0;
+
+  while(true) {
+
+    if(!ReadFile(hFile, read_buf, READ_BUF_SIZE, &rb, nullptr)) {
+      read_err = GetLastError(); break;
+    }
+
+    if(rb == 0)
+      break;
+
+    XXH3_128bits_update(&xxhst, read_buf, rb);
+  }
+
+  Om_free(read_buf);
+
+  CloseHandle(hFile);
+
+  // callers rely on last error
+  if(read_err) {
+    SetLastError(read_err);
+    return false;
+  }
+
+  XXH128_hash_t xxh = XXH3_128bits_digest(&xxhst);
+
+  // high part first, as canonical representation
+  OmWString low_str;
+  __bytes_to_hex_be(pstr, reinterpret_cast<const uint8_t*>(&xxh.high64), 8);
+  __bytes_to_hex_be(&low_str, reinterpret_cast<const uint8_t*>(&xxh.low64), 8);
+  pstr->append(low_str);
+
+  return true;
+}
+
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///
@@ -685,6 +801,276 @@ bool Om_cmpMD5sum(void* hFile, const OmWString& str)
 }
 
 
+/// \brief Checksum state
+///
+/// Incremental checksum state, either XXHash3 64 bits or MD5.
+///
+typedef struct hash_state_ {
+  bool            is_md5;   //< Use MD5 algorithm
+  uint64_t        size;     //< Hashed data size
+  XXH3_state_t*   xxhst;    //< XXHash3 state
+  MD5_CTX         md5ct;    //< MD5 context
+} hash_state_t;
+
+/// \brief Checksum checkpoint signature
+///
+/// Signature of checksum state checkpoint file header
+///
+#define HASH_CHECKPOINT_SIG  0x4B434843
+
+/// \brief Checksum checkpoint header
+///
+/// Header of checksum state checkpoint file, followed by raw state.
+///
+typedef struct hash_checkpoint_ {
+  uint32_t        sig;      //< File signature
+  uint32_t        is_md5;   //< State algorithm
+  uint64_t        size;     //< Hashed data size
+  uint32_t        len;      //< Raw state size
+} hash_checkpoint_t;
+
+/// \brief Reset checksum state
+///
+/// Reset the given checksum state to initial state.
+///
+/// \param[in]  hst   : Checksum state to reset.
+///
+static inline void __hash_state_reset(hash_state_t* hst)
+{
+  hst->size = 0;
+
+  if(hst->is_md5) {
+    MD5_Init(&hst->md5ct);
+  } else {
+    XXH3_64bits_reset(hst->xxhst);
+  }
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void* Om_hashStateCreate(bool md5)
+{
+  hash_state_t* hst = new(std::nothrow) hash_state_t();
+  if(!hst) return nullptr;
+
+  hst->is_md5 = md5;
+  hst->xxhst = nullptr;
+
+  if(!hst->is_md5) {
+    hst->xxhst = XXH3_createState();
+    if(!hst->xxhst) {
+      delete hst;
+      return nullptr;
+    }
+  }
+
+  __hash_state_reset(hst);
+
+  return hst;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void Om_hashStateDelete(void* ptr)
+{
+  hash_state_t* hst = static_cast<hash_state_t*>(ptr);
+  if(!hst) return;
+
+  if(hst->xxhst)
+    XXH3_freeState(hst->xxhst);
+
+  delete hst;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+void Om_hashStateUpdate(void* ptr, const void* data, size_t size)
+{
+  hash_state_t* hst = static_cast<hash_state_t*>(ptr);
+
+  if(hst->is_md5) {
+    MD5_Update(&hst->md5ct, const_cast<uint8_t*>(static_cast<const uint8_t*>(data)), size);
+  } else {
+    XXH3_64bits_update(hst->xxhst, data, size);
+  }
+
+  hst->size += size;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool Om_hashStateUpdate(void* ptr, const OmWString& path)
+{
+  hash_state_t* hst = static_cast<hash_state_t*>(ptr);
+
+  // file may be currently opened for writing
+  HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if(hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  // skip already hashed data
+  LARGE_INTEGER offset;
+  offset.QuadPart = hst->size;
+  SetFilePointerEx(hFile, offset, nullptr, FILE_BEGIN);
+
+  uint8_t* read_buf = static_cast<uint8_t*>(Om_alloc(READ_BUF_SIZE));
+  if(!read_buf) {
+    CloseHandle(hFile);
+    return false;
+  }
+
+  DWORD rb;
+
+  while(ReadFile(hFile, read_buf, READ_BUF_SIZE, &rb, nullptr)) {
+
+    if(rb == 0)
+      break;
+
+    Om_hashStateUpdate(hst, read_buf, rb);
+  }
+
+  Om_free(read_buf);
+
+  CloseHandle(hFile);
+
+  return true;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+uint64_t Om_hashStateSize(const void* ptr)
+{
+  return static_cast<const hash_state_t*>(ptr)->size;
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool Om_hashStateCompare(const void* ptr, const OmWString& str)
+{
+  const hash_state_t* hst = static_cast<const hash_state_t*>(ptr);
+
+  if(hst->is_md5) {
+
+    // finalize a copy to keep state usable
+    MD5_CTX md5ct = hst->md5ct;
+
+    uint8_t md5[16] = {};
+    MD5_Final(md5, &md5ct);
+
+    OmWString ctrl;
+
+    __bytes_to_hex_le(&ctrl, md5, 16);
+
+    return (str == ctrl);
+  }
+
+  uint64_t xxh_l = XXH3_64bits_digest(hst->xxhst);
+  uint64_t xxh_r = __hex_to_uint64(str.data());
+
+  return (xxh_l == xxh_r);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool Om_hashStateSave(const void* ptr, const OmWString& path)
+{
+  const hash_state_t* hst = static_cast<const hash_state_t*>(ptr);
+
+  hash_checkpoint_t head;
+  head.sig = HASH_CHECKPOINT_SIG;
+  head.is_md5 = hst->is_md5 ? 1 : 0;
+  head.size = hst->size;
+
+  const void* state;
+
+  if(hst->is_md5) {
+    state = &hst->md5ct;
+    head.len = sizeof(MD5_CTX);
+  } else {
+    state = hst->xxhst;
+    head.len = sizeof(XXH3_state_t);
+  }
+
+  HANDLE hFile = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if(hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  DWORD wb_head = 0, wb_state = 0;
+
+  WriteFile(hFile, &head, sizeof(hash_checkpoint_t), &wb_head, nullptr);
+  WriteFile(hFile, state, head.len, &wb_state, nullptr);
+
+  CloseHandle(hFile);
+
+  // incomplete checkpoint is rejected at load
+  return (wb_head == sizeof(hash_checkpoint_t) && wb_state == head.len);
+}
+
+///
+///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
+///
+bool Om_hashStateLoad(void* ptr, const OmWString& path)
+{
+  hash_state_t* hst = static_cast<hash_state_t*>(ptr);
+
+  __hash_state_reset(hst);
+
+  HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if(hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  hash_checkpoint_t head = {};
+  DWORD rb = 0;
+
+  ReadFile(hFile, &head, sizeof(hash_checkpoint_t), &rb, nullptr);
+
+  size_t state_len = hst->is_md5 ? sizeof(MD5_CTX) : sizeof(XXH3_state_t);
+
+  // check this is a checkpoint for the same algorithm and build
+  if(rb != sizeof(hash_checkpoint_t) || head.sig != HASH_CHECKPOINT_SIG ||
+     head.is_md5 != (hst->is_md5 ? 1U : 0U) || head.len != state_len) {
+    CloseHandle(hFile);
+    return false;
+  }
+
+  if(hst->is_md5) {
+    MD5_CTX md5ct;
+    ReadFile(hFile, &md5ct, head.len, &rb, nullptr);
+    if(rb == head.len) hst->md5ct = md5ct;
+  } else {
+    XXH3_state_t* xxhst = XXH3_createState();
+    rb = 0;
+    if(xxhst) {
+      ReadFile(hFile, xxhst, head.len, &rb, nullptr);
+      if(rb == head.len) XXH3_copyState(hst->xxhst, xxhst);
+      XXH3_freeState(xxhst);
+    }
+  }
+
+  CloseHandle(hFile);
+
+  if(rb != head.len)
+    return false;
+
+  hst->size = head.size;
+
+  return true;
+}
+
+
 ///
 ///  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 ///